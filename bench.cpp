@@ -0,0 +1,517 @@
+/*
+    Бенчмарки: ./benchmarks <name> [sizes...]
+*/
+
+#include "array.h"
+#include "square.h"
+#include "rtree.h"
+#include "compressed.h"
+#include "concurrent_array.h"
+#include "parallel.h"
+#include "segmented_array.h"
+#include "query.h"
+#include "sketch.h"
+#include "window.h"
+#include "pipeline.h"
+#include "loader.h"
+#include "server.h"
+#include "shm_store.h"
+
+#include <chrono>
+#include <cmath>
+#include <execution>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <numeric>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+template <typename F>
+double timeMs(F&& f) {
+    auto start = std::chrono::steady_clock::now();
+    f();
+    auto end = std::chrono::steady_clock::now();
+    return std::chrono::duration<double, std::milli>(end - start).count();
+}
+
+Array<Square<double>> randomSquares(size_t n, double extent, unsigned seed = 42) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> pos(0.0, extent);
+    std::uniform_real_distribution<double> side(0.5, 2.0);
+
+    Array<Square<double>> squares;
+    for (size_t i = 0; i < n; ++i) {
+        double x = pos(rng), y = pos(rng);
+        squares.add(Square<double>(Point<double>(x, y), Point<double>(x + side(rng), y)));
+    }
+    return squares;
+}
+
+void benchRTree(size_t n) {
+    double extent = std::sqrt(double(n)) * 4;
+    auto squares = randomSquares(n, extent);
+
+    RTree<double> tree;
+    double buildMs = timeMs([&] { tree = RTree<double>(squares); });
+
+    std::vector<Box<double>> boxes(n);
+    for (size_t i = 0; i < n; ++i)
+        boxes[i] = squares[i].bounds();
+
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> pos(0.0, extent);
+    const size_t queries = 200;
+    std::vector<Box<double>> windows;
+    for (size_t q = 0; q < queries; ++q) {
+        double x = pos(rng), y = pos(rng);
+        windows.emplace_back(x, y, x + 20, y + 20);
+    }
+
+    size_t hitsTree = 0, hitsScan = 0;
+    double treeMs = timeMs([&] {
+        for (const auto& w : windows)
+            hitsTree += tree.query(w).size();
+    });
+    double scanMs = timeMs([&] {
+        for (const auto& w : windows)
+            for (const auto& b : boxes)
+                hitsScan += b.intersects(w);
+    });
+    double knnMs = timeMs([&] {
+        for (const auto& w : windows)
+            tree.nearest(w.center(), 10);
+    });
+
+    std::cout << "rtree n=" << n << " build=" << buildMs << "ms"
+              << " window(tree)=" << treeMs / queries << "ms"
+              << " window(scan)=" << scanMs / queries << "ms"
+              << " knn10=" << knnMs / queries << "ms"
+              << (hitsTree == hitsScan ? "" : " MISMATCH") << "\n";
+}
+
+void benchPrint(size_t n) {
+    auto squares = randomSquares(n, 1000.0);
+
+    std::ostringstream os;
+    double streamMs = timeMs([&] {
+        for (int i = 0; i < squares.getSize(); ++i)
+            os << i << ": " << squares[i] << " | Area: " << static_cast<double>(squares[i]) << "\n";
+    });
+
+    std::string text;
+    double writerMs = timeMs([&] {
+        TextWriter out(text);
+        squares.printAll(out);
+    });
+
+    std::cout << "print n=" << n << " ostream=" << streamMs << "ms"
+              << " TextWriter=" << writerMs << "ms"
+              << (text == os.str() ? "" : " MISMATCH") << "\n";
+}
+
+void benchCompressed(size_t n) {
+    // Coordinates on a 0.01 grid, as in the archived collections.
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> pos(0, 100'000), side(50, 200);
+    Array<Square<double>> squares;
+    double expectedArea = 0;
+    for (size_t i = 0; i < n; ++i) {
+        int x = pos(rng), y = pos(rng);
+        squares.add(Square<double>(Point<double>(x / 100.0, y / 100.0), Point<double>((x + side(rng)) / 100.0, y / 100.0)));
+        expectedArea += static_cast<double>(squares[i]);
+    }
+
+    CompressedFigures packed;
+    double encodeMs = timeMs([&] { packed = CompressedFigures::encode(squares, 0.01); });
+    size_t rawBytes = BinaryFigureWriter::encode(squares).size();
+
+    ColumnBlock block;
+    size_t vertices = 0;
+    double decodeMs = timeMs([&] {
+        for (size_t b = 0; b < packed.blockCount(); ++b) {
+            packed.decodeBlock(b, block);
+            vertices += block.xs.size();
+        }
+    });
+    double area = 0;
+    double areaMs = timeMs([&] { area = packed.totalArea(); });
+
+    std::cout << "compressed n=" << n << " binary=" << rawBytes << "B"
+              << " compressed=" << packed.compressedSize() << "B"
+              << " ratio=" << double(rawBytes) / packed.compressedSize()
+              << " encode=" << encodeMs << "ms"
+              << " decode=" << vertices / decodeMs / 1000 << "M vertices/s"
+              << " totalArea=" << areaMs << "ms"
+              << (std::abs(area - expectedArea) <= 1e-6 * expectedArea ? "" : " MISMATCH") << "\n";
+}
+
+template <typename F>
+double timeThreadsMs(size_t threads, F&& body) {
+    return timeMs([&] {
+        std::vector<std::thread> pool;
+        for (size_t t = 0; t < threads; ++t)
+            pool.emplace_back(body, t);
+        for (auto& thread : pool)
+            thread.join();
+    });
+}
+
+void benchConcurrent(size_t n) {
+    using Ptr = std::shared_ptr<Figure<double>>;
+    auto make = [](size_t i) { return Ptr(std::make_shared<Square<double>>(Point<double>(i, 0), Point<double>(i + 1.0, 0))); };
+
+    for (size_t threads : {1, 2, 4, 8, 16, 32}) {
+        size_t perThread = n / threads;
+
+        Array<Ptr> locked;
+        std::mutex mutex;
+        double lockedMs = timeThreadsMs(threads, [&](size_t t) {
+            for (size_t i = 0; i < perThread; ++i) {
+                Ptr fig = make(t * perThread + i);
+                std::lock_guard<std::mutex> lock(mutex);
+                locked.add(std::move(fig));
+            }
+        });
+
+        ConcurrentArray<Ptr> concurrent;
+        double concurrentMs = timeThreadsMs(threads, [&](size_t t) {
+            auto out = concurrent.appender();
+            for (size_t i = 0; i < perThread; ++i)
+                out.add(make(t * perThread + i));
+        });
+
+        std::cout << "concurrent n=" << n << " threads=" << threads
+                  << " mutex+Array=" << lockedMs << "ms"
+                  << " ConcurrentArray=" << concurrentMs << "ms"
+                  << (size_t(concurrent.getSize()) == perThread * threads ? "" : " MISMATCH") << "\n";
+    }
+}
+
+void benchScheduler(size_t n) {
+    auto squares = randomSquares(n, 1000.0);
+
+    double serialArea = 0;
+    double serialMs = timeMs([&] {
+        for (int i = 0; i < squares.getSize(); ++i)
+            serialArea += static_cast<double>(squares[i]);
+    });
+    std::vector<Point<double>> serialCenters(n);
+    double serialCentersMs = timeMs([&] {
+        for (size_t i = 0; i < n; ++i)
+            serialCenters[i] = squares[i].center();
+    });
+    double pstlArea = 0;
+    double pstlMs = timeMs([&] {
+        pstlArea = std::transform_reduce(std::execution::par_unseq, squares.begin(), squares.end(), 0.0,
+                                         std::plus<>(), [](const auto& sq) { return static_cast<double>(sq); });
+    });
+    std::cout << "scheduler n=" << n << " serial area=" << serialMs << "ms centers=" << serialCentersMs << "ms"
+              << " std::transform_reduce(par_unseq) area=" << pstlMs << "ms"
+              << (std::abs(pstlArea - serialArea) <= 1e-9 * serialArea ? "" : " MISMATCH") << "\n";
+
+    size_t hardware = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    for (size_t workers = 1; workers <= std::max<size_t>(hardware, 32); workers *= 2) {
+        TaskScheduler scheduler(workers);
+        double area = 0;
+        double areaMs = timeMs([&] { area = parallelTotalArea(squares, scheduler); });
+        std::vector<Point<double>> centers;
+        double centersMs = timeMs([&] { centers = parallelCenters(squares, scheduler); });
+
+        std::cout << "scheduler n=" << n << " workers=" << workers
+                  << " area=" << areaMs << "ms (x" << serialMs / areaMs << ")"
+                  << " centers=" << centersMs << "ms (x" << serialCentersMs / centersMs << ")"
+                  << (std::abs(area - serialArea) <= 1e-9 * serialArea && centers == serialCenters ? "" : " MISMATCH")
+                  << "\n";
+    }
+}
+
+template <typename Container>
+void benchGrowth(const char* name, const Array<Square<double>>& source) {
+    Container figures;
+    double worstUs = 0;
+    double totalMs = timeMs([&] {
+        for (int i = 0; i < source.getSize(); ++i) {
+            double us = 1000 * timeMs([&] { figures.add(source[i]); });
+            worstUs = std::max(worstUs, us);
+        }
+    });
+
+    double area = 0;
+    double scanMs = timeMs([&] {
+        for (int i = 0; i < figures.getSize(); ++i)
+            area += static_cast<double>(figures[i]);
+    });
+
+    std::cout << "  " << name << " add total=" << totalMs << "ms worst add=" << worstUs << "us"
+              << " indexed scan=" << scanMs << "ms (area " << area << ")\n";
+}
+
+void benchSegmented(size_t n) {
+    auto source = randomSquares(n, 1000.0);
+    std::cout << "segmented n=" << n << "\n";
+    benchGrowth<Array<Square<double>>>("Array         ", source);
+    benchGrowth<SegmentedArray<Square<double>>>("SegmentedArray", source);
+
+    SegmentedArray<Square<double>> figures;
+    for (int i = 0; i < source.getSize(); ++i)
+        figures.add(source[i]);
+    double area = 0;
+    double blockMs = timeMs([&] {
+        figures.forEachBlock([&](std::span<const Square<double>> block) {
+            for (const auto& sq : block)
+                area += static_cast<double>(sq);
+        });
+    });
+    std::cout << "  SegmentedArray block scan=" << blockMs << "ms (area " << area << ")\n";
+}
+
+void benchQuery(size_t n) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<double> pos(0.0, 1000.0);
+    std::uniform_real_distribution<double> side(0.5, 2.0);
+    Array<std::shared_ptr<Figure<double>>> figures;
+    TypedFigureStore<double> store;
+    for (size_t i = 0; i < n; ++i) {
+        Point<double> a(pos(rng), pos(rng));
+        Point<double> b(a.x() + side(rng), a.y());
+        std::shared_ptr<Figure<double>> fig;
+        if (i % 3 == 0)
+            fig = std::make_shared<Square<double>>(a, b);
+        else if (i % 3 == 1)
+            fig = std::make_shared<Triangle<double>>(a, b, 1.0);
+        else
+            fig = std::make_shared<Octagon<double>>(a, b);
+        figures.add(fig);
+        store.add(*fig);
+    }
+
+    const double minArea = 6.0;
+    Point<double> multiPass;
+    double multiMs = timeMs([&] {
+        std::vector<std::shared_ptr<Octagon<double>>> octagons;
+        for (const auto& fig : figures)
+            if (auto oct = std::dynamic_pointer_cast<Octagon<double>>(fig))
+                octagons.push_back(oct);
+        std::vector<std::shared_ptr<Octagon<double>>> large;
+        for (const auto& oct : octagons)
+            if (static_cast<double>(*oct) > minArea)
+                large.push_back(oct);
+        std::vector<Point<double>> centers;
+        for (const auto& oct : large)
+            centers.push_back(oct->center());
+        for (const auto& c : centers)
+            multiPass += c;
+    });
+
+    auto large = [&](const auto& source) {
+        return query(source).template ofType<Octagon>().where(FigureField::area > minArea).select(FigureField::center);
+    };
+    Point<double> fused, typed, parallel;
+    double fusedMs = timeMs([&] { fused = large(figures).sum(); });
+    double typedMs = timeMs([&] { typed = large(store).sum(); });
+    double parallelMs = timeMs([&] { parallel = large(store).parallel().sum(); });
+
+    auto same = [&](const Point<double>& p) {
+        return std::abs(p.x() - multiPass.x()) <= 1e-9 * std::abs(multiPass.x()) &&
+               std::abs(p.y() - multiPass.y()) <= 1e-9 * std::abs(multiPass.y());
+    };
+    std::cout << "query n=" << n << " multi-pass=" << multiMs << "ms fused=" << fusedMs << "ms"
+              << " typed store=" << typedMs << "ms typed parallel=" << parallelMs << "ms"
+              << (same(fused) && same(typed) && same(parallel) ? "" : " MISMATCH") << "\n";
+}
+
+void benchSketch(size_t n) {
+    auto squares = randomSquares(n, 1000.0);
+
+    std::vector<double> areas;
+    double exactP50 = 0, exactP99 = 0;
+    double exactMs = timeMs([&] {
+        for (const auto& sq : squares)
+            areas.push_back(static_cast<double>(sq));
+        std::sort(areas.begin(), areas.end());
+        exactP50 = areas[areas.size() / 2];
+        exactP99 = areas[areas.size() * 99 / 100];
+    });
+
+    QuantileSketch sketch;
+    double sketchMs = timeMs([&] {
+        for (const auto& sq : squares)
+            sketch.add(static_cast<double>(sq));
+    });
+    auto rankError = [&](double value, double q) {
+        double rank = double(std::upper_bound(areas.begin(), areas.end(), value) - areas.begin()) / areas.size();
+        return std::abs(rank - q);
+    };
+
+    Box<double> extent(0, 0, 1002, 1002);
+    double parallelMs = timeMs([&] { sketchFigures(squares, extent, 64, 64); });
+
+    std::cout << "sketch n=" << n << " exact sort=" << exactMs << "ms (" << areas.size() * sizeof(double) / 1024 << " KiB)"
+              << " p50=" << exactP50 << " p99=" << exactP99 << "\n"
+              << "  kll add=" << sketchMs << "ms (" << sketch.retained() * sizeof(double) / 1024 << " KiB)"
+              << " p50=" << sketch.quantile(0.5) << " p99=" << sketch.quantile(0.99)
+              << " rank error=" << std::max(rankError(sketch.quantile(0.5), 0.5), rankError(sketch.quantile(0.99), 0.99))
+              << "\n  sketchFigures (areas + 64x64 centers, parallel)=" << parallelMs << "ms\n";
+}
+
+void benchWindow(size_t n) {
+    using namespace std::chrono_literals;
+    auto squares = randomSquares(1024, 1000.0);
+
+    // Simulated steady stream of one figure per microsecond.
+    auto sliding = SlidingWindow<double>::lastDuration(10ms);
+    auto start = WindowClock::time_point();
+    double slidingMs = timeMs([&] {
+        for (size_t i = 0; i < n; ++i)
+            sliding.add(squares[i % 1024], start + i * 1us);
+    });
+
+    uint64_t windows = 0;
+    auto tumbling = TumblingWindow<double>::everyDuration(10ms, [&](const WindowStats&) { ++windows; });
+    double tumblingMs = timeMs([&] {
+        for (size_t i = 0; i < n; ++i)
+            tumbling.add(squares[i % 1024], start + i * 1us);
+    });
+
+    std::cout << "window n=" << n
+              << " sliding 10ms=" << n / slidingMs / 1000 << "M events/s (size " << sliding.size()
+              << ", capacity " << sliding.capacity() << ")"
+              << " tumbling 10ms=" << n / tumblingMs / 1000 << "M events/s (" << windows << " windows)\n";
+}
+
+void benchPipeline(size_t n) {
+    std::string text;
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<double> pos(0.0, 1000.0);
+    for (size_t i = 0; i < n; ++i) {
+        double x = pos(rng), y = pos(rng);
+        text += (i % 2 ? "S " : "O ") + std::to_string(x) + " " + std::to_string(y) + " " +
+                std::to_string(x + 1) + " " + std::to_string(y) + "\n";
+    }
+    Box<double> extent(-10, -10, 1010, 1010);
+
+    double batchMs = timeMs([&] {
+        auto loaded = FigureLoader<double>::parse(text);
+        FigureSketch<double> sketch(extent, 32, 32);
+        sketch.addAll(loaded.figures);
+    });
+
+    using FigurePtr = std::shared_ptr<Figure<double>>;
+    double streamMs = timeMs([&] {
+        std::istringstream in(text);
+        FigureSketch<double> sketch(extent, 32, 32);
+        Pipeline pipeline;
+        auto& parsed = pipeline.channel<FigurePtr>(256);
+        auto& moved = pipeline.channel<FigurePtr>(256);
+        pipeline.produce(FigureLoader<double>::stream(in), parsed);
+        pipeline.transform(parsed, moved, [](FigurePtr fig) {
+            fig->transform(Affine2<double>::translation(1, 1));
+            return fig;
+        }, std::max<size_t>(std::thread::hardware_concurrency(), 1));
+        pipeline.consume(moved, [&](FigurePtr fig) { sketch.add(*fig); });
+        pipeline.wait();
+    });
+
+    std::cout << "pipeline n=" << n << " batch parse+sketch=" << batchMs << "ms (" << n / batchMs / 1000
+              << "M figures/s, all figures in memory)"
+              << " streamed parse->transform->sketch=" << streamMs << "ms (" << n / streamMs / 1000
+              << "M figures/s, at most 512 in flight)\n";
+}
+
+void benchServer(size_t n) {
+    std::string path = "/tmp/figure_bench_" + std::to_string(::getpid()) + ".sock";
+    FigureServer<double> server(path);
+    std::thread loop([&] { server.run(); });
+
+    for (size_t depth : {1, 8, 32}) {
+        LoadOptions options;
+        options.requests = n;
+        options.depth = depth;
+        LoadReport report = runLoad(path, options);
+        std::cout << "server requests=" << report.requests << " batch=" << options.batch << " depth=" << depth
+                  << " " << report.requests / report.seconds << " requests/s"
+                  << " latency us p50=" << report.p50 << " p90=" << report.p90 << " p99=" << report.p99
+                  << " max=" << report.max << "\n";
+    }
+
+    server.stop();
+    loop.join();
+}
+
+void benchShared(size_t n) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    figs.setVerbose(false);
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> pos(0.0, 1000.0);
+    for (size_t i = 0; i < n; ++i) {
+        double x = pos(rng), y = pos(rng);
+        if (i % 2)
+            figs.add(std::make_shared<Square<double>>(Point<double>(x, y), Point<double>(x + 1, y)));
+        else
+            figs.add(std::make_shared<Octagon<double>>(Point<double>(x, y), Point<double>(x + 1, y)));
+    }
+
+    SharedFigureStore<double> store("/figure_bench_" + std::to_string(::getpid()), n);
+    double appendMs = timeMs([&] { store.append(figs); });
+    SharedFigureView<double> view(store.segmentName());
+
+    double arrayArea = 0.0, sharedArea = 0.0;
+    double arrayMs = timeMs([&] {
+        for (int i = 0; i < figs.getSize(); ++i)
+            arrayArea += static_cast<double>(*figs[i]);
+    });
+    double sharedMs = timeMs([&] { sharedArea = view.totalArea(); });
+    size_t hits = 0;
+    double regionMs = timeMs([&] { hits = view.region(Box<double>(100, 100, 200, 200)).size(); });
+    double updateMs = timeMs([&] {
+        for (size_t i = 1; i < n; i += 2)
+            store.update(i, *figs[i]);
+    });
+
+    std::cout << "shared n=" << n << " append=" << appendMs << "ms"
+              << " area array=" << arrayMs << "ms shared=" << sharedMs << "ms (diff " << arrayArea - sharedArea << ")"
+              << " region=" << regionMs << "ms (" << hits << " hits)"
+              << " update=" << (n / 2) / updateMs / 1000 << "M/s\n";
+}
+
+int main(int argc, char** argv) {
+    std::map<std::string, std::pair<std::function<void(size_t)>, std::vector<size_t>>> benches = {
+        {"rtree", {benchRTree, {10'000, 1'000'000, 10'000'000}}},
+        {"print", {benchPrint, {100'000, 1'000'000}}},
+        {"compressed", {benchCompressed, {100'000, 1'000'000}}},
+        {"concurrent", {benchConcurrent, {1'000'000}}},
+        {"scheduler", {benchScheduler, {1'000'000, 10'000'000}}},
+        {"segmented", {benchSegmented, {1'000'000}}},
+        {"query", {benchQuery, {100'000, 1'000'000}}},
+        {"sketch", {benchSketch, {1'000'000}}},
+        {"window", {benchWindow, {1'000'000, 10'000'000}}},
+        {"pipeline", {benchPipeline, {100'000, 1'000'000}}},
+        {"server", {benchServer, {2'000}}},
+        {"shared", {benchShared, {100'000, 1'000'000}}},
+    };
+
+    if (argc < 2 || !benches.count(argv[1])) {
+        std::cout << "Usage: " << argv[0] << " <benchmark> [sizes...]\nBenchmarks:";
+        for (const auto& [name, bench] : benches)
+            std::cout << " " << name;
+        std::cout << "\n";
+        return 1;
+    }
+
+    auto& [run, sizes] = benches[argv[1]];
+    if (argc > 2) {
+        sizes.clear();
+        for (int i = 2; i < argc; ++i)
+            sizes.push_back(std::stoull(argv[i]));
+    }
+
+    for (size_t n : sizes)
+        run(n);
+
+    return 0;
+}
@@ -0,0 +1,71 @@
+#pragma once
+
+#include "point.h"
+
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+// 2-D affine map p -> (a*x + b*y + tx, c*x + d*y + ty).
+template <Scalar T>
+class Affine2 {
+public:
+    T a{1}, b{0}, c{0}, d{1}, tx{0}, ty{0};
+
+    Affine2() = default;
+    Affine2(T a, T b, T c, T d, T tx, T ty) : a(a), b(b), c(c), d(d), tx(tx), ty(ty) {}
+
+    static Affine2 translation(T dx, T dy) {
+        return Affine2(1, 0, 0, 1, dx, dy);
+    }
+
+    // Integer maps can only turn by whole quarter turns, whose cosine and
+    // sine are exact; truncating them would collapse any other angle.
+    static Affine2 rotation(double angle, const Point<T>& pivot = Point<T>()) {
+        T cs, sn;
+        if constexpr (std::is_integral_v<T>) {
+            double quarters = angle / (std::numbers::pi / 2);
+            double whole = std::round(quarters);
+            if (!(std::abs(quarters - whole) <= 1e-9))
+                throw std::invalid_argument("Integer rotations must be multiples of 90 degrees");
+            static constexpr int cosines[4] = {1, 0, -1, 0};
+            int q = static_cast<int>(std::fmod(whole, 4.0));
+            q = (q + 4) % 4;
+            cs = static_cast<T>(cosines[q]);
+            sn = static_cast<T>(cosines[(q + 3) % 4]);
+        } else {
+            cs = static_cast<T>(std::cos(angle));
+            sn = static_cast<T>(std::sin(angle));
+        }
+        return translation(pivot.x(), pivot.y()) * Affine2(cs, -sn, sn, cs, 0, 0) *
+               translation(-pivot.x(), -pivot.y());
+    }
+
+    static Affine2 scaling(T factor, const Point<T>& pivot = Point<T>()) {
+        return translation(pivot.x(), pivot.y()) * Affine2(factor, 0, 0, factor, 0, 0) *
+               translation(-pivot.x(), -pivot.y());
+    }
+
+    // (m * n).apply(p) == m.apply(n.apply(p)).
+    Affine2 operator*(const Affine2& n) const {
+        return Affine2(a * n.a + b * n.c, a * n.b + b * n.d,
+                       c * n.a + d * n.c, c * n.b + d * n.d,
+                       a * n.tx + b * n.ty + tx, c * n.tx + d * n.ty + ty);
+    }
+
+    Point<T> apply(const Point<T>& p) const {
+        return Point<T>(a * p.x() + b * p.y() + tx, c * p.x() + d * p.y() + ty);
+    }
+
+    bool isIdentity() const {
+        return a == 1 && b == 0 && c == 0 && d == 1 && tx == 0 && ty == 0;
+    }
+
+    // Rotation + uniform scale + translation: the maps that keep a square a
+    // square and keep vertices counter-clockwise.
+    bool isSimilarity() const {
+        double tolerance = 1e-9 * (std::abs(double(a)) + std::abs(double(b)) + 1.0);
+        return std::abs(double(a) - d) <= tolerance && std::abs(double(b) + c) <= tolerance &&
+               double(a) * d - double(b) * c > 0;
+    }
+};
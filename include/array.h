@@ -1,136 +1,211 @@
-#pragma once
-
-#include "figure.h"
-
-#include <iostream>
-#include <memory>
-#include <stdexcept>
-#include <iomanip>
-#include <type_traits>
-
-template <typename T>
-class Array {
-public:
-    Array() : data(std::make_shared<T[]>(2)), capacity(2), size(0) {}
-    ~Array() = default;
-
-    Array(const Array& other) = delete;
-    Array& operator=(const Array& other) = delete;
-
-    Array(Array&& other) noexcept
-        : data(std::move(other.data)), capacity(other.capacity), size(other.size) {
-        other.capacity = 0;
-        other.size = 0;
-    }
-
-    Array& operator=(Array&& other) noexcept {
-        if (this != &other) {
-            data = std::move(other.data);
-            capacity = other.capacity;
-            size = other.size;
-
-            other.capacity = 0;
-            other.size = 0;
-        }
-        return *this;
-    }
-
-    template <typename U>
-    void add(U&& fig) {
-        if (size >= capacity)
-            grow();
-        data[size++] = std::forward<U>(fig);
-    }
-
-    void remove(size_t index) {
-        if (!size)
-            throw std::out_of_range("Array is empty");
-        if (index >= size)
-            throw std::out_of_range("Index out of range");
-        
-        for (size_t i = index; i < size - 1; ++i)
-            data[i] = std::move(data[i + 1]);
-
-        if constexpr (requires { data[size - 1].reset(); })
-            data[size - 1].reset();
-
-        --size;
-        std::cout << "Element at index " << index << " removed.\n";
-    }
-
-    void printAll() const {
-        if (!size) 
-            throw std::out_of_range("Array is empty");
-
-        for (size_t i = 0; i < size; ++i) {
-            if constexpr (requires { *data[i]; }) {
-                std::cout << i << ": " << *data[i]
-                          << " | Area: " << static_cast<double>(*data[i]) << "\n";
-            } else {
-                std::cout << i << ": " << data[i]
-                          << " | Area: " << static_cast<double>(data[i]) << "\n";
-            }
-        }
-    }
-
-    void printCenters() const {
-        if (!size) 
-            throw std::out_of_range("Array is empty");
-
-        for (size_t i = 0; i < size; ++i) {
-            if constexpr (requires { data[i]->center(); }) {
-                auto c = data[i]->center();
-                std::cout << i << ": Center = (" << c.x() << ", " << c.y() << ")\n";
-            } else if constexpr (requires { data[i].center(); }) {
-                auto c = data[i].center();
-                std::cout << i << ": Center = (" << c.x() << ", " << c.y() << ")\n";
-            }
-        }
-    }
-
-    void printTotalArea() const {
-        if (!size) 
-            throw std::out_of_range("Array is empty");
-        
-        double totalArea = 0.0;
-        for (size_t i = 0; i < size; ++i) {
-            if constexpr (requires { double(data[i]); }) 
-                totalArea += double(data[i]);
-            else if constexpr (requires { double(*data[i]); }) 
-                totalArea += double(*data[i]);
-        }
-
-        std::cout << "Total Area: " << totalArea << "\n";
-    }
-
-    T& operator[](size_t index) {
-        if (index >= size) 
-            throw std::out_of_range("Index out of range");
-        return data[index];
-    }
-
-    const T& operator[](size_t index) const {
-        if (index >= size) 
-            throw std::out_of_range("Index out of range");
-        return data[index];
-    }
-
-    int getSize() const {
-        return static_cast<int>(size);
-    }
-
-private:
-    void grow() {
-        capacity = (capacity == 0) ? 2 : capacity * 2;
-        auto newData = std::make_shared<T[]>(capacity);
-
-        for (size_t i = 0; i < size; ++i)
-            newData[i] = data[i];
-
-        data = newData;
-    }
-
-    std::shared_ptr<T[]> data;
-    size_t capacity;
-    size_t size;
-};
\ No newline at end of file
+#pragma once
+
+#include "figure.h"
+
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+#include <iomanip>
+#include <span>
+#include <type_traits>
+
+template <typename T>
+class Array {
+public:
+    Array() : items(std::make_shared<T[]>(2)), capacity(2), size(0) {}
+    ~Array() = default;
+
+    Array(const Array& other) = delete;
+    Array& operator=(const Array& other) = delete;
+
+    Array(Array&& other) noexcept
+        : items(std::move(other.items)), capacity(other.capacity), size(other.size), verbose(other.verbose) {
+        other.capacity = 0;
+        other.size = 0;
+    }
+
+    Array& operator=(Array&& other) noexcept {
+        if (this != &other) {
+            items = std::move(other.items);
+            capacity = other.capacity;
+            size = other.size;
+            verbose = other.verbose;
+
+            other.capacity = 0;
+            other.size = 0;
+        }
+        return *this;
+    }
+
+    template <typename U>
+    void add(U&& fig) {
+        if (size >= capacity)
+            grow();
+        items[size++] = std::forward<U>(fig);
+    }
+
+    void remove(size_t index) {
+        if (!size)
+            throw std::out_of_range("Array is empty");
+        if (index >= size)
+            throw std::out_of_range("Index out of range");
+        
+        for (size_t i = index; i < size - 1; ++i)
+            items[i] = std::move(items[i + 1]);
+
+        if constexpr (requires { items[size - 1].reset(); })
+            items[size - 1].reset();
+
+        --size;
+        if (verbose)
+            std::cout << "Element at index " << index << " removed.\n";
+    }
+
+    void printAll() const {
+        TextWriter out(std::cout);
+        printAll(out);
+    }
+
+    void printAll(TextWriter& out) const {
+        printFigures(*this, out);
+    }
+
+    void printCenters() const {
+        TextWriter out(std::cout);
+        printCenters(out);
+    }
+
+    void printCenters(TextWriter& out) const {
+        printFigureCenters(*this, out);
+    }
+
+    void printTotalArea() const {
+        TextWriter out(std::cout);
+        printTotalArea(out);
+    }
+
+    void printTotalArea(TextWriter& out) const {
+        printFiguresTotalArea(*this, out);
+    }
+
+    T& operator[](size_t index) {
+        if (index >= size) 
+            throw std::out_of_range("Index out of range");
+        return items[index];
+    }
+
+    const T& operator[](size_t index) const {
+        if (index >= size) 
+            throw std::out_of_range("Index out of range");
+        return items[index];
+    }
+
+    int getSize() const {
+        return static_cast<int>(size);
+    }
+
+    // Unchecked contiguous access: plain pointers are contiguous iterators, so
+    // Array works with range-for, std::ranges and the parallel STL algorithms.
+    T* data() {
+        return items.get();
+    }
+
+    const T* data() const {
+        return items.get();
+    }
+
+    T* begin() {
+        return data();
+    }
+
+    T* end() {
+        return data() + size;
+    }
+
+    const T* begin() const {
+        return data();
+    }
+
+    const T* end() const {
+        return data() + size;
+    }
+
+    std::span<T> span() {
+        return std::span<T>(data(), size);
+    }
+
+    std::span<const T> span() const {
+        return std::span<const T>(data(), size);
+    }
+
+    // Turns the per-operation messages (e.g. in remove) on or off.
+    void setVerbose(bool enabled) {
+        verbose = enabled;
+    }
+
+    bool isVerbose() const {
+        return verbose;
+    }
+
+private:
+    void grow() {
+        capacity = (capacity == 0) ? 2 : capacity * 2;
+        auto newData = std::make_shared<T[]>(capacity);
+
+        for (size_t i = 0; i < size; ++i)
+            newData[i] = items[i];
+
+        items = newData;
+    }
+
+    std::shared_ptr<T[]> items;
+    size_t capacity;
+    size_t size;
+    bool verbose = true;
+};
+
+// Anything that can be read like an Array of figures: getSize() plus operator[]
+// yielding a figure or a pointer to one.
+template <typename C>
+concept FigureContainer = requires(const C& figures) {
+    figures.getSize();
+    asFigure(figures[0]);
+};
+
+// Array-style reports over any range of figures or pointers to figures, for
+// containers that are iterated rather than indexed.
+template <typename R>
+void printFigures(const R& figures, TextWriter& out) {
+    if (figures.begin() == figures.end())
+        throw std::out_of_range("Array is empty");
+
+    size_t i = 0;
+    for (const auto& elem : figures) {
+        const auto& fig = asFigure(elem);
+        out << i++ << ": ";
+        fig.writeTo(out);
+        out << " | Area: " << static_cast<double>(fig) << "\n";
+    }
+}
+
+template <typename R>
+void printFigureCenters(const R& figures, TextWriter& out) {
+    if (figures.begin() == figures.end())
+        throw std::out_of_range("Array is empty");
+
+    size_t i = 0;
+    for (const auto& elem : figures)
+        out << i++ << ": Center = " << asFigure(elem).center() << "\n";
+}
+
+template <typename R>
+void printFiguresTotalArea(const R& figures, TextWriter& out) {
+    if (figures.begin() == figures.end())
+        throw std::out_of_range("Array is empty");
+
+    double totalArea = 0.0;
+    for (const auto& elem : figures)
+        totalArea += static_cast<double>(asFigure(elem));
+
+    out << "Total Area: " << totalArea << "\n";
+}
@@ -0,0 +1,178 @@
+#pragma once
+
+#include "array.h"
+#include "binary_format.h"
+#include "figure_store.h"
+#include "loader.h"
+#include "text_writer.h"
+
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <memory>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// Runs figure commands from a script, one per line, with no prompts:
+//   add S|T|O <numbers>   figure in the FigureLoader line format
+//   remove INDEX
+//   print | centers | area
+//   load PATH             text figure file, or binary when it starts with FIGB
+//   save PATH             binary figure file
+// Blank lines and lines starting with '#' are skipped. All output goes
+// through one buffered TextWriter. A failing command is reported on the error
+// stream with its line number and the script goes on. Quiet mode drops the
+// per-operation messages (added, removed, loaded, saved) and keeps the
+// output of print, centers and area.
+template <Scalar T>
+class BatchRunner {
+public:
+    explicit BatchRunner(TextWriter& out, std::ostream& err, FigureStore<T>* store = nullptr)
+        : out(out), err(err), store(store) {
+        if (store)
+            store->setVerbose(false);
+        memoryFigures.setVerbose(false);
+    }
+
+    void setQuiet(bool enabled) {
+        quiet = enabled;
+    }
+
+    // Returns the number of commands that failed.
+    size_t run(std::istream& script) {
+        std::string line;
+        size_t number = 0, failed = 0;
+        while (std::getline(script, line)) {
+            ++number;
+            try {
+                execute(line);
+            } catch (const std::exception& e) {
+                out.flush();
+                err << "line " << number << ": " << e.what() << "\n";
+                ++failed;
+            }
+        }
+        out.flush();
+        return failed;
+    }
+
+    const Array<std::shared_ptr<Figure<T>>>& figures() const {
+        return store ? store->figures() : memoryFigures;
+    }
+
+private:
+    static std::string_view nextWord(std::string_view& line) {
+        size_t begin = line.find_first_not_of(" \t\r");
+        if (begin == std::string_view::npos) {
+            line = {};
+            return {};
+        }
+        size_t end = line.find_first_of(" \t\r", begin);
+        if (end == std::string_view::npos)
+            end = line.size();
+        std::string_view word = line.substr(begin, end - begin);
+        line.remove_prefix(end);
+        return word;
+    }
+
+    static std::string_view rest(std::string_view line) {
+        size_t begin = line.find_first_not_of(" \t\r");
+        size_t end = line.find_last_not_of(" \t\r");
+        return begin == std::string_view::npos ? std::string_view() : line.substr(begin, end - begin + 1);
+    }
+
+    void expectEnd(std::string_view line) const {
+        if (!rest(line).empty())
+            throw std::invalid_argument("Unexpected trailing input");
+    }
+
+    void add(std::shared_ptr<Figure<T>> fig) {
+        store ? store->add(std::move(fig)) : memoryFigures.add(std::move(fig));
+    }
+
+    void execute(std::string_view line) {
+        std::string_view command = nextWord(line);
+        if (command.empty() || command[0] == '#')
+            return;
+
+        if (command == "add") {
+            auto fig = FigureLoader<T>::parseFigure(line);
+            std::string_view name = fig->name();
+            add(std::move(fig));
+            if (!quiet)
+                out << "Added " << name << ".\n";
+        } else if (command == "remove") {
+            std::string_view word = nextWord(line);
+            expectEnd(line);
+            size_t index = 0;
+            auto [ptr, ec] = std::from_chars(word.data(), word.data() + word.size(), index);
+            if (word.empty() || ec != std::errc() || ptr != word.data() + word.size())
+                throw std::invalid_argument("Expected an index after 'remove'");
+            store ? store->remove(index) : memoryFigures.remove(index);
+            if (!quiet)
+                out << "Element at index " << index << " removed.\n";
+        } else if (command == "print") {
+            expectEnd(line);
+            figures().printAll(out);
+        } else if (command == "centers") {
+            expectEnd(line);
+            figures().printCenters(out);
+        } else if (command == "area") {
+            expectEnd(line);
+            figures().printTotalArea(out);
+        } else if (command == "load") {
+            load(std::string(rest(line)));
+        } else if (command == "save") {
+            std::string path(rest(line));
+            if (path.empty())
+                throw std::invalid_argument("Expected a path after 'save'");
+            BinaryFigureWriter::write(figures(), path);
+            if (!quiet)
+                out << "Saved " << figures().getSize() << " figures to " << path << ".\n";
+        } else {
+            throw std::invalid_argument("Unknown command '" + std::string(command) + "'");
+        }
+    }
+
+    void load(const std::string& path) {
+        if (path.empty())
+            throw std::invalid_argument("Expected a path after 'load'");
+
+        char magic[4] = {};
+        {
+            std::ifstream probe(path, std::ios::binary);
+            if (!probe)
+                throw std::runtime_error("Cannot open " + path);
+            probe.read(magic, sizeof(magic));
+        }
+
+        size_t loaded = 0;
+        if (std::memcmp(magic, BinaryFormat::magic, sizeof(magic)) == 0) {
+            auto figs = BinaryFigureFile(path).figures<T>();
+            for (int i = 0; i < figs.getSize(); ++i, ++loaded)
+                add(figs[i]);
+        } else {
+            auto result = FigureLoader<T>::loadFile(path);
+            for (int i = 0; i < result.figures.getSize(); ++i, ++loaded)
+                add(result.figures[i]);
+            if (!result.errors.empty()) {
+                out.flush();
+                for (const auto& error : result.errors)
+                    err << path << ":" << error.line << ": " << error.message << "\n";
+                throw std::runtime_error("Loaded " + std::to_string(loaded) + " figures from " + path + " with " +
+                                         std::to_string(result.errors.size()) + " errors");
+            }
+        }
+        if (!quiet)
+            out << "Loaded " << loaded << " figures from " << path << ".\n";
+    }
+
+    TextWriter& out;
+    std::ostream& err;
+    FigureStore<T>* store;
+    Array<std::shared_ptr<Figure<T>>> memoryFigures;
+    bool quiet = false;
+};
@@ -0,0 +1,316 @@
+#pragma once
+
+#include "array.h"
+#include "square.h"
+#include "triangle.h"
+#include "octagon.h"
+#include "mapped_file.h"
+#include "generator.h"
+
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Versioned binary figure file, all fields little-endian:
+//
+//   header (96 bytes)   0: magic "FIGB", 4: u16 version, 6: u16 header size,
+//                       8: figure count, 16: per-type counts, 40: per-type
+//                       section offsets, 64: order offset, 72: checksum of
+//                       the whole file with this field left out, 80: reserved
+//   order section       one type byte per figure, in Array order
+//   per-type sections   8-byte aligned; xs column then ys column of f64,
+//                       vertex v of figure f at f * vertices + v
+//
+// Squares, triangles and octagons store 4, 3 and 8 vertices.
+
+enum class FigureKind : uint8_t {
+    Square = 0,
+    Triangle = 1,
+    Octagon = 2
+};
+
+class BinaryFormat {
+public:
+    static constexpr char magic[4] = {'F', 'I', 'G', 'B'};
+    static constexpr uint16_t version = 2;
+    static constexpr size_t headerSize = 96;
+    static constexpr size_t kinds = 3;
+    static constexpr std::array<size_t, kinds> vertexCounts = {4, 3, 8};
+    static constexpr size_t maxVertices = 8;
+
+    template <Scalar T>
+    static FigureKind kindOf(const Figure<T>& fig) {
+        std::string_view name = fig.name();
+        if (name == "Square")
+            return FigureKind::Square;
+        if (name == "Triangle")
+            return FigureKind::Triangle;
+        if (name == "Octagon")
+            return FigureKind::Octagon;
+        throw std::invalid_argument("Unsupported figure type: " + std::string(name));
+    }
+
+    // Rebuilds a figure of the given kind from its stored vertices.
+    template <Scalar T>
+    static std::shared_ptr<Figure<T>> makeFigure(FigureKind kind, std::span<const Point<T>> vertices) {
+        switch (kind) {
+            case FigureKind::Square:
+                return std::make_shared<Square<T>>(Square<T>::fromVertices(vertices.template first<4>()));
+            case FigureKind::Triangle:
+                return std::make_shared<Triangle<T>>(Triangle<T>::fromVertices(vertices.template first<3>()));
+            case FigureKind::Octagon:
+                return std::make_shared<Octagon<T>>(Octagon<T>::fromVertices(vertices.template first<8>()));
+        }
+        throw std::invalid_argument("Unknown figure kind");
+    }
+
+    static size_t align8(size_t offset) {
+        return (offset + 7) & ~size_t(7);
+    }
+
+    static void storeLE(unsigned char* out, uint64_t value) {
+        for (int i = 0; i < 8; ++i)
+            out[i] = static_cast<unsigned char>(value >> (8 * i));
+    }
+
+    static uint64_t loadLE(const unsigned char* in) {
+        uint64_t value = 0;
+        for (int i = 0; i < 8; ++i)
+            value |= uint64_t(in[i]) << (8 * i);
+        return value;
+    }
+
+    static uint16_t loadLE16(const unsigned char* in) {
+        return static_cast<uint16_t>(in[0] | (in[1] << 8));
+    }
+
+    // FNV-1a over little-endian 64-bit words, then the tail bytes; hash
+    // continues an earlier checksum.
+    static uint64_t checksum(const unsigned char* data, size_t size, uint64_t hash = 1469598103934665603ull) {
+        size_t i = 0;
+        for (; i + 8 <= size; i += 8)
+            hash = (hash ^ loadLE(data + i)) * 1099511628211ull;
+        for (; i < size; ++i)
+            hash = (hash ^ data[i]) * 1099511628211ull;
+        return hash;
+    }
+
+    // The stored checksum: every byte of the file but its own field. Version
+    // 1 files covered only the bytes after the header.
+    static uint64_t fileChecksum(const unsigned char* data, size_t size, uint16_t fileVersion = version) {
+        if (fileVersion == 1)
+            return checksum(data + headerSize, size - headerSize);
+        return checksum(data + 80, size - 80, checksum(data, 72));
+    }
+};
+
+class BinaryFigureWriter {
+public:
+    template <typename E>
+    static std::vector<unsigned char> encode(const Array<E>& figures) {
+        using F = BinaryFormat;
+        size_t n = figures.getSize();
+
+        std::vector<uint8_t> order(n);
+        std::array<size_t, F::kinds> counts{};
+        for (size_t i = 0; i < n; ++i) {
+            order[i] = static_cast<uint8_t>(F::kindOf(asFigure(figures[i])));
+            ++counts[order[i]];
+        }
+
+        std::array<size_t, F::kinds> offsets{};
+        size_t offset = F::align8(F::headerSize + n);
+        for (size_t k = 0; k < F::kinds; ++k) {
+            offsets[k] = offset;
+            offset += 2 * counts[k] * F::vertexCounts[k] * sizeof(double);
+        }
+
+        std::vector<unsigned char> out(offset, 0);
+        std::memcpy(out.data(), F::magic, 4);
+        out[4] = F::version & 0xFF;
+        out[5] = F::version >> 8;
+        out[6] = F::headerSize & 0xFF;
+        out[7] = F::headerSize >> 8;
+        F::storeLE(&out[8], n);
+        for (size_t k = 0; k < F::kinds; ++k) {
+            F::storeLE(&out[16 + 8 * k], counts[k]);
+            F::storeLE(&out[40 + 8 * k], offsets[k]);
+        }
+        F::storeLE(&out[64], F::headerSize);
+        std::memcpy(&out[F::headerSize], order.data(), n);
+
+        std::array<size_t, F::kinds> written{};
+        for (size_t i = 0; i < n; ++i) {
+            const auto& fig = asFigure(figures[i]);
+            size_t k = order[i];
+            size_t vertices = F::vertexCounts[k];
+            size_t column = counts[k] * vertices * sizeof(double);
+
+            for (size_t v = 0; v < vertices; ++v) {
+                auto p = fig.vertex(v);
+                size_t at = offsets[k] + (written[k] * vertices + v) * sizeof(double);
+                F::storeLE(&out[at], std::bit_cast<uint64_t>(static_cast<double>(p.x())));
+                F::storeLE(&out[at + column], std::bit_cast<uint64_t>(static_cast<double>(p.y())));
+            }
+            ++written[k];
+        }
+
+        F::storeLE(&out[72], F::fileChecksum(out.data(), out.size()));
+        return out;
+    }
+
+    template <typename E>
+    static void write(const Array<E>& figures, const std::string& path) {
+        std::vector<unsigned char> bytes = encode(figures);
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), static_cast<std::streamsize>(bytes.size()));
+        if (!file)
+            throw std::runtime_error("Cannot write file: " + path);
+    }
+};
+
+// Reader over a whole binary figure file. When the host is little-endian and
+// the columns are 8-byte aligned, xs()/ys() point straight into the mapped (or
+// caller-owned) bytes; otherwise the columns are decoded into owned storage.
+// Zero-copy views stay valid as long as this object lives.
+class BinaryFigureFile {
+public:
+    explicit BinaryFigureFile(const std::string& path)
+        : mapping(std::make_unique<MappedFile>(path)) {
+        parse(reinterpret_cast<const unsigned char*>(mapping->data()), mapping->size(), false);
+    }
+
+    // Reads caller-owned bytes, which must outlive this object unless forceCopy is set.
+    explicit BinaryFigureFile(std::span<const unsigned char> bytes, bool forceCopy = false) {
+        parse(bytes.data(), bytes.size(), forceCopy);
+    }
+
+    size_t size() const {
+        return order.size();
+    }
+
+    size_t count(FigureKind kind) const {
+        return sections[size_t(kind)].count;
+    }
+
+    FigureKind kindAt(size_t index) const {
+        if (index >= order.size())
+            throw std::out_of_range("Index out of range");
+        return static_cast<FigureKind>(order[index]);
+    }
+
+    std::span<const double> xs(FigureKind kind) const {
+        return sections[size_t(kind)].xs;
+    }
+
+    std::span<const double> ys(FigureKind kind) const {
+        return sections[size_t(kind)].ys;
+    }
+
+    bool zeroCopy() const {
+        return mapped;
+    }
+
+    template <Scalar T>
+    Array<std::shared_ptr<Figure<T>>> figures() const {
+        Array<std::shared_ptr<Figure<T>>> result;
+        std::array<size_t, BinaryFormat::kinds> next{};
+
+        for (uint8_t kind : order)
+            result.add(figureAt<T>(kind, next[kind]++));
+        return result;
+    }
+
+    // Builds the figures one at a time as the caller consumes them; the file
+    // object must outlive the generator.
+    template <Scalar T>
+    Generator<std::shared_ptr<Figure<T>>> stream() const {
+        std::array<size_t, BinaryFormat::kinds> next{};
+        for (uint8_t kind : order)
+            co_yield figureAt<T>(kind, next[kind]++);
+    }
+
+private:
+    struct Section {
+        size_t count = 0;
+        std::span<const double> xs, ys;
+        std::vector<double> ownedXs, ownedYs;
+    };
+
+    template <Scalar T>
+    std::shared_ptr<Figure<T>> figureAt(uint8_t kind, size_t figure) const {
+        const Section& s = sections[kind];
+        size_t n = BinaryFormat::vertexCounts[kind];
+        std::array<Point<T>, BinaryFormat::maxVertices> points;
+        for (size_t v = 0; v < n; ++v)
+            points[v] = Point<T>(static_cast<T>(s.xs[figure * n + v]), static_cast<T>(s.ys[figure * n + v]));
+        return BinaryFormat::makeFigure<T>(static_cast<FigureKind>(kind), std::span<const Point<T>>(points.data(), n));
+    }
+
+    void parse(const unsigned char* data, size_t size, bool forceCopy) {
+        using F = BinaryFormat;
+        if (size < F::headerSize || std::memcmp(data, F::magic, 4) != 0)
+            throw std::runtime_error("Not a binary figure file");
+        uint16_t fileVersion = F::loadLE16(data + 4);
+        if (fileVersion != F::version && fileVersion != 1)
+            throw std::runtime_error("Unsupported binary figure file version");
+        if (F::loadLE16(data + 6) != F::headerSize || F::loadLE(data + 64) != F::headerSize)
+            throw std::runtime_error("Corrupted binary figure file header");
+
+        uint64_t n = F::loadLE(data + 8);
+        if (n > size - F::headerSize)
+            throw std::runtime_error("Truncated binary figure file");
+        if (F::fileChecksum(data, size, fileVersion) != F::loadLE(data + 72))
+            throw std::runtime_error("Binary figure file checksum mismatch");
+
+        order.assign(data + F::headerSize, data + F::headerSize + n);
+        std::array<size_t, F::kinds> seen{};
+        for (uint8_t kind : order) {
+            if (kind >= F::kinds)
+                throw std::runtime_error("Unknown figure type in binary figure file");
+            ++seen[kind];
+        }
+
+        bool canMap = !forceCopy && std::endian::native == std::endian::little;
+        mapped = canMap;
+
+        for (size_t k = 0; k < F::kinds; ++k) {
+            Section& s = sections[k];
+            s.count = F::loadLE(data + 16 + 8 * k);
+            uint64_t offset = F::loadLE(data + 40 + 8 * k);
+            size_t values = s.count * F::vertexCounts[k];
+
+            if (s.count != seen[k] || offset > size || 2 * values * sizeof(double) > size - offset)
+                throw std::runtime_error("Corrupted binary figure file sections");
+
+            const unsigned char* column = data + offset;
+            if (canMap && reinterpret_cast<uintptr_t>(column) % alignof(double) == 0) {
+                s.xs = std::span<const double>(reinterpret_cast<const double*>(column), values);
+                s.ys = std::span<const double>(reinterpret_cast<const double*>(column) + values, values);
+            } else {
+                mapped = false;
+                s.ownedXs.resize(values);
+                s.ownedYs.resize(values);
+                for (size_t i = 0; i < values; ++i) {
+                    s.ownedXs[i] = std::bit_cast<double>(F::loadLE(column + 8 * i));
+                    s.ownedYs[i] = std::bit_cast<double>(F::loadLE(column + 8 * (values + i)));
+                }
+                s.xs = s.ownedXs;
+                s.ys = s.ownedYs;
+            }
+        }
+    }
+
+    std::unique_ptr<MappedFile> mapping;
+    std::vector<uint8_t> order;
+    std::array<Section, BinaryFormat::kinds> sections;
+    bool mapped = false;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "point.h"
+
+#include <algorithm>
+#include <limits>
+
+template <Scalar T>
+class Box {
+public:
+    T minX, minY, maxX, maxY;
+
+    Box()
+        : minX(std::numeric_limits<T>::max()), minY(std::numeric_limits<T>::max()),
+          maxX(std::numeric_limits<T>::lowest()), maxY(std::numeric_limits<T>::lowest()) {}
+
+    Box(T minX, T minY, T maxX, T maxY)
+        : minX(minX), minY(minY), maxX(maxX), maxY(maxY) {}
+
+    bool empty() const {
+        return minX > maxX || minY > maxY;
+    }
+
+    void expand(const Point<T>& p) {
+        minX = std::min(minX, p.x());
+        minY = std::min(minY, p.y());
+        maxX = std::max(maxX, p.x());
+        maxY = std::max(maxY, p.y());
+    }
+
+    void expand(const Box& other) {
+        minX = std::min(minX, other.minX);
+        minY = std::min(minY, other.minY);
+        maxX = std::max(maxX, other.maxX);
+        maxY = std::max(maxY, other.maxY);
+    }
+
+    bool intersects(const Box& other) const {
+        return minX <= other.maxX && other.minX <= maxX &&
+               minY <= other.maxY && other.minY <= maxY;
+    }
+
+    bool contains(const Point<T>& p) const {
+        return minX <= p.x() && p.x() <= maxX && minY <= p.y() && p.y() <= maxY;
+    }
+
+    Point<T> center() const {
+        return Point<T>((minX + maxX) / 2, (minY + maxY) / 2);
+    }
+
+    // Squared distance from p to the nearest point of the box (0 if inside).
+    double distance2(const Point<T>& p) const {
+        double dx = std::max({double(minX) - p.x(), 0.0, double(p.x()) - maxX});
+        double dy = std::max({double(minY) - p.y(), 0.0, double(p.y()) - maxY});
+        return dx * dx + dy * dy;
+    }
+
+    bool operator==(const Box& other) const = default;
+};
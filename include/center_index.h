@@ -0,0 +1,175 @@
+#pragma once
+
+#include "array.h"
+#include "scheduler.h"
+
+#include <algorithm>
+#include <limits>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// k-d tree over figure centers. Ids are positions in the source Array (or the
+// order of add() calls). Points added after construction go to a pending list
+// that is scanned linearly until it outgrows rebuildRatio of the tree.
+template <Scalar T>
+class CenterIndex {
+public:
+    static constexpr double rebuildRatio = 0.25;
+    static constexpr size_t minRebuildSize = 64;
+
+    CenterIndex() = default;
+
+    template <FigureContainer C>
+    explicit CenterIndex(const C& figures) {
+        nodes.reserve(figures.getSize());
+        for (int i = 0; i < figures.getSize(); ++i)
+            nodes.push_back(Node{asFigure(figures[i]).center(), static_cast<size_t>(i)});
+        build(0, nodes.size(), 0);
+    }
+
+    size_t size() const {
+        return nodes.size() + pending.size();
+    }
+
+    size_t add(const Point<T>& center) {
+        size_t id = size();
+        pending.push_back(Node{center, id});
+
+        if (pending.size() >= minRebuildSize && pending.size() > rebuildRatio * nodes.size())
+            rebuild();
+        return id;
+    }
+
+    size_t add(const Figure<T>& figure) {
+        return add(figure.center());
+    }
+
+    void rebuild() {
+        nodes.insert(nodes.end(), pending.begin(), pending.end());
+        pending.clear();
+        build(0, nodes.size(), 0);
+    }
+
+    size_t nearest(const Point<T>& p) const {
+        if (!size())
+            throw std::out_of_range("Index is empty");
+        return nearest(p, 1).front();
+    }
+
+    // Ids of the k nearest centers, nearest first.
+    std::vector<size_t> nearest(const Point<T>& p, size_t k) const {
+        Heap heap;
+        if (k) {
+            search(p, k, 0, nodes.size(), 0, heap);
+            for (const auto& node : pending)
+                offer(heap, k, distance2(node.center, p), node.id);
+        }
+
+        std::vector<size_t> result(heap.size());
+        for (size_t i = result.size(); i-- > 0; heap.pop())
+            result[i] = heap.top().second;
+        return result;
+    }
+
+    std::vector<size_t> nearestBatch(const std::vector<Point<T>>& queries,
+                                     size_t threads = std::thread::hardware_concurrency()) const {
+        std::vector<size_t> result(queries.size());
+        if (!size())
+            throw std::out_of_range("Index is empty");
+
+        forChunks(queries.size(), threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                result[i] = nearest(queries[i], 1).front();
+        });
+        return result;
+    }
+
+    std::vector<std::vector<size_t>> kNearestBatch(const std::vector<Point<T>>& queries, size_t k,
+                                                   size_t threads = std::thread::hardware_concurrency()) const {
+        std::vector<std::vector<size_t>> result(queries.size());
+        forChunks(queries.size(), threads, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                result[i] = nearest(queries[i], k);
+        });
+        return result;
+    }
+
+private:
+    struct Node {
+        Point<T> center;
+        size_t id;
+    };
+
+    using Heap = std::priority_queue<std::pair<double, size_t>>;
+
+    static double distance2(const Point<T>& a, const Point<T>& b) {
+        double dx = double(a.x()) - b.x();
+        double dy = double(a.y()) - b.y();
+        return dx * dx + dy * dy;
+    }
+
+    static T coordinate(const Point<T>& p, size_t axis) {
+        return axis ? p.y() : p.x();
+    }
+
+    static void offer(Heap& heap, size_t k, double d2, size_t id) {
+        if (heap.size() < k) {
+            heap.emplace(d2, id);
+        } else if (d2 < heap.top().first) {
+            heap.pop();
+            heap.emplace(d2, id);
+        }
+    }
+
+    // Implicit balanced layout: the median of [begin, end) is the node, the
+    // halves on either side are its subtrees.
+    void build(size_t begin, size_t end, size_t axis) {
+        if (end - begin <= 1)
+            return;
+
+        size_t mid = begin + (end - begin) / 2;
+        std::nth_element(nodes.begin() + begin, nodes.begin() + mid, nodes.begin() + end,
+                         [axis](const Node& a, const Node& b) {
+                             return coordinate(a.center, axis) < coordinate(b.center, axis);
+                         });
+
+        build(begin, mid, axis ^ 1);
+        build(mid + 1, end, axis ^ 1);
+    }
+
+    void search(const Point<T>& p, size_t k, size_t begin, size_t end, size_t axis, Heap& heap) const {
+        if (begin >= end)
+            return;
+
+        size_t mid = begin + (end - begin) / 2;
+        const Node& node = nodes[mid];
+        offer(heap, k, distance2(node.center, p), node.id);
+
+        double delta = double(coordinate(p, axis)) - coordinate(node.center, axis);
+        bool left = delta < 0;
+
+        if (left)
+            search(p, k, begin, mid, axis ^ 1, heap);
+        else
+            search(p, k, mid + 1, end, axis ^ 1, heap);
+
+        if (heap.size() < k || delta * delta < heap.top().first) {
+            if (left)
+                search(p, k, mid + 1, end, axis ^ 1, heap);
+            else
+                search(p, k, begin, mid, axis ^ 1, heap);
+        }
+    }
+
+    template <typename F>
+    static void forChunks(size_t count, size_t threads, F&& work) {
+        threads = std::clamp<size_t>(threads, 1, std::max<size_t>(count / 256, 1));
+        TaskScheduler::global().forEachChunk(count, threads, [&](size_t begin, size_t end, size_t) {
+            work(begin, end);
+        });
+    }
+
+    std::vector<Node> nodes;
+    std::vector<Node> pending;
+};
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "polygons.h"
+#include "scheduler.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+// Overlapping pairs packed as (first, second) index pairs with first < second.
+class OverlapPairs {
+public:
+    size_t size() const {
+        return data.size() / 2;
+    }
+
+    std::pair<uint32_t, uint32_t> operator[](size_t index) const {
+        if (index >= size())
+            throw std::out_of_range("Index out of range");
+        return {data[2 * index], data[2 * index + 1]};
+    }
+
+    void add(uint32_t a, uint32_t b) {
+        data.push_back(std::min(a, b));
+        data.push_back(std::max(a, b));
+    }
+
+    void append(const OverlapPairs& other) {
+        data.insert(data.end(), other.data.begin(), other.data.end());
+    }
+
+    const std::vector<uint32_t>& raw() const {
+        return data;
+    }
+
+private:
+    std::vector<uint32_t> data;
+};
+
+inline void projectPolygon(std::span<const double> xs, std::span<const double> ys,
+                           double nx, double ny, double& lo, double& hi) {
+    lo = hi = xs[0] * nx + ys[0] * ny;
+    for (size_t i = 1; i < xs.size(); ++i) {
+        double d = xs[i] * nx + ys[i] * ny;
+        lo = std::min(lo, d);
+        hi = std::max(hi, d);
+    }
+}
+
+// True if one of a's edge normals separates a from b.
+inline bool separatedByEdgesOf(const Polygons& polys, size_t a, size_t b) {
+    auto ax = polys.xsOf(a), ay = polys.ysOf(a);
+    auto bx = polys.xsOf(b), by = polys.ysOf(b);
+
+    for (size_t i = 0; i < ax.size(); ++i) {
+        size_t j = (i + 1) % ax.size();
+        double nx = -(ay[j] - ay[i]);
+        double ny = ax[j] - ax[i];
+
+        double aLo, aHi, bLo, bHi;
+        projectPolygon(ax, ay, nx, ny, aLo, aHi);
+        projectPolygon(bx, by, nx, ny, bLo, bHi);
+        if (aHi < bLo || bHi < aLo)
+            return true;
+    }
+    return false;
+}
+
+// Separating axis test for two convex polygons; touching counts as overlap.
+inline bool overlaps(const Polygons& polys, size_t a, size_t b) {
+    return polys.bounds(a).intersects(polys.bounds(b)) &&
+           !separatedByEdgesOf(polys, a, b) && !separatedByEdgesOf(polys, b, a);
+}
+
+// Sweep-and-prune over boxes sorted by minX; each thread sweeps a slice of the
+// sorted order against everything to its right and the buffers are joined in order.
+inline OverlapPairs findOverlaps(const Polygons& polys,
+                                 size_t threads = std::thread::hardware_concurrency()) {
+    std::vector<uint32_t> order(polys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](uint32_t a, uint32_t b) {
+        return polys.bounds(a).minX < polys.bounds(b).minX;
+    });
+
+    auto sweep = [&](size_t begin, size_t end, OverlapPairs& out) {
+        for (size_t i = begin; i < end; ++i) {
+            const Box<double>& box = polys.bounds(order[i]);
+            for (size_t j = i + 1; j < order.size(); ++j) {
+                const Box<double>& other = polys.bounds(order[j]);
+                if (other.minX > box.maxX)
+                    break;
+                if (other.minY > box.maxY || box.minY > other.maxY)
+                    continue;
+                if (!separatedByEdgesOf(polys, order[i], order[j]) &&
+                    !separatedByEdgesOf(polys, order[j], order[i]))
+                    out.add(order[i], order[j]);
+            }
+        }
+    };
+
+    size_t count = order.size();
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(count / 1024, 1));
+
+    std::vector<OverlapPairs> parts(threads);
+    TaskScheduler::global().forEachChunk(count, threads, [&](size_t begin, size_t end, size_t part) {
+        sweep(begin, end, parts[part]);
+    });
+
+    OverlapPairs result = std::move(parts[0]);
+    for (size_t t = 1; t < parts.size(); ++t)
+        result.append(parts[t]);
+    return result;
+}
+
+template <FigureContainer C>
+OverlapPairs findOverlaps(const C& figures,
+                          size_t threads = std::thread::hardware_concurrency()) {
+    return findOverlaps(Polygons(figures), threads);
+}
+
@@ -0,0 +1,313 @@
+#pragma once
+
+#include "binary_format.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Decoded figures of one block, stored column-wise: figure i has vertices
+// offsets[i] .. offsets[i + 1] - 1 in xs/ys.
+struct ColumnBlock {
+    std::vector<FigureKind> kinds;
+    std::vector<uint32_t> offsets;
+    std::vector<double> xs, ys;
+
+    size_t size() const {
+        return kinds.size();
+    }
+
+    void clear() {
+        kinds.clear();
+        offsets.assign(1, 0);
+        xs.clear();
+        ys.clear();
+    }
+};
+
+// Compressed cold storage for figure collections.
+//
+// Coordinates are quantized to integer multiples of precision, so a decoded
+// coordinate differs from the original by at most precision / 2 plus
+// |x| * 2^-51 for the rounding of the scaling itself. Encoding throws
+// std::invalid_argument when |x| / precision does not fit in 2^52.
+//
+// Figures are grouped in blocks of blockSize. Inside a block the first vertex
+// of a figure is a delta from the first vertex of the previous figure and the
+// other vertices are deltas from the previous vertex of the same figure; the
+// deltas are zigzag varints, so figures on a modest grid take one or two bytes
+// per coordinate. A block starts with the kind bytes of its figures and is
+// decoded independently of the others.
+class CompressedFigures {
+public:
+    static constexpr char magic[4] = {'F', 'I', 'G', 'Z'};
+    static constexpr uint16_t version = 1;
+    static constexpr size_t defaultBlockSize = 256;
+
+    CompressedFigures() = default;
+
+    template <typename E>
+    static CompressedFigures encode(const Array<E>& figures, double precision, size_t blockSize = defaultBlockSize) {
+        if (!(precision > 0) || !std::isfinite(precision))
+            throw std::invalid_argument("Precision must be positive");
+        if (!blockSize)
+            throw std::invalid_argument("Block size must be positive");
+
+        CompressedFigures result;
+        result.step = precision;
+        result.blockSize = blockSize;
+        result.count = figures.getSize();
+
+        for (size_t first = 0; first < result.count; first += blockSize) {
+            size_t last = std::min(first + blockSize, result.count);
+            result.blocks.push_back(result.stream.size());
+
+            for (size_t i = first; i < last; ++i)
+                result.stream.push_back(static_cast<unsigned char>(BinaryFormat::kindOf(asFigure(figures[i]))));
+
+            int64_t baseX = 0, baseY = 0;
+            for (size_t i = first; i < last; ++i) {
+                const auto& fig = asFigure(figures[i]);
+                int64_t prevX = baseX, prevY = baseY;
+
+                for (size_t v = 0; v < fig.vertexCount(); ++v) {
+                    auto p = fig.vertex(v);
+                    int64_t qx = result.quantize(static_cast<double>(p.x()));
+                    int64_t qy = result.quantize(static_cast<double>(p.y()));
+                    result.putVarint(zigzag(qx - prevX));
+                    result.putVarint(zigzag(qy - prevY));
+                    prevX = qx;
+                    prevY = qy;
+                    if (v == 0) {
+                        baseX = qx;
+                        baseY = qy;
+                    }
+                }
+            }
+        }
+        result.blocks.push_back(result.stream.size());
+        return result;
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    size_t blockCount() const {
+        return blocks.empty() ? 0 : blocks.size() - 1;
+    }
+
+    double precision() const {
+        return step;
+    }
+
+    // Largest difference between an original and a decoded coordinate of magnitude up to |x|.
+    double errorBound(double magnitude = 0) const {
+        return step / 2 + std::abs(magnitude) * 0x1p-51;
+    }
+
+    size_t compressedSize() const {
+        return stream.size();
+    }
+
+    void decodeBlock(size_t block, ColumnBlock& out) const {
+        if (block >= blockCount())
+            throw std::out_of_range("Block index out of range");
+
+        size_t first = block * blockSize;
+        size_t n = std::min(blockSize, count - first);
+        const unsigned char* p = stream.data() + blocks[block];
+        const unsigned char* end = stream.data() + blocks[block + 1];
+        if (static_cast<size_t>(end - p) < n)
+            throw std::runtime_error("Corrupted compressed figures");
+
+        out.clear();
+        out.kinds.resize(n);
+        size_t vertices = 0;
+        for (size_t i = 0; i < n; ++i) {
+            if (p[i] >= BinaryFormat::kinds)
+                throw std::runtime_error("Corrupted compressed figures");
+            out.kinds[i] = static_cast<FigureKind>(p[i]);
+            vertices += BinaryFormat::vertexCounts[p[i]];
+            out.offsets.push_back(static_cast<uint32_t>(vertices));
+        }
+        p += n;
+
+        out.xs.resize(vertices);
+        out.ys.resize(vertices);
+        int64_t baseX = 0, baseY = 0;
+        size_t at = 0;
+        for (size_t i = 0; i < n; ++i) {
+            int64_t x = baseX, y = baseY;
+            for (size_t v = out.offsets[i]; v < out.offsets[i + 1]; ++v) {
+                x += unzigzag(getVarint(p, end));
+                y += unzigzag(getVarint(p, end));
+                out.xs[at] = static_cast<double>(x) * step;
+                out.ys[at] = static_cast<double>(y) * step;
+                ++at;
+                if (v == out.offsets[i]) {
+                    baseX = x;
+                    baseY = y;
+                }
+            }
+        }
+        if (p != end)
+            throw std::runtime_error("Corrupted compressed figures");
+    }
+
+    template <Scalar T>
+    Array<std::shared_ptr<Figure<T>>> figures() const {
+        Array<std::shared_ptr<Figure<T>>> result;
+        ColumnBlock block;
+        std::array<Point<T>, 8> points;
+
+        for (size_t b = 0; b < blockCount(); ++b) {
+            decodeBlock(b, block);
+            for (size_t i = 0; i < block.size(); ++i) {
+                size_t n = block.offsets[i + 1] - block.offsets[i];
+                for (size_t v = 0; v < n; ++v)
+                    points[v] = Point<T>(static_cast<T>(block.xs[block.offsets[i] + v]),
+                                         static_cast<T>(block.ys[block.offsets[i] + v]));
+                result.add(BinaryFormat::makeFigure<T>(block.kinds[i], std::span(points.data(), n)));
+            }
+        }
+        return result;
+    }
+
+    // Sum of the shoelace areas of the decoded figures, one block at a time.
+    double totalArea() const {
+        ColumnBlock block;
+        double total = 0;
+
+        for (size_t b = 0; b < blockCount(); ++b) {
+            decodeBlock(b, block);
+            for (size_t i = 0; i < block.size(); ++i) {
+                size_t begin = block.offsets[i], end = block.offsets[i + 1];
+                double twice = 0;
+                for (size_t v = begin; v < end; ++v) {
+                    size_t next = (v + 1 == end) ? begin : v + 1;
+                    twice += block.xs[v] * block.ys[next] - block.xs[next] * block.ys[v];
+                }
+                total += twice / 2;
+            }
+        }
+        return total;
+    }
+
+    // Layout: magic "FIGZ", u16 version, 2 reserved bytes, f64 precision, block
+    // size, figure count, block count, block offsets (count + 1), stream size,
+    // stream, checksum of the stream; all little-endian.
+    std::vector<unsigned char> serialize() const {
+        std::vector<unsigned char> out(8);
+        std::memcpy(out.data(), magic, 4);
+        out[4] = version & 0xFF;
+        out[5] = version >> 8;
+
+        auto put = [&out](uint64_t value) {
+            out.resize(out.size() + 8);
+            BinaryFormat::storeLE(&out[out.size() - 8], value);
+        };
+        put(std::bit_cast<uint64_t>(step));
+        put(blockSize);
+        put(count);
+        put(blockCount());
+        for (size_t offset : blocks)
+            put(offset);
+        put(stream.size());
+        out.insert(out.end(), stream.begin(), stream.end());
+        put(BinaryFormat::checksum(stream.data(), stream.size()));
+        return out;
+    }
+
+    static CompressedFigures deserialize(std::span<const unsigned char> bytes) {
+        const unsigned char* p = bytes.data();
+        size_t left = bytes.size();
+        auto get = [&]() {
+            if (left < 8)
+                throw std::runtime_error("Truncated compressed figures");
+            uint64_t value = BinaryFormat::loadLE(p);
+            p += 8;
+            left -= 8;
+            return value;
+        };
+
+        if (left < 8 || std::memcmp(p, magic, 4) != 0)
+            throw std::runtime_error("Not a compressed figure file");
+        if (BinaryFormat::loadLE16(p + 4) != version)
+            throw std::runtime_error("Unsupported compressed figure file version");
+        p += 8;
+        left -= 8;
+
+        CompressedFigures result;
+        result.step = std::bit_cast<double>(get());
+        result.blockSize = get();
+        result.count = get();
+        uint64_t blocks = get();
+        if (!(result.step > 0) || !result.blockSize || blocks > left / 8 ||
+            blocks != (result.count + result.blockSize - 1) / result.blockSize)
+            throw std::runtime_error("Corrupted compressed figures");
+
+        result.blocks.resize(blocks + 1);
+        for (auto& offset : result.blocks)
+            offset = get();
+        uint64_t streamSize = get();
+        if (streamSize > left || left - streamSize != 8)
+            throw std::runtime_error("Truncated compressed figures");
+        result.stream.assign(p, p + streamSize);
+        p += streamSize;
+        left -= streamSize;
+
+        if (get() != BinaryFormat::checksum(result.stream.data(), result.stream.size()))
+            throw std::runtime_error("Compressed figures checksum mismatch");
+        if (result.blocks.front() != 0 || result.blocks.back() != streamSize ||
+            !std::is_sorted(result.blocks.begin(), result.blocks.end()))
+            throw std::runtime_error("Corrupted compressed figures");
+        return result;
+    }
+
+private:
+    int64_t quantize(double value) const {
+        double scaled = std::nearbyint(value / step);
+        if (!(std::abs(scaled) <= 0x1p52))
+            throw std::invalid_argument("Coordinate out of range for the precision");
+        return static_cast<int64_t>(scaled);
+    }
+
+    static uint64_t zigzag(int64_t value) {
+        return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+    }
+
+    static int64_t unzigzag(uint64_t value) {
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    void putVarint(uint64_t value) {
+        while (value >= 0x80) {
+            stream.push_back(static_cast<unsigned char>(value | 0x80));
+            value >>= 7;
+        }
+        stream.push_back(static_cast<unsigned char>(value));
+    }
+
+    static uint64_t getVarint(const unsigned char*& p, const unsigned char* end) {
+        uint64_t value = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            unsigned char byte = *p++;
+            value |= uint64_t(byte & 0x7F) << shift;
+            if (!(byte & 0x80))
+                return value;
+        }
+        throw std::runtime_error("Corrupted compressed figures");
+    }
+
+    double step = 1;
+    size_t blockSize = defaultBlockSize;
+    size_t count = 0;
+    std::vector<size_t> blocks;
+    std::vector<unsigned char> stream;
+};
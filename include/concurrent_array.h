@@ -0,0 +1,269 @@
+#pragma once
+
+#include "array.h"
+#include "segments.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Append-only container that many threads can fill at once.
+//
+// Writers reserve a range of slots with one fetch_add, construct their
+// elements in place and mark the slots ready; whichever writer finds the
+// slots after the published prefix ready moves the prefix forward, so nobody
+// waits for a slower writer and readers always see a gap-free prefix of
+// getSize() fully constructed elements. Storage is a list of doubling
+// segments that are never reallocated, so element addresses stay valid while
+// it grows. Appender batches elements per thread to make the shared counters
+// cheap.
+template <typename T>
+class ConcurrentArray {
+    using Segments = GeometricSegments<6>;
+
+    static_assert(std::is_nothrow_move_constructible_v<T>,
+                  "Elements are moved into reserved slots, where a throw would leave a gap");
+
+public:
+    class Appender {
+    public:
+        Appender(ConcurrentArray& target, size_t batchSize) : target(target), batchSize(batchSize) {
+            buffer.reserve(batchSize);
+        }
+
+        ~Appender() {
+            flush();
+        }
+
+        Appender(const Appender&) = delete;
+        Appender& operator=(const Appender&) = delete;
+
+        template <typename U>
+        void add(U&& fig) {
+            buffer.push_back(std::forward<U>(fig));
+            if (buffer.size() >= batchSize)
+                flush();
+        }
+
+        void flush() {
+            if (!buffer.empty()) {
+                target.append(buffer);
+                buffer.clear();
+            }
+        }
+
+    private:
+        ConcurrentArray& target;
+        size_t batchSize;
+        std::vector<T> buffer;
+    };
+
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        Iterator() = default;
+        Iterator(const ConcurrentArray* owner, size_t index) : owner(owner), index(index) {}
+
+        reference operator*() const {
+            return owner->slot(index);
+        }
+
+        pointer operator->() const {
+            return &owner->slot(index);
+        }
+
+        Iterator& operator++() {
+            ++index;
+            return *this;
+        }
+
+        Iterator operator++(int) {
+            Iterator old = *this;
+            ++index;
+            return old;
+        }
+
+        bool operator==(const Iterator& other) const {
+            return index == other.index;
+        }
+
+    private:
+        const ConcurrentArray* owner = nullptr;
+        size_t index = 0;
+    };
+
+    // Consistent view of the elements published when it was taken.
+    class View {
+    public:
+        View(const ConcurrentArray* owner, size_t size) : owner(owner), count(size) {}
+
+        Iterator begin() const {
+            return Iterator(owner, 0);
+        }
+
+        Iterator end() const {
+            return Iterator(owner, count);
+        }
+
+        size_t size() const {
+            return count;
+        }
+
+    private:
+        const ConcurrentArray* owner;
+        size_t count;
+    };
+
+    ConcurrentArray() = default;
+
+    ~ConcurrentArray() {
+        size_t n = std::min(published.load(std::memory_order_acquire), Segments::maxSize);
+        for (size_t i = 0; i < n; ++i)
+            std::destroy_at(cell(i)->value());
+        for (size_t s = 0; s < Segments::maxSegments; ++s)
+            delete[] segments[s].load(std::memory_order_relaxed);
+    }
+
+    ConcurrentArray(const ConcurrentArray&) = delete;
+    ConcurrentArray& operator=(const ConcurrentArray&) = delete;
+
+    // Returns the index of the new element. The element is built before a
+    // slot is reserved, so a constructor that throws leaves no gap.
+    template <typename U>
+    size_t add(U&& fig) {
+        T value(std::forward<U>(fig));
+        size_t index = reserve(1);
+        Cell& cell = *this->cell(index);
+        std::construct_at(cell.value(), std::move(value));
+        cell.ready.store(true);
+        advance();
+        return index;
+    }
+
+    // Moves the whole batch into consecutive slots.
+    void append(std::vector<T>& batch) {
+        size_t start = reserve(batch.size());
+        for (size_t i = 0; i < batch.size(); ++i) {
+            Cell& cell = *this->cell(start + i);
+            std::construct_at(cell.value(), std::move(batch[i]));
+            cell.ready.store(true);
+        }
+        advance();
+    }
+
+    Appender appender(size_t batchSize = 256) {
+        return Appender(*this, batchSize);
+    }
+
+    int getSize() const {
+        return static_cast<int>(published.load(std::memory_order_acquire));
+    }
+
+    const T& operator[](size_t index) const {
+        if (index >= published.load(std::memory_order_acquire))
+            throw std::out_of_range("Index out of range");
+        return slot(index);
+    }
+
+    View view() const {
+        return View(this, published.load(std::memory_order_acquire));
+    }
+
+    void printAll() const {
+        TextWriter out(std::cout);
+        printAll(out);
+    }
+
+    void printAll(TextWriter& out) const {
+        printFigures(view(), out);
+    }
+
+    void printCenters() const {
+        TextWriter out(std::cout);
+        printCenters(out);
+    }
+
+    void printCenters(TextWriter& out) const {
+        printFigureCenters(view(), out);
+    }
+
+    void printTotalArea() const {
+        TextWriter out(std::cout);
+        printTotalArea(out);
+    }
+
+    void printTotalArea(TextWriter& out) const {
+        printFiguresTotalArea(view(), out);
+    }
+
+private:
+    struct Cell {
+        alignas(T) unsigned char storage[sizeof(T)];
+        std::atomic<bool> ready{false};
+
+        T* value() {
+            return reinterpret_cast<T*>(storage);
+        }
+    };
+
+    Cell* cell(size_t index) const {
+        Cell* segment = segments[Segments::segmentOf(index)].load(std::memory_order_acquire);
+        return segment ? &segment[Segments::offsetOf(index)] : nullptr;
+    }
+
+    const T& slot(size_t index) const {
+        return *cell(index)->value();
+    }
+
+    // Claims n consecutive slots. Everything that can fail (the size limit,
+    // allocating segments) happens before the claim: a reserved slot that is
+    // never filled would stop advance() for good.
+    size_t reserve(size_t n) {
+        size_t start = reserved.load(std::memory_order_relaxed);
+        do {
+            if (n > Segments::maxSize - start)
+                throw std::length_error("ConcurrentArray is full");
+            if (n)
+                for (size_t s = Segments::segmentOf(start); s <= Segments::segmentOf(start + n - 1); ++s)
+                    allocate(s);
+        } while (!reserved.compare_exchange_weak(start, start + n, std::memory_order_relaxed));
+        return start;
+    }
+
+    // Allocates segment s on first use.
+    void allocate(size_t s) {
+        if (segments[s].load(std::memory_order_acquire))
+            return;
+        Cell* expected = nullptr;
+        Cell* fresh = new Cell[Segments::capacity(s)];
+        if (!segments[s].compare_exchange_strong(expected, fresh, std::memory_order_acq_rel))
+            delete[] fresh;
+    }
+
+    // Moves the published prefix over every ready slot that follows it.
+    void advance() {
+        size_t from = published.load();
+        while (true) {
+            size_t to = from;
+            size_t limit = reserved.load();
+            for (Cell* c; to < limit && (c = cell(to)) && c->ready.load(); ++to) {
+            }
+            if (to == from || published.compare_exchange_strong(from, to))
+                return;
+        }
+    }
+
+    std::array<std::atomic<Cell*>, Segments::maxSegments> segments{};
+    alignas(64) std::atomic<size_t> reserved{0};
+    alignas(64) std::atomic<size_t> published{0};
+};
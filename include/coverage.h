@@ -0,0 +1,246 @@
+#pragma once
+
+#include "collision.h"
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+// Area covered by the union of a figure collection, without double-counting
+// overlaps. The plane is cut into vertical slabs at every vertex x and every
+// x where edges of two overlapping figures cross; inside such a slab each
+// figure's cross-section is a trapezoid and the union length is linear in x,
+// so slab area = width * union length at the slab's middle. Slabs are grouped
+// into strips that run on separate threads.
+
+struct CoverageEstimate {
+    double area;
+    double errorBound;
+};
+
+// y-range of the convex polygon on the vertical line at x; false if it misses.
+inline bool crossSection(const Polygons& polys, size_t p, double x, double& lo, double& hi) {
+    auto xs = polys.xsOf(p), ys = polys.ysOf(p);
+    lo = std::numeric_limits<double>::infinity();
+    hi = -lo;
+
+    for (size_t i = 0; i < xs.size(); ++i) {
+        size_t j = (i + 1) % xs.size();
+        double x0 = xs[i], x1 = xs[j];
+        if (x < std::min(x0, x1) || x > std::max(x0, x1))
+            continue;
+
+        if (x0 == x1) {
+            lo = std::min({lo, ys[i], ys[j]});
+            hi = std::max({hi, ys[i], ys[j]});
+        } else {
+            double y = ys[i] + (x - x0) * (ys[j] - ys[i]) / (x1 - x0);
+            lo = std::min(lo, y);
+            hi = std::max(hi, y);
+        }
+    }
+    return lo <= hi;
+}
+
+// Total length of a set of [lo, hi] intervals; sorts them in place.
+inline double unionLength(std::vector<std::pair<double, double>>& intervals) {
+    std::sort(intervals.begin(), intervals.end());
+
+    double total = 0.0;
+    double curLo = -std::numeric_limits<double>::infinity(), curHi = curLo;
+    for (const auto& [lo, hi] : intervals) {
+        if (lo > curHi) {
+            if (curHi > curLo)
+                total += curHi - curLo;
+            curLo = lo;
+            curHi = hi;
+        } else {
+            curHi = std::max(curHi, hi);
+        }
+    }
+    if (curHi > curLo)
+        total += curHi - curLo;
+    return total;
+}
+
+// Runs work(stripBegin, stripEnd) over [0, count) split across threads and
+// returns the sum of the partial results.
+template <typename F>
+double sumOverStrips(size_t count, size_t threads, F&& work) {
+    threads = std::clamp<size_t>(threads, 1, std::max<size_t>(count / 256, 1));
+    std::vector<double> partial(threads, 0.0);
+    TaskScheduler::global().forEachChunk(count, threads, [&](size_t begin, size_t end, size_t part) {
+        partial[part] = work(begin, end);
+    });
+
+    double total = 0.0;
+    for (double v : partial)
+        total += v;
+    return total;
+}
+
+// Sweeps the slabs [cuts[begin], cuts[end]] keeping the figures whose x-range
+// spans the current slab, and hands each slab with its active set to visit.
+template <typename F>
+void sweepSlabs(const Polygons& polys, const std::vector<size_t>& byMinX,
+                const std::vector<double>& cuts, size_t begin, size_t end, F&& visit) {
+    std::vector<size_t> active;
+    size_t next = 0;
+
+    for (size_t s = begin; s < end; ++s) {
+        double x0 = cuts[s], x1 = cuts[s + 1];
+
+        while (next < byMinX.size() && polys.bounds(byMinX[next]).minX < x1) {
+            if (polys.bounds(byMinX[next]).maxX > x0)
+                active.push_back(byMinX[next]);
+            ++next;
+        }
+        std::erase_if(active, [&](size_t p) { return polys.bounds(p).maxX <= x0; });
+
+        visit(x0, x1, active);
+    }
+}
+
+inline std::vector<size_t> sortedByMinX(const Polygons& polys) {
+    std::vector<size_t> order(polys.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return polys.bounds(a).minX < polys.bounds(b).minX;
+    });
+    return order;
+}
+
+inline double coveredArea(const Polygons& polys, size_t threads = std::thread::hardware_concurrency()) {
+    if (!polys.size())
+        return 0.0;
+
+    std::vector<double> cuts;
+    for (size_t p = 0; p < polys.size(); ++p)
+        for (double x : polys.xsOf(p))
+            cuts.push_back(x);
+
+    OverlapPairs pairs = findOverlaps(polys, threads);
+    for (size_t k = 0; k < pairs.size(); ++k) {
+        auto [a, b] = pairs[k];
+        auto ax = polys.xsOf(a), ay = polys.ysOf(a);
+        auto bx = polys.xsOf(b), by = polys.ysOf(b);
+
+        for (size_t i = 0; i < ax.size(); ++i) {
+            size_t i1 = (i + 1) % ax.size();
+            double rx = ax[i1] - ax[i], ry = ay[i1] - ay[i];
+
+            for (size_t j = 0; j < bx.size(); ++j) {
+                size_t j1 = (j + 1) % bx.size();
+                double sx = bx[j1] - bx[j], sy = by[j1] - by[j];
+
+                double denom = rx * sy - ry * sx;
+                if (denom == 0)
+                    continue;
+
+                double qx = bx[j] - ax[i], qy = by[j] - ay[i];
+                double t = (qx * sy - qy * sx) / denom;
+                double u = (qx * ry - qy * rx) / denom;
+                if (t > 0 && t < 1 && u > 0 && u < 1)
+                    cuts.push_back(ax[i] + t * rx);
+            }
+        }
+    }
+
+    std::sort(cuts.begin(), cuts.end());
+    cuts.erase(std::unique(cuts.begin(), cuts.end()), cuts.end());
+    if (cuts.size() < 2)
+        return 0.0;
+
+    std::vector<size_t> byMinX = sortedByMinX(polys);
+
+    return sumOverStrips(cuts.size() - 1, threads, [&](size_t begin, size_t end) {
+        double area = 0.0;
+        std::vector<std::pair<double, double>> intervals;
+
+        sweepSlabs(polys, byMinX, cuts, begin, end, [&](double x0, double x1, const std::vector<size_t>& active) {
+            double mid = (x0 + x1) / 2;
+            intervals.clear();
+            for (size_t p : active) {
+                double lo, hi;
+                if (crossSection(polys, p, mid, lo, hi))
+                    intervals.emplace_back(lo, hi);
+            }
+            area += (x1 - x0) * unionLength(intervals);
+        });
+        return area;
+    });
+}
+
+// Approximate union area over `slabs` equal-width slabs. In each slab a figure
+// surely covers the y-range it covers at both slab edges (convexity) and at most
+// covers its y-range over the whole slab, which gives a lower and an upper bound;
+// the estimate is their midpoint and errorBound is the guaranteed maximum error.
+inline CoverageEstimate approximateCoveredArea(const Polygons& polys, size_t slabs,
+                                               size_t threads = std::thread::hardware_concurrency()) {
+    if (!polys.size() || !slabs)
+        return {0.0, 0.0};
+
+    Box<double> all;
+    for (size_t p = 0; p < polys.size(); ++p)
+        all.expand(polys.bounds(p));
+
+    std::vector<double> cuts(slabs + 1);
+    for (size_t s = 0; s <= slabs; ++s)
+        cuts[s] = all.minX + (all.maxX - all.minX) * s / slabs;
+    cuts.back() = all.maxX;
+
+    std::vector<size_t> byMinX = sortedByMinX(polys);
+
+    auto bound = [&](bool upper) {
+        return sumOverStrips(slabs, threads, [&](size_t begin, size_t end) {
+            double area = 0.0;
+            std::vector<std::pair<double, double>> intervals;
+
+            sweepSlabs(polys, byMinX, cuts, begin, end, [&](double x0, double x1, const std::vector<size_t>& active) {
+                intervals.clear();
+                for (size_t p : active) {
+                    const Box<double>& box = polys.bounds(p);
+                    double loA, hiA, loB, hiB;
+                    double a = std::max(x0, box.minX), b = std::min(x1, box.maxX);
+                    if (!crossSection(polys, p, a, loA, hiA) || !crossSection(polys, p, b, loB, hiB))
+                        continue;
+
+                    if (upper) {
+                        double lo = std::min(loA, loB), hi = std::max(hiA, hiB);
+                        auto xs = polys.xsOf(p), ys = polys.ysOf(p);
+                        for (size_t v = 0; v < xs.size(); ++v) {
+                            if (xs[v] > a && xs[v] < b) {
+                                lo = std::min(lo, ys[v]);
+                                hi = std::max(hi, ys[v]);
+                            }
+                        }
+                        intervals.emplace_back(lo, hi);
+                    } else if (box.minX <= x0 && box.maxX >= x1) {
+                        double lo = std::max(loA, loB), hi = std::min(hiA, hiB);
+                        if (lo < hi)
+                            intervals.emplace_back(lo, hi);
+                    }
+                }
+                area += (x1 - x0) * unionLength(intervals);
+            });
+            return area;
+        });
+    };
+
+    double lower = bound(false);
+    double upper = bound(true);
+    return {(lower + upper) / 2, (upper - lower) / 2};
+}
+
+template <FigureContainer C>
+double coveredArea(const C& figures, size_t threads = std::thread::hardware_concurrency()) {
+    return coveredArea(Polygons(figures), threads);
+}
+
+template <FigureContainer C>
+CoverageEstimate approximateCoveredArea(const C& figures, size_t slabs,
+                                        size_t threads = std::thread::hardware_concurrency()) {
+    return approximateCoveredArea(Polygons(figures), slabs, threads);
+}
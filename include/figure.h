@@ -1,35 +1,102 @@
-#pragma once
-
-#include "point.h"
-
-#include <memory>
-
-template <Scalar T>
-class Figure {
-public:
-    virtual ~Figure() noexcept = default;
-
-    virtual Point<T> center() const = 0;
-    virtual operator double() const = 0;
-    virtual bool equals(const Figure<T>& other) const = 0;
-
-    bool operator==(const Figure<T>& other) const {
-        return equals(other);
-    }
-
-    friend std::ostream& operator<<(std::ostream& os, const Figure<T>& fig) {
-        fig.print(os);
-        return os;
-    }
-
-    friend std::istream& operator>>(std::istream& is, Figure<T>& fig) {
-        fig.read(is);
-        return is;
-    }
-
-protected:
-    Figure() = default;
-
-    virtual void print(std::ostream& os) const = 0;
-    virtual void read(std::istream& is) = 0;
-};
\ No newline at end of file
+#pragma once
+
+#include "point.h"
+#include "box.h"
+#include "affine.h"
+#include "text_writer.h"
+
+#include <array>
+#include <memory>
+#include <stdexcept>
+
+template <Scalar T>
+class Figure {
+public:
+    virtual ~Figure() noexcept = default;
+
+    virtual Point<T> center() const = 0;
+    virtual operator double() const = 0;
+    virtual bool equals(const Figure<T>& other) const = 0;
+
+    virtual std::string_view name() const = 0;
+    virtual size_t vertexCount() const = 0;
+    virtual Point<T> vertex(size_t index) const = 0;
+    virtual bool contains(const Point<T>& p) const = 0;
+
+    Box<T> bounds() const {
+        Box<T> box;
+        for (size_t i = 0; i < vertexCount(); ++i)
+            box.expand(vertex(i));
+        return box;
+    }
+
+    void transform(const Affine2<T>& m) {
+        if (!m.isSimilarity())
+            throw std::invalid_argument("Transform must be a rotation, uniform scale or translation");
+        applyTransform(m);
+    }
+
+    void translate(T dx, T dy) {
+        transform(Affine2<T>::translation(dx, dy));
+    }
+
+    void rotate(double angle, const Point<T>& pivot = Point<T>()) {
+        transform(Affine2<T>::rotation(angle, pivot));
+    }
+
+    void scale(T factor, const Point<T>& pivot = Point<T>()) {
+        transform(Affine2<T>::scaling(factor, pivot));
+    }
+
+    bool operator==(const Figure<T>& other) const {
+        return equals(other);
+    }
+
+    // Same text as operator<<, without going through iostreams.
+    void writeTo(TextWriter& out) const {
+        out << name() << ": ";
+        for (size_t i = 0; i < vertexCount(); ++i)
+            out << vertex(i) << ' ';
+    }
+
+    friend std::ostream& operator<<(std::ostream& os, const Figure<T>& fig) {
+        fig.print(os);
+        return os;
+    }
+
+    friend std::istream& operator>>(std::istream& is, Figure<T>& fig) {
+        fig.read(is);
+        return is;
+    }
+
+protected:
+    Figure() = default;
+
+    virtual void print(std::ostream& os) const = 0;
+    virtual void read(std::istream& is) = 0;
+    virtual void applyTransform(const Affine2<T>& m) = 0;
+
+    // Edge-function test for a convex polygon with counter-clockwise vertices.
+    // Points on the boundary count as inside. Evaluated in double: in T the
+    // products overflow for large int coordinates and round near the edges
+    // for float.
+    template <size_t N>
+    static bool containsConvex(const std::array<std::unique_ptr<Point<T>>, N>& points, const Point<T>& p) {
+        Point<double> q(p);
+        for (size_t i = 0; i < N; ++i) {
+            Point<double> a(*points[i]);
+            Point<double> b(*points[(i + 1) % N]);
+            if ((b - a).cross(q - a) < 0)
+                return false;
+        }
+        return true;
+    }
+};
+
+template <typename E>
+decltype(auto) asFigure(E& elem) {
+    if constexpr (requires { *elem; })
+        return *elem;
+    else
+        return (elem);
+}
\ No newline at end of file
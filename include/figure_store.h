@@ -0,0 +1,295 @@
+#pragma once
+
+#include "binary_format.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <filesystem>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// Figure collection persisted as snapshot + write-ahead log in a directory.
+//
+// Every add/remove is appended to log-<G>.wal as
+//   [u64 payload size][payload][u64 checksum of payload]
+// with payload = 'A', kind, vertex x/y pairs (f64) or 'R', u64 index, all
+// little-endian. Records are buffered and written + fdatasync'ed together
+// once groupCommit of them are pending (or on commit()/destruction).
+//
+// Every snapshotInterval operations the whole collection is written to
+// snapshot-<G+1>.bin in the binary figure format, an empty log-<G+1>.wal is
+// started and generation G is deleted. Startup loads the newest snapshot and
+// replays only its log, stopping at the first torn or corrupt record.
+template <Scalar T>
+class FigureStore {
+public:
+    struct Options {
+        size_t groupCommit = 64;
+        size_t snapshotInterval = 4096;
+    };
+
+    explicit FigureStore(const std::string& directory) : FigureStore(directory, Options{}) {}
+
+    FigureStore(const std::string& directory, Options options) : dir(directory), options(options) {
+        std::filesystem::create_directories(dir);
+        recover();
+    }
+
+    ~FigureStore() {
+        try {
+            commit();
+        } catch (...) {
+        }
+        if (logFd >= 0)
+            ::close(logFd);
+    }
+
+    FigureStore(const FigureStore&) = delete;
+    FigureStore& operator=(const FigureStore&) = delete;
+
+    const Array<std::shared_ptr<Figure<T>>>& figures() const {
+        return items;
+    }
+
+    void setVerbose(bool enabled) {
+        items.setVerbose(enabled);
+    }
+
+    uint64_t generation() const {
+        return gen;
+    }
+
+    size_t operationsSinceSnapshot() const {
+        return sinceSnapshot;
+    }
+
+    void add(std::shared_ptr<Figure<T>> fig) {
+        FigureKind kind = BinaryFormat::kindOf(*fig);
+
+        std::vector<unsigned char> payload{'A', static_cast<unsigned char>(kind)};
+        payload.resize(2 + 16 * fig->vertexCount());
+        for (size_t v = 0; v < fig->vertexCount(); ++v) {
+            auto p = fig->vertex(v);
+            BinaryFormat::storeLE(&payload[2 + 16 * v], std::bit_cast<uint64_t>(static_cast<double>(p.x())));
+            BinaryFormat::storeLE(&payload[10 + 16 * v], std::bit_cast<uint64_t>(static_cast<double>(p.y())));
+        }
+
+        items.add(std::move(fig));
+        append(payload);
+    }
+
+    void remove(size_t index) {
+        items.remove(index);
+
+        std::vector<unsigned char> payload(9);
+        payload[0] = 'R';
+        BinaryFormat::storeLE(&payload[1], index);
+        append(payload);
+    }
+
+    void commit() {
+        if (pending.empty())
+            return;
+
+        writeAll(logFd, pending.data(), pending.size());
+        if (::fdatasync(logFd) < 0)
+            throw std::runtime_error("Cannot sync figure log");
+        pending.clear();
+        pendingRecords = 0;
+    }
+
+    void snapshot() {
+        commit();
+
+        auto bytes = BinaryFigureWriter::encode(items);
+        auto tmp = dir / ("snapshot-" + std::to_string(gen + 1) + ".tmp");
+        int fd = ::open(tmp.c_str(), O_CREAT | O_WRONLY | O_TRUNC, 0644);
+        if (fd < 0)
+            throw std::runtime_error("Cannot create snapshot: " + tmp.string());
+        try {
+            writeAll(fd, bytes.data(), bytes.size());
+            if (::fsync(fd) < 0)
+                throw std::runtime_error("Cannot sync snapshot: " + tmp.string());
+        } catch (...) {
+            ::close(fd);
+            std::filesystem::remove(tmp);
+            throw;
+        }
+        ::close(fd);
+
+        std::filesystem::rename(tmp, snapshotPath(gen + 1));
+        syncDirectory();
+
+        // Cleared right away: if a remove below throws, the destructor must
+        // not close the number again after it may have been reused.
+        ::close(logFd);
+        logFd = -1;
+        std::filesystem::remove(snapshotPath(gen));
+        std::filesystem::remove(logPath(gen));
+        ++gen;
+        openLog(true);
+        sinceSnapshot = 0;
+    }
+
+private:
+    std::filesystem::path snapshotPath(uint64_t g) const {
+        return dir / ("snapshot-" + std::to_string(g) + ".bin");
+    }
+
+    std::filesystem::path logPath(uint64_t g) const {
+        return dir / ("log-" + std::to_string(g) + ".wal");
+    }
+
+    void append(const std::vector<unsigned char>& payload) {
+        size_t at = pending.size();
+        pending.resize(at + 16 + payload.size());
+        BinaryFormat::storeLE(&pending[at], payload.size());
+        std::copy(payload.begin(), payload.end(), pending.begin() + at + 8);
+        BinaryFormat::storeLE(&pending[at + 8 + payload.size()],
+                              BinaryFormat::checksum(payload.data(), payload.size()));
+
+        ++pendingRecords;
+        ++sinceSnapshot;
+        if (pendingRecords >= options.groupCommit)
+            commit();
+        if (options.snapshotInterval && sinceSnapshot >= options.snapshotInterval)
+            snapshot();
+    }
+
+    // Generation G of a file named <prefix>G<suffix>; nothing for any other
+    // name, so stray files in the directory are left alone.
+    static std::optional<uint64_t> generationOf(std::string_view name, std::string_view prefix,
+                                                std::string_view suffix) {
+        if (name.size() <= prefix.size() + suffix.size() || !name.starts_with(prefix) || !name.ends_with(suffix))
+            return std::nullopt;
+        std::string_view digits = name.substr(prefix.size(), name.size() - prefix.size() - suffix.size());
+        uint64_t g = 0;
+        auto [ptr, ec] = std::from_chars(digits.data(), digits.data() + digits.size(), g);
+        if (ec != std::errc() || ptr != digits.data() + digits.size())
+            return std::nullopt;
+        return g;
+    }
+
+    void recover() {
+        for (const auto& entry : std::filesystem::directory_iterator(dir))
+            if (auto g = generationOf(entry.path().filename().string(), "snapshot-", ".bin"))
+                gen = std::max(gen, *g);
+
+        if (std::filesystem::exists(snapshotPath(gen)))
+            items = BinaryFigureFile(snapshotPath(gen).string()).figures<T>();
+
+        for (const auto& entry : std::filesystem::directory_iterator(dir)) {
+            std::string name = entry.path().filename().string();
+            bool stale = (generationOf(name, "snapshot-", ".bin") && entry.path() != snapshotPath(gen)) ||
+                         generationOf(name, "snapshot-", ".tmp") ||
+                         (generationOf(name, "log-", ".wal") && entry.path() != logPath(gen));
+            if (stale)
+                std::filesystem::remove(entry.path());
+        }
+
+        size_t valid = replay();
+        if (std::filesystem::exists(logPath(gen)))
+            std::filesystem::resize_file(logPath(gen), valid);
+        openLog(false);
+    }
+
+    // Applies log records in order; returns the byte length of the valid prefix.
+    size_t replay() {
+        if (!std::filesystem::exists(logPath(gen)) || !std::filesystem::file_size(logPath(gen)))
+            return 0;
+
+        MappedFile log(logPath(gen).string());
+        const auto* data = reinterpret_cast<const unsigned char*>(log.data());
+        size_t pos = 0;
+
+        bool verbose = items.isVerbose();
+        items.setVerbose(false);
+        while (log.size() - pos >= 16) {
+            uint64_t size = BinaryFormat::loadLE(data + pos);
+            if (size > log.size() - pos - 16)
+                break;
+
+            const unsigned char* payload = data + pos + 8;
+            if (BinaryFormat::checksum(payload, size) != BinaryFormat::loadLE(payload + size))
+                break;
+            if (!apply(payload, size))
+                break;
+
+            pos += 16 + size;
+            ++sinceSnapshot;
+        }
+        items.setVerbose(verbose);
+        return pos;
+    }
+
+    bool apply(const unsigned char* payload, size_t size) {
+        if (size == 9 && payload[0] == 'R') {
+            uint64_t index = BinaryFormat::loadLE(payload + 1);
+            if (index >= static_cast<uint64_t>(items.getSize()))
+                return false;
+            items.remove(index);
+            return true;
+        }
+
+        if (size < 2 || payload[0] != 'A' || payload[1] >= BinaryFormat::kinds)
+            return false;
+        size_t n = BinaryFormat::vertexCounts[payload[1]];
+        if (size != 2 + 16 * n)
+            return false;
+
+        std::array<Point<T>, 8> points;
+        for (size_t v = 0; v < n; ++v)
+            points[v] = Point<T>(static_cast<T>(std::bit_cast<double>(BinaryFormat::loadLE(payload + 2 + 16 * v))),
+                                 static_cast<T>(std::bit_cast<double>(BinaryFormat::loadLE(payload + 10 + 16 * v))));
+
+        items.add(BinaryFormat::makeFigure<T>(static_cast<FigureKind>(payload[1]), std::span(points.data(), n)));
+        return true;
+    }
+
+    void openLog(bool truncate) {
+        int flags = O_CREAT | O_WRONLY | O_APPEND | (truncate ? O_TRUNC : 0);
+        logFd = ::open(logPath(gen).c_str(), flags, 0644);
+        if (logFd < 0)
+            throw std::runtime_error("Cannot open figure log: " + logPath(gen).string());
+    }
+
+    void syncDirectory() const {
+        int fd = ::open(dir.c_str(), O_RDONLY | O_DIRECTORY);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open figure directory: " + dir.string());
+        int synced = ::fsync(fd);
+        ::close(fd);
+        if (synced < 0)
+            throw std::runtime_error("Cannot sync figure directory: " + dir.string());
+    }
+
+    static void writeAll(int fd, const unsigned char* data, size_t size) {
+        while (size) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::runtime_error("Cannot write figure log");
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    std::filesystem::path dir;
+    Options options;
+    Array<std::shared_ptr<Figure<T>>> items;
+    std::vector<unsigned char> pending;
+    size_t pendingRecords = 0;
+    size_t sinceSnapshot = 0;
+    uint64_t gen = 0;
+    int logFd = -1;
+};
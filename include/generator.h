@@ -0,0 +1,135 @@
+#pragma once
+
+#include <coroutine>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Lazy sequence produced by a coroutine with co_yield. The body runs only
+// while the caller advances the iterator, one element at a time, so nothing
+// is buffered between producer and consumer. Elements are handed out by
+// reference and may be moved from. An exception thrown by the body comes
+// out of begin() or operator++.
+template <typename T>
+class Generator {
+public:
+    using value_type = std::remove_cvref_t<T>;
+
+    struct promise_type {
+        value_type* current = nullptr;
+        std::exception_ptr error;
+
+        Generator get_return_object() {
+            return Generator(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always final_suspend() noexcept {
+            return {};
+        }
+
+        std::suspend_always yield_value(value_type& value) noexcept {
+            current = std::addressof(value);
+            return {};
+        }
+
+        std::suspend_always yield_value(value_type&& value) noexcept {
+            current = std::addressof(value);
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception() {
+            error = std::current_exception();
+        }
+
+        // Generators produce values; they cannot wait on anything.
+        template <typename U>
+        std::suspend_never await_transform(U&&) = delete;
+    };
+
+    class Iterator {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Generator::value_type;
+        using difference_type = std::ptrdiff_t;
+
+        Iterator() = default;
+
+        explicit Iterator(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+        value_type& operator*() const {
+            return *handle.promise().current;
+        }
+
+        value_type* operator->() const {
+            return handle.promise().current;
+        }
+
+        Iterator& operator++() {
+            step(handle);
+            return *this;
+        }
+
+        void operator++(int) {
+            ++*this;
+        }
+
+        bool operator==(std::default_sentinel_t) const {
+            return !handle || handle.done();
+        }
+
+    private:
+        std::coroutine_handle<promise_type> handle;
+    };
+
+    Generator(Generator&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+
+    Generator& operator=(Generator&& other) noexcept {
+        if (this != &other) {
+            if (handle)
+                handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+
+    Generator(const Generator&) = delete;
+    Generator& operator=(const Generator&) = delete;
+
+    ~Generator() {
+        if (handle)
+            handle.destroy();
+    }
+
+    // Starts the body; a generator can be iterated only once.
+    Iterator begin() {
+        if (handle && !started) {
+            started = true;
+            step(handle);
+        }
+        return Iterator(handle);
+    }
+
+    std::default_sentinel_t end() const {
+        return {};
+    }
+
+private:
+    explicit Generator(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    static void step(std::coroutine_handle<promise_type> handle) {
+        handle.resume();
+        if (handle.done() && handle.promise().error)
+            std::rethrow_exception(std::exchange(handle.promise().error, nullptr));
+    }
+
+    std::coroutine_handle<promise_type> handle;
+    bool started = false;
+};
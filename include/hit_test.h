@@ -0,0 +1,97 @@
+#pragma once
+
+#include "array.h"
+#include "rtree.h"
+
+#include <span>
+#include <vector>
+
+// Batch point-in-figure queries. Candidates come from an R-tree over the
+// bounding boxes; each candidate is then checked against its edge functions
+// a*x + b*y + c >= 0, stored flat with every figure padded to maxEdges so the
+// inner loop has a fixed trip count and no branches.
+template <Scalar T>
+class HitTester {
+public:
+    static constexpr size_t maxEdges = 8;
+
+    class Hits {
+    public:
+        size_t size() const {
+            return offsets.size() - 1;
+        }
+
+        std::span<const size_t> figuresAt(size_t point) const {
+            if (point >= size())
+                throw std::out_of_range("Index out of range");
+            return std::span<const size_t>(figures).subspan(offsets[point], offsets[point + 1] - offsets[point]);
+        }
+
+    private:
+        friend class HitTester;
+
+        std::vector<size_t> offsets{0};
+        std::vector<size_t> figures;
+    };
+
+    template <FigureContainer C>
+    explicit HitTester(const C& figures) : tree(figures) {
+        size_t n = figures.getSize();
+        a.assign(n * maxEdges, 0.0);
+        b.assign(n * maxEdges, 0.0);
+        c.assign(n * maxEdges, 0.0);
+
+        for (size_t f = 0; f < n; ++f) {
+            const auto& fig = asFigure(figures[f]);
+            size_t count = fig.vertexCount();
+            if (count > maxEdges)
+                throw std::invalid_argument("Figure has too many edges for HitTester");
+
+            for (size_t e = 0; e < count; ++e) {
+                Point<T> p0 = fig.vertex(e), p1 = fig.vertex((e + 1) % count);
+                double ea = -(double(p1.y()) - p0.y());
+                double eb = double(p1.x()) - p0.x();
+                a[f * maxEdges + e] = ea;
+                b[f * maxEdges + e] = eb;
+                c[f * maxEdges + e] = -(ea * p0.x() + eb * p0.y());
+            }
+        }
+    }
+
+    bool hit(size_t figure, const Point<T>& p) const {
+        const double* fa = &a[figure * maxEdges];
+        const double* fb = &b[figure * maxEdges];
+        const double* fc = &c[figure * maxEdges];
+        double x = p.x(), y = p.y();
+
+        int outside = 0;
+        for (size_t e = 0; e < maxEdges; ++e)
+            outside |= (fa[e] * x + fb[e] * y + fc[e] < 0);
+        return !outside;
+    }
+
+    std::vector<size_t> query(const Point<T>& p) const {
+        std::vector<size_t> result;
+        for (size_t f : tree.query(Box<T>(p.x(), p.y(), p.x(), p.y())))
+            if (hit(f, p))
+                result.push_back(f);
+        return result;
+    }
+
+    Hits query(std::span<const Point<T>> points) const {
+        Hits hits;
+        hits.offsets.reserve(points.size() + 1);
+
+        for (const auto& p : points) {
+            for (size_t f : tree.query(Box<T>(p.x(), p.y(), p.x(), p.y())))
+                if (hit(f, p))
+                    hits.figures.push_back(f);
+            hits.offsets.push_back(hits.figures.size());
+        }
+        return hits;
+    }
+
+private:
+    RTree<T> tree;
+    std::vector<double> a, b, c;
+};
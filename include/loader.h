@@ -0,0 +1,249 @@
+#pragma once
+
+#include "array.h"
+#include "square.h"
+#include "triangle.h"
+#include "octagon.h"
+#include "mapped_file.h"
+#include "scheduler.h"
+#include "generator.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <istream>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+struct LoadError {
+    size_t line;
+    std::string message;
+};
+
+// Non-interactive figure input, one figure per line:
+//   S x1 y1 x2 y2        square from its bottom side
+//   T x1 y1 x2 y2 h      triangle from its base and height
+//   O cx cy vx vy        octagon from its center and one vertex
+// Blank lines and lines starting with '#' are skipped. Invalid lines are
+// reported in errors (1-based line numbers) instead of being printed, and
+// degenerate input is rejected before it reaches the shape constructors.
+template <Scalar T>
+class FigureLoader {
+public:
+    struct Result {
+        Array<std::shared_ptr<Figure<T>>> figures;
+        std::vector<LoadError> errors;
+    };
+
+    static Result parse(std::string_view text, size_t threads = 1) {
+        std::vector<std::string_view> chunks = split(text, threads);
+        std::vector<Chunk> parsed(chunks.size());
+
+        TaskScheduler::global().forEachChunk(chunks.size(), chunks.size(), [&](size_t, size_t, size_t i) {
+            parseChunk(chunks[i], parsed[i]);
+        });
+
+        Result result;
+        size_t lineOffset = 0;
+        for (auto& chunk : parsed) {
+            for (auto& fig : chunk.figures)
+                result.figures.add(std::move(fig));
+            for (auto& error : chunk.errors)
+                result.errors.push_back(LoadError{error.line + lineOffset, std::move(error.message)});
+            lineOffset += chunk.lines;
+        }
+        return result;
+    }
+
+    static Result loadFile(const std::string& path, size_t threads = 1) {
+        MappedFile file(path);
+        return parse(file.text(), threads);
+    }
+
+    static Result load(std::istream& is, size_t threads = 1) {
+        std::string text(std::istreambuf_iterator<char>(is), {});
+        return parse(text, threads);
+    }
+
+    // Parses a single figure line; throws std::invalid_argument on bad input.
+    static std::shared_ptr<Figure<T>> parseFigure(std::string_view line) {
+        std::vector<std::shared_ptr<Figure<T>>> parsed;
+        std::string error = parseLine(line, parsed);
+        if (!error.empty())
+            throw std::invalid_argument(error);
+        if (parsed.empty())
+            throw std::invalid_argument("Expected a figure");
+        return std::move(parsed.front());
+    }
+
+    // Parses one line at a time while the caller consumes the figures, so
+    // memory does not grow with the input. Invalid lines go to errors, when
+    // given, as they are reached.
+    static Generator<std::shared_ptr<Figure<T>>> stream(std::istream& is, std::vector<LoadError>* errors = nullptr) {
+        std::string line;
+        std::vector<std::shared_ptr<Figure<T>>> parsed;
+        size_t number = 0;
+        while (std::getline(is, line)) {
+            ++number;
+            std::string error = parseLine(line, parsed);
+            if (!error.empty() && errors)
+                errors->push_back(LoadError{number, std::move(error)});
+            for (auto& fig : parsed)
+                co_yield std::move(fig);
+            parsed.clear();
+        }
+    }
+
+    // Size checks shared with other input paths, on lengths in double.
+    // Negligible: below rounding noise at the coordinates' magnitude, or with
+    // a square that underflows T, so the constructors would get a zero length
+    // or area.
+    static bool negligible(double size, double scale) {
+        if constexpr (std::is_floating_point_v<T>) {
+            T squared = static_cast<T>(size) * static_cast<T>(size);
+            return !(size > 1024 * std::numeric_limits<T>::epsilon() * scale) || squared < std::numeric_limits<T>::min();
+        } else {
+            return size < 1;
+        }
+    }
+
+    // Areas are squared lengths, computed in T.
+    static bool tooLarge(double size) {
+        return size * size > static_cast<double>(std::numeric_limits<T>::max());
+    }
+
+private:
+    struct Chunk {
+        std::vector<std::shared_ptr<Figure<T>>> figures;
+        std::vector<LoadError> errors;
+        size_t lines = 0;
+    };
+
+    // Cuts text into up to `parts` pieces, each ending right after a newline.
+    static std::vector<std::string_view> split(std::string_view text, size_t parts) {
+        parts = std::clamp<size_t>(parts, 1, std::max<size_t>(text.size() / (1 << 16), 1));
+        std::vector<std::string_view> chunks;
+
+        size_t begin = 0;
+        for (size_t i = 1; i <= parts && begin < text.size(); ++i) {
+            size_t end = (i == parts) ? text.size() : text.size() * i / parts;
+            if (end < begin)
+                end = begin;
+            size_t newline = text.find('\n', end == 0 ? 0 : end - 1);
+            end = (i == parts || newline == std::string_view::npos) ? text.size() : newline + 1;
+
+            chunks.push_back(text.substr(begin, end - begin));
+            begin = end;
+        }
+        if (chunks.empty())
+            chunks.push_back(text);
+        return chunks;
+    }
+
+    static void parseChunk(std::string_view text, Chunk& chunk) {
+        size_t pos = 0;
+        while (pos < text.size()) {
+            size_t end = text.find('\n', pos);
+            if (end == std::string_view::npos)
+                end = text.size();
+
+            ++chunk.lines;
+            std::string error = parseLine(text.substr(pos, end - pos), chunk.figures);
+            if (!error.empty())
+                chunk.errors.push_back(LoadError{chunk.lines, std::move(error)});
+
+            pos = end + 1;
+        }
+    }
+
+    static bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    static std::string_view nextToken(std::string_view& line) {
+        size_t begin = 0;
+        while (begin < line.size() && isSpace(line[begin]))
+            ++begin;
+        size_t end = begin;
+        while (end < line.size() && !isSpace(line[end]))
+            ++end;
+
+        std::string_view token = line.substr(begin, end - begin);
+        line.remove_prefix(end);
+        return token;
+    }
+
+    static bool parseNumbers(std::string_view& line, T* values, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            std::string_view token = nextToken(line);
+            if (token.empty())
+                return false;
+
+            auto [ptr, ec] = std::from_chars(token.data(), token.data() + token.size(), values[i]);
+            if (ec != std::errc() || ptr != token.data() + token.size())
+                return false;
+        }
+        return true;
+    }
+
+    // Returns an error message, or an empty string when the line was accepted.
+    static std::string parseLine(std::string_view line, std::vector<std::shared_ptr<Figure<T>>>& out) {
+        std::string_view tag = nextToken(line);
+        if (tag.empty() || tag[0] == '#')
+            return {};
+
+        T v[5];
+        size_t count = (tag == "T") ? 5 : 4;
+        if (tag != "S" && tag != "T" && tag != "O")
+            return "Unknown figure type '" + std::string(tag) + "'";
+        if (!parseNumbers(line, v, count))
+            return "Expected " + std::to_string(count) + " numbers after '" + std::string(tag) + "'";
+        // from_chars accepts nan and inf, which no figure can be built from.
+        for (size_t i = 0; i < count; ++i)
+            if (!std::isfinite(static_cast<double>(v[i])))
+                return "Numbers must be finite";
+        if (!nextToken(line).empty())
+            return "Unexpected trailing input";
+
+        return build(tag[0], std::span<const T>(v, count), out);
+    }
+
+    // Builds the figure a line's numbers describe, rejecting the ones the
+    // shape constructors would reset to a unit figure or overflow on.
+    // Returns an error message, or an empty string when the figure was added.
+    static std::string build(char tag, std::span<const T> v, std::vector<std::shared_ptr<Figure<T>>>& out) {
+        Point<T> a(v[0], v[1]), b(v[2], v[3]);
+        if (a == b)
+            return "Points are identical";
+
+        double length = std::hypot(static_cast<double>(v[2]) - v[0], static_cast<double>(v[3]) - v[1]);
+        double scale = std::max(std::hypot(static_cast<double>(v[0]), static_cast<double>(v[1])),
+                                std::hypot(static_cast<double>(v[2]), static_cast<double>(v[3])));
+        if (tooLarge(length))
+            return "Figure is too large";
+        if (negligible(length, scale))
+            return "Points are too close together";
+
+        if (tag == 'S') {
+            out.push_back(std::make_shared<Square<T>>(a, b));
+        } else if (tag == 'T') {
+            if (v[4] <= 0)
+                return "Height must be positive";
+            if (tooLarge(v[4]))
+                return "Figure is too large";
+            if (negligible(v[4], scale))
+                return "Height is too small";
+            out.push_back(std::make_shared<Triangle<T>>(a, b, v[4]));
+        } else {
+            out.push_back(std::make_shared<Octagon<T>>(a, b));
+        }
+        return {};
+    }
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "array.h"
+#include "polygons.h"
+#include "scheduler.h"
+#include "transform.h"
+
+#include <type_traits>
+#include <vector>
+
+// Figure-collection algorithms on the task scheduler. Reductions fold their
+// chunk results in index order, so for a given scheduler the result does not
+// depend on which worker ran which chunk.
+
+template <FigureContainer C>
+double parallelTotalArea(const C& figures, TaskScheduler& scheduler = TaskScheduler::global()) {
+    return scheduler.parallelReduce(size_t(0), size_t(figures.getSize()), 0.0,
+        [&](size_t begin, size_t end) {
+            double sum = 0.0;
+            for (size_t i = begin; i < end; ++i)
+                sum += static_cast<double>(asFigure(figures[i]));
+            return sum;
+        },
+        [](double a, double b) { return a + b; });
+}
+
+template <FigureContainer C>
+auto parallelCenters(const C& figures, TaskScheduler& scheduler = TaskScheduler::global()) {
+    using T = FigureScalar<std::remove_cvref_t<decltype(figures[0])>>;
+    std::vector<Point<T>> centers(figures.getSize());
+    scheduler.parallelFor(0, centers.size(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            centers[i] = asFigure(figures[i]).center();
+    });
+    return centers;
+}
+
+template <FigureContainer C>
+auto parallelBounds(const C& figures, TaskScheduler& scheduler = TaskScheduler::global()) {
+    using T = FigureScalar<std::remove_cvref_t<decltype(figures[0])>>;
+    return scheduler.parallelReduce(size_t(0), size_t(figures.getSize()), Box<T>(),
+        [&](size_t begin, size_t end) {
+            Box<T> box;
+            for (size_t i = begin; i < end; ++i)
+                box.expand(asFigure(figures[i]).bounds());
+            return box;
+        },
+        [](Box<T> a, const Box<T>& b) {
+            a.expand(b);
+            return a;
+        });
+}
+
+template <typename E>
+void parallelTransformAll(Array<E>& figures, const Affine2<FigureScalar<E>>& m,
+                          TaskScheduler& scheduler = TaskScheduler::global()) {
+    scheduler.parallelFor(0, figures.getSize(), [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; ++i)
+            asFigure(figures[i]).transform(m);
+    });
+}
+
+// Shoelace area straight from the vertex columns, no virtual calls.
+inline double parallelTotalArea(const Polygons& polys, TaskScheduler& scheduler = TaskScheduler::global()) {
+    return scheduler.parallelReduce(size_t(0), polys.size(), 0.0,
+        [&](size_t begin, size_t end) {
+            double sum = 0.0;
+            for (size_t p = begin; p < end; ++p) {
+                auto xs = polys.xsOf(p), ys = polys.ysOf(p);
+                double twice = 0.0;
+                for (size_t v = 0, n = xs.size(); v < n; ++v) {
+                    size_t next = (v + 1 == n) ? 0 : v + 1;
+                    twice += xs[v] * ys[next] - xs[next] * ys[v];
+                }
+                sum += twice / 2;
+            }
+            return sum;
+        },
+        [](double a, double b) { return a + b; });
+}
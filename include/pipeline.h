@@ -0,0 +1,383 @@
+#pragma once
+
+#include "generator.h"
+#include "scheduler.h"
+
+#include <atomic>
+#include <coroutine>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Coroutine stages connected by bounded channels, running on the task
+// scheduler. A stage that pushes into a full channel or pops from an empty
+// one is suspended, not blocked: the worker thread moves on to other stages,
+// and the stage is resubmitted to the scheduler once the channel has room or
+// data. The channel capacities therefore bound the memory of the whole
+// pipeline, and the slowest stage sets its pace.
+//
+//   Pipeline pipeline;
+//   auto& parsed = pipeline.channel<std::shared_ptr<Figure<double>>>(256);
+//   pipeline.produce(FigureLoader<double>::stream(input), parsed);
+//   pipeline.consume(parsed, [&](auto fig) { window.add(*fig); });
+//   pipeline.wait();
+
+class ChannelBase {
+public:
+    virtual ~ChannelBase() = default;
+    virtual void close() = 0;
+};
+
+// Bounded multi-producer multi-consumer queue whose push and pop are awaited
+// from pipeline stages. Closing wakes every waiting stage: pending and later
+// pushes are refused (push yields false), and pops drain what is left and
+// then yield an empty optional.
+template <typename T>
+class Channel : public ChannelBase {
+public:
+    explicit Channel(size_t capacity, TaskScheduler& scheduler = TaskScheduler::global())
+        : capacity(std::max<size_t>(capacity, 1)), scheduler(scheduler) {}
+
+    class PushAwaiter {
+    public:
+        PushAwaiter(Channel& channel, T value) : channel(channel), value(std::move(value)) {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::unique_lock<std::mutex> lock(channel.mutex);
+            if (channel.closed) {
+                accepted = false;
+                return false;
+            }
+            if (!channel.receivers.empty()) {
+                PopAwaiter* receiver = channel.receivers.front();
+                channel.receivers.pop_front();
+                receiver->result = std::move(value);
+                lock.unlock();
+                channel.resume(receiver->waiting);
+                return false;
+            }
+            if (channel.items.size() < channel.capacity) {
+                channel.items.push_back(std::move(value));
+                return false;
+            }
+            waiting = handle;
+            channel.senders.push_back(this);
+            return true;
+        }
+
+        // False when the channel was closed and the value dropped.
+        bool await_resume() const noexcept {
+            return accepted;
+        }
+
+    private:
+        friend class Channel;
+
+        Channel& channel;
+        T value;
+        bool accepted = true;
+        std::coroutine_handle<> waiting;
+    };
+
+    class PopAwaiter {
+    public:
+        explicit PopAwaiter(Channel& channel) : channel(channel) {}
+
+        bool await_ready() const noexcept {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle) {
+            std::unique_lock<std::mutex> lock(channel.mutex);
+            if (!channel.items.empty()) {
+                result = std::move(channel.items.front());
+                channel.items.pop_front();
+                if (!channel.senders.empty()) {
+                    PushAwaiter* sender = channel.senders.front();
+                    channel.senders.pop_front();
+                    channel.items.push_back(std::move(sender->value));
+                    lock.unlock();
+                    channel.resume(sender->waiting);
+                }
+                return false;
+            }
+            if (channel.closed)
+                return false;
+            waiting = handle;
+            channel.receivers.push_back(this);
+            return true;
+        }
+
+        std::optional<T> await_resume() {
+            return std::move(result);
+        }
+
+    private:
+        friend class Channel;
+
+        Channel& channel;
+        std::optional<T> result;
+        std::coroutine_handle<> waiting;
+    };
+
+    PushAwaiter push(T value) {
+        return PushAwaiter(*this, std::move(value));
+    }
+
+    PopAwaiter pop() {
+        return PopAwaiter(*this);
+    }
+
+    void close() override {
+        std::deque<PushAwaiter*> refused;
+        std::deque<PopAwaiter*> drained;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (closed)
+                return;
+            closed = true;
+            refused.swap(senders);
+            drained.swap(receivers);
+        }
+        for (PushAwaiter* sender : refused) {
+            sender->accepted = false;
+            resume(sender->waiting);
+        }
+        for (PopAwaiter* receiver : drained)
+            resume(receiver->waiting);
+    }
+
+    size_t size() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size();
+    }
+
+private:
+    void resume(std::coroutine_handle<> handle) {
+        scheduler.submit([handle] { handle.resume(); });
+    }
+
+    size_t capacity;
+    TaskScheduler& scheduler;
+    mutable std::mutex mutex;
+    std::deque<T> items;
+    std::deque<PushAwaiter*> senders;
+    std::deque<PopAwaiter*> receivers;
+    bool closed = false;
+};
+
+class Pipeline;
+
+// Return type of a pipeline stage coroutine. The stage starts when it is
+// handed to Pipeline::stage() and reports back to the pipeline when done.
+class StageTask {
+public:
+    struct promise_type {
+        Pipeline* owner = nullptr;
+
+        StageTask get_return_object() {
+            return StageTask(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+
+        std::suspend_always initial_suspend() noexcept {
+            return {};
+        }
+
+        // Frees the frame and tells the pipeline this stage is done.
+        struct Finish {
+            bool await_ready() noexcept {
+                return false;
+            }
+
+            void await_suspend(std::coroutine_handle<promise_type> handle) noexcept;
+
+            void await_resume() noexcept {}
+        };
+
+        Finish final_suspend() noexcept {
+            return {};
+        }
+
+        void return_void() {}
+
+        void unhandled_exception();
+    };
+
+    StageTask(StageTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+
+    StageTask(const StageTask&) = delete;
+    StageTask& operator=(const StageTask&) = delete;
+
+    ~StageTask() {
+        if (handle)
+            handle.destroy();
+    }
+
+private:
+    friend class Pipeline;
+
+    explicit StageTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+// Owns the channels and stages of one pipeline. The first exception thrown
+// by a stage closes every channel, so the other stages wind down instead of
+// waiting forever, and is rethrown by wait().
+class Pipeline {
+public:
+    explicit Pipeline(TaskScheduler& scheduler = TaskScheduler::global()) : scheduler(scheduler) {}
+
+    ~Pipeline() {
+        if (pending.load(std::memory_order_acquire)) {
+            fail(nullptr);
+            drain();
+        }
+    }
+
+    Pipeline(const Pipeline&) = delete;
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    template <typename T>
+    Channel<T>& channel(size_t capacity) {
+        auto owned = std::make_unique<Channel<T>>(capacity, scheduler);
+        Channel<T>& result = *owned;
+        std::lock_guard<std::mutex> lock(mutex);
+        channels.push_back(std::move(owned));
+        return result;
+    }
+
+    // Starts body() as a stage; body must be a coroutine returning StageTask.
+    // The callable is kept alive by the pipeline, so its captures may be used
+    // across suspensions.
+    template <typename F>
+    void stage(F&& body) {
+        auto holder = std::make_unique<Holder<std::decay_t<F>>>(std::forward<F>(body));
+        StageTask task = holder->body();
+        auto handle = std::exchange(task.handle, {});
+        handle.promise().owner = this;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            bodies.push_back(std::move(holder));
+        }
+        pending.fetch_add(1, std::memory_order_relaxed);
+        scheduler.submit([handle] { handle.resume(); });
+    }
+
+    // Pushes every element of the generator into out, then closes out.
+    template <typename T>
+    void produce(Generator<T> source, Channel<std::remove_cvref_t<T>>& out) {
+        stage([source = std::move(source), &out]() mutable -> StageTask {
+            for (auto& value : source)
+                if (!co_await out.push(std::move(value)))
+                    break;
+            out.close();
+        });
+    }
+
+    // Moves fn(value) from in to out on `workers` concurrent stages; with more
+    // than one worker the output order is not preserved. out is closed once
+    // in is drained.
+    template <typename In, typename Out, typename F>
+    void transform(Channel<In>& in, Channel<Out>& out, F fn, size_t workers = 1) {
+        auto left = std::make_shared<std::atomic<size_t>>(std::max<size_t>(workers, 1));
+        for (size_t w = 0; w < std::max<size_t>(workers, 1); ++w)
+            stage([&in, &out, fn, left]() -> StageTask {
+                while (auto value = co_await in.pop())
+                    if (!co_await out.push(fn(std::move(*value))))
+                        break;
+                if (left->fetch_sub(1) == 1)
+                    out.close();
+            });
+    }
+
+    // Passes on the values for which keep(value) is true.
+    template <typename T, typename F>
+    void filter(Channel<T>& in, Channel<T>& out, F keep) {
+        stage([&in, &out, keep]() -> StageTask {
+            while (auto value = co_await in.pop())
+                if (keep(*value) && !co_await out.push(std::move(*value)))
+                    break;
+            out.close();
+        });
+    }
+
+    // Calls sink(value) for every value of in, one at a time.
+    template <typename T, typename F>
+    void consume(Channel<T>& in, F sink) {
+        stage([&in, sink]() mutable -> StageTask {
+            while (auto value = co_await in.pop())
+                sink(std::move(*value));
+        });
+    }
+
+    // Returns once every stage finished, running queued tasks meanwhile.
+    void wait() {
+        drain();
+        std::lock_guard<std::mutex> lock(mutex);
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+    }
+
+private:
+    friend class StageTask;
+
+    struct HolderBase {
+        virtual ~HolderBase() = default;
+    };
+
+    template <typename F>
+    struct Holder : HolderBase {
+        explicit Holder(F body) : body(std::move(body)) {}
+        F body;
+    };
+
+    void drain() {
+        while (pending.load(std::memory_order_acquire))
+            if (!scheduler.runOne())
+                std::this_thread::yield();
+    }
+
+    void finished() {
+        pending.fetch_sub(1, std::memory_order_release);
+    }
+
+    void fail(std::exception_ptr e) {
+        std::vector<ChannelBase*> toClose;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (e && !error)
+                error = e;
+            for (auto& c : channels)
+                toClose.push_back(c.get());
+        }
+        for (ChannelBase* c : toClose)
+            c->close();
+    }
+
+    TaskScheduler& scheduler;
+    std::atomic<size_t> pending{0};
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ChannelBase>> channels;
+    std::vector<std::unique_ptr<HolderBase>> bodies;
+    std::exception_ptr error;
+};
+
+inline void StageTask::promise_type::Finish::await_suspend(std::coroutine_handle<promise_type> handle) noexcept {
+    Pipeline* owner = handle.promise().owner;
+    handle.destroy();
+    owner->finished();
+}
+
+inline void StageTask::promise_type::unhandled_exception() {
+    owner->fail(std::current_exception());
+}
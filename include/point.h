@@ -1,37 +1,107 @@
-#pragma once
-
-#include <type_traits>
-#include <concepts>
-#include <iostream>
-
-template <typename T>
-concept Scalar = std::is_scalar_v<T>;
-
-template <Scalar T>
-class Point {
-public:
-    T _x{}, _y{};
-
-    Point() = default;
-    Point(T x, T y) : _x(x), _y(y) {}
-    Point(const Point& other) = default;
-    Point(Point&& other) noexcept = default;
-
-    Point& operator=(const Point& other) = default;
-    Point& operator=(Point&& other) noexcept = default;
-
-    bool operator==(const Point& other) const {
-        return _x == other._x && _y == other._y;
-    }
-
-    T x() const { return _x; }
-    T y() const { return _y; }
-    
-    friend std::ostream& operator<<(std::ostream& os, const Point& p) {
-        return os << "(" << p.x() << ", " << p.y() << ")";
-    }
-
-    friend std::istream& operator>>(std::istream& is, Point& p) {
-        return is >> p._x >> p._y;
-    }
-};
\ No newline at end of file
+#pragma once
+
+#include <type_traits>
+#include <concepts>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+
+template <typename T>
+concept Scalar = std::is_scalar_v<T>;
+
+template <Scalar T>
+class Point {
+public:
+    T _x{}, _y{};
+
+    constexpr Point() = default;
+    constexpr Point(T x, T y) : _x(x), _y(y) {}
+    Point(const Point& other) = default;
+    Point(Point&& other) noexcept = default;
+
+    // Widening for predicates whose products would overflow or round in T.
+    template <Scalar U>
+    constexpr explicit Point(const Point<U>& other) : _x(static_cast<T>(other.x())), _y(static_cast<T>(other.y())) {}
+
+    Point& operator=(const Point& other) = default;
+    Point& operator=(Point&& other) noexcept = default;
+
+    constexpr bool operator==(const Point& other) const {
+        return _x == other._x && _y == other._y;
+    }
+
+    constexpr T x() const { return _x; }
+    constexpr T y() const { return _y; }
+
+    constexpr Point operator+(const Point& other) const { return Point(_x + other._x, _y + other._y); }
+    constexpr Point operator-(const Point& other) const { return Point(_x - other._x, _y - other._y); }
+    constexpr Point operator-() const { return Point(-_x, -_y); }
+    constexpr Point operator*(T k) const { return Point(_x * k, _y * k); }
+    constexpr Point operator/(T k) const { return Point(_x / k, _y / k); }
+
+    friend constexpr Point operator*(T k, const Point& p) { return p * k; }
+
+    constexpr Point& operator+=(const Point& other) { _x += other._x; _y += other._y; return *this; }
+    constexpr Point& operator-=(const Point& other) { _x -= other._x; _y -= other._y; return *this; }
+    constexpr Point& operator*=(T k) { _x *= k; _y *= k; return *this; }
+
+    constexpr T dot(const Point& other) const { return _x * other._x + _y * other._y; }
+    constexpr T cross(const Point& other) const { return _x * other._y - _y * other._x; }
+    constexpr T length2() const { return dot(*this); }
+
+    // Rotated by 90 degrees counter-clockwise.
+    constexpr Point perp() const { return Point(-_y, _x); }
+
+    friend std::ostream& operator<<(std::ostream& os, const Point& p) {
+        return os << "(" << p.x() << ", " << p.y() << ")";
+    }
+
+    friend std::istream& operator>>(std::istream& is, Point& p) {
+        return is >> p._x >> p._y;
+    }
+};
+
+// Batch operations over contiguous points. Point<T> is two packed T values, so
+// these plain indexed loops vectorize.
+
+template <Scalar T>
+constexpr Point<T> sumPoints(std::span<const Point<T>> points) {
+    T sumX{0}, sumY{0};
+    for (size_t i = 0; i < points.size(); ++i) {
+        sumX += points[i]._x;
+        sumY += points[i]._y;
+    }
+    return Point<T>(sumX, sumY);
+}
+
+template <Scalar T>
+constexpr void translatePoints(std::span<Point<T>> points, const Point<T>& offset) {
+    for (size_t i = 0; i < points.size(); ++i) {
+        points[i]._x += offset._x;
+        points[i]._y += offset._y;
+    }
+}
+
+template <Scalar T>
+constexpr void scalePoints(std::span<Point<T>> points, T factor) {
+    for (size_t i = 0; i < points.size(); ++i) {
+        points[i]._x *= factor;
+        points[i]._y *= factor;
+    }
+}
+
+template <Scalar T>
+constexpr void dotPoints(std::span<const Point<T>> a, std::span<const Point<T>> b, std::span<T> out) {
+    if (a.size() != b.size() || out.size() < a.size())
+        throw std::invalid_argument("Point spans must have matching sizes");
+    for (size_t i = 0; i < a.size(); ++i)
+        out[i] = a[i]._x * b[i]._x + a[i]._y * b[i]._y;
+}
+
+template <Scalar T>
+constexpr void crossPoints(std::span<const Point<T>> a, std::span<const Point<T>> b, std::span<T> out) {
+    if (a.size() != b.size() || out.size() < a.size())
+        throw std::invalid_argument("Point spans must have matching sizes");
+    for (size_t i = 0; i < a.size(); ++i)
+        out[i] = a[i]._x * b[i]._y - a[i]._y * b[i]._x;
+}
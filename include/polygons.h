@@ -0,0 +1,82 @@
+#pragma once
+
+#include "array.h"
+
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Flat copy of the vertices of a figure collection: one pass of virtual calls
+// up front, then plain arrays for the geometry kernels.
+class Polygons {
+public:
+    Polygons() = default;
+
+    template <FigureContainer C>
+    explicit Polygons(const C& figures) {
+        size_t n = figures.getSize();
+        offsets.reserve(n + 1);
+        boxes.reserve(n);
+
+        for (size_t i = 0; i < n; ++i) {
+            const auto& fig = asFigure(figures[i]);
+            Box<double> box;
+            for (size_t v = 0; v < fig.vertexCount(); ++v) {
+                auto p = fig.vertex(v);
+                xs.push_back(p.x());
+                ys.push_back(p.y());
+                box.expand(Point<double>(p.x(), p.y()));
+            }
+            offsets.push_back(xs.size());
+            boxes.push_back(box);
+        }
+    }
+
+    size_t size() const {
+        return boxes.size();
+    }
+
+    size_t vertexCount(size_t polygon) const {
+        return offsets[polygon + 1] - offsets[polygon];
+    }
+
+    std::span<const double> xsOf(size_t polygon) const {
+        return std::span<const double>(xs).subspan(offsets[polygon], vertexCount(polygon));
+    }
+
+    std::span<const double> ysOf(size_t polygon) const {
+        return std::span<const double>(ys).subspan(offsets[polygon], vertexCount(polygon));
+    }
+
+    const Box<double>& bounds(size_t polygon) const {
+        return boxes[polygon];
+    }
+
+    // In-place pass over the vertex columns. Shears and non-uniform scales are
+    // fine here, reflections are not: they would turn the vertex order clockwise.
+    void transform(const Affine2<double>& m) {
+        if (m.a * m.d - m.b * m.c <= 0)
+            throw std::invalid_argument("Transform must preserve orientation");
+
+        double* x = xs.data();
+        double* y = ys.data();
+        for (size_t i = 0; i < xs.size(); ++i) {
+            double nx = m.a * x[i] + m.b * y[i] + m.tx;
+            double ny = m.c * x[i] + m.d * y[i] + m.ty;
+            x[i] = nx;
+            y[i] = ny;
+        }
+
+        for (size_t p = 0; p < boxes.size(); ++p) {
+            Box<double> box;
+            for (size_t v = offsets[p]; v < offsets[p + 1]; ++v)
+                box.expand(Point<double>(xs[v], ys[v]));
+            boxes[p] = box;
+        }
+    }
+
+private:
+    std::vector<double> xs, ys;
+    std::vector<size_t> offsets{0};
+    std::vector<Box<double>> boxes;
+};
@@ -0,0 +1,254 @@
+#pragma once
+
+#include "array.h"
+#include "scheduler.h"
+#include "transform.h"
+#include "typed_store.h"
+
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Lazy query over a figure collection, e.g.
+//
+//   query(figures).ofType<Octagon>().where(FigureField::area > 2.0)
+//                 .select(FigureField::center).sum();
+//
+// ofType/where/select only compose functions; the terminal operation (count,
+// sum, reduce, forEach, toVector) runs them in one pass with no temporary
+// collections. A source is scanned segment by segment (one segment for an
+// Array, one per type for a TypedFigureStore); a segment whose element type
+// can never match ofType is skipped at compile time, and one whose type
+// always matches is scanned without a dynamic_cast. After parallel(), count,
+// sum and reduce split every segment into chunks on the task scheduler.
+
+template <typename Getter>
+struct QueryField {
+    Getter get;
+
+    template <typename Fig>
+    auto operator()(const Fig& fig) const {
+        return get(fig);
+    }
+
+    template <typename V>
+    auto operator<(V value) const {
+        return [get = get, value](const auto& fig) { return get(fig) < value; };
+    }
+
+    template <typename V>
+    auto operator<=(V value) const {
+        return [get = get, value](const auto& fig) { return get(fig) <= value; };
+    }
+
+    template <typename V>
+    auto operator>(V value) const {
+        return [get = get, value](const auto& fig) { return get(fig) > value; };
+    }
+
+    template <typename V>
+    auto operator>=(V value) const {
+        return [get = get, value](const auto& fig) { return get(fig) >= value; };
+    }
+
+    template <typename V>
+    auto operator==(V value) const {
+        return [get = get, value](const auto& fig) { return get(fig) == value; };
+    }
+};
+
+struct FigureField {
+    struct AreaGetter {
+        template <typename Fig>
+        double operator()(const Fig& fig) const {
+            return static_cast<double>(fig);
+        }
+    };
+
+    struct CenterGetter {
+        template <typename Fig>
+        auto operator()(const Fig& fig) const {
+            return fig.center();
+        }
+    };
+
+    struct BoundsGetter {
+        template <typename Fig>
+        auto operator()(const Fig& fig) const {
+            return fig.bounds();
+        }
+    };
+
+    struct VertexCountGetter {
+        template <typename Fig>
+        size_t operator()(const Fig& fig) const {
+            return fig.vertexCount();
+        }
+    };
+
+    static constexpr QueryField<AreaGetter> area{};
+    static constexpr QueryField<CenterGetter> center{};
+    static constexpr QueryField<BoundsGetter> bounds{};
+    static constexpr QueryField<VertexCountGetter> vertexCount{};
+};
+
+struct QueryAll {
+    template <typename Fig>
+    bool operator()(const Fig&) const {
+        return true;
+    }
+};
+
+struct QueryIdentity {
+    template <typename Fig>
+    const Fig& operator()(const Fig& fig) const {
+        return fig;
+    }
+};
+
+template <FigureContainer C>
+auto querySegments(const C& figures) {
+    return std::tie(figures);
+}
+
+template <Scalar T>
+auto querySegments(const TypedFigureStore<T>& store) {
+    return store.segments();
+}
+
+template <typename Source, typename Fig, typename Pred, typename Proj>
+class Query {
+public:
+    using ScalarType = FigureScalar<Fig>;
+
+    Query(const Source& source, Pred pred, Proj proj, TaskScheduler* scheduler)
+        : source(source), pred(std::move(pred)), proj(std::move(proj)), scheduler(scheduler) {}
+
+    template <template <typename> class Shape>
+    auto ofType() const {
+        return Query<Source, Shape<ScalarType>, Pred, Proj>(source, pred, proj, scheduler);
+    }
+
+    template <typename P>
+    auto where(P p) const {
+        auto both = [first = pred, second = std::move(p)](const auto& fig) { return first(fig) && second(fig); };
+        return Query<Source, Fig, decltype(both), Proj>(source, std::move(both), proj, scheduler);
+    }
+
+    template <typename P>
+    auto select(P p) const {
+        return Query<Source, Fig, Pred, P>(source, pred, std::move(p), scheduler);
+    }
+
+    Query parallel(TaskScheduler& on = TaskScheduler::global()) const {
+        return Query(source, pred, proj, &on);
+    }
+
+    // Folds every selected value into init with op(accumulator, value); op
+    // also combines the partial results of parallel chunks.
+    template <typename V, typename Op>
+    V reduce(V init, Op op) const {
+        V result = init;
+        std::apply([&](const auto&... segments) {
+            ((result = op(std::move(result), reduceSegment(segments, init, op))), ...);
+        }, querySegments(source));
+        return result;
+    }
+
+    auto sum() const {
+        using V = std::remove_cvref_t<decltype(proj(std::declval<const Fig&>()))>;
+        return reduce(V{}, [](V a, const V& b) { return a + b; });
+    }
+
+    size_t count() const {
+        return Query<Source, Fig, Pred, QueryCountOne>(source, pred, QueryCountOne{}, scheduler).sum();
+    }
+
+    // Visits the selected values serially, in collection order.
+    template <typename F>
+    void forEach(F&& visit) const {
+        std::apply([&](const auto&... segments) {
+            (scanSegment(segments, 0, segments.getSize(), [&](const Fig& fig) { visit(proj(fig)); }), ...);
+        }, querySegments(source));
+    }
+
+    auto toVector() const {
+        std::vector<std::remove_cvref_t<decltype(proj(std::declval<const Fig&>()))>> out;
+        forEach([&](auto&& value) { out.push_back(std::forward<decltype(value)>(value)); });
+        return out;
+    }
+
+private:
+    struct QueryCountOne {
+        template <typename F>
+        size_t operator()(const F&) const {
+            return 1;
+        }
+    };
+
+    template <typename, typename, typename, typename>
+    friend class Query;
+
+    // Calls visit(fig) for the matching figures of segment[begin, end).
+    template <typename Segment, typename F>
+    void scanSegment(const Segment& segment, size_t begin, size_t end, F&& visit) const {
+        using Stored = std::remove_cvref_t<decltype(asFigure(segment[0]))>;
+
+        auto at = [&](size_t i) -> decltype(auto) {
+            if constexpr (requires { segment.data(); })
+                return asFigure(segment.data()[i]);
+            else
+                return asFigure(segment[i]);
+        };
+
+        if constexpr (std::is_base_of_v<Fig, Stored>) {
+            for (size_t i = begin; i < end; ++i) {
+                const Fig& fig = at(i);
+                if (pred(fig))
+                    visit(fig);
+            }
+        } else if constexpr (std::is_base_of_v<Stored, Fig>) {
+            for (size_t i = begin; i < end; ++i) {
+                const Fig* fig = dynamic_cast<const Fig*>(&at(i));
+                if (fig && pred(*fig))
+                    visit(*fig);
+            }
+        }
+    }
+
+    template <typename Segment, typename V, typename Op>
+    V reduceSegment(const Segment& segment, const V& init, Op& op) const {
+        using Stored = std::remove_cvref_t<decltype(asFigure(segment[0]))>;
+        if constexpr (!std::is_base_of_v<Fig, Stored> && !std::is_base_of_v<Stored, Fig>) {
+            return init;
+        } else {
+            auto chunk = [&](size_t begin, size_t end) {
+                V acc = init;
+                scanSegment(segment, begin, end, [&](const Fig& fig) { acc = op(std::move(acc), proj(fig)); });
+                return acc;
+            };
+
+            size_t n = segment.getSize();
+            if (!scheduler)
+                return chunk(0, n);
+            return scheduler->parallelReduce(size_t(0), n, init, chunk, op);
+        }
+    }
+
+    const Source& source;
+    Pred pred;
+    Proj proj;
+    TaskScheduler* scheduler;
+};
+
+template <FigureContainer C>
+auto query(const C& figures) {
+    using Fig = Figure<FigureScalar<std::remove_cvref_t<decltype(figures[0])>>>;
+    return Query<C, Fig, QueryAll, QueryIdentity>(figures, QueryAll{}, QueryIdentity{}, nullptr);
+}
+
+template <Scalar T>
+auto query(const TypedFigureStore<T>& store) {
+    return Query<TypedFigureStore<T>, Figure<T>, QueryAll, QueryIdentity>(store, QueryAll{}, QueryIdentity{}, nullptr);
+}
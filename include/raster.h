@@ -0,0 +1,219 @@
+#pragma once
+
+#include "polygons.h"
+#include "scheduler.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Caller-owned 8-bit raster. Cell (col, row) covers
+// [originX + col * cellSize, +cellSize) x [originY + row * cellSize, +cellSize)
+// and is stored at cells[row * stride + col].
+struct RasterGrid {
+    uint8_t* cells;
+    size_t width, height, stride;
+    double originX, originY, cellSize;
+};
+
+enum class RasterMode {
+    Occupancy,  // 1 where the cell center is inside some figure
+    Coverage    // 0..255 share of 4x4 subsamples covered by the union of figures
+};
+
+// Rasterizes convex CCW polygons tile by tile. Figures are binned into 64x64
+// tiles by bounding box, tiles are taken by worker threads from a shared
+// counter, and each polygon row becomes one span bounded by its edge functions.
+class Rasterizer {
+public:
+    static constexpr size_t tileSize = 64;
+    static constexpr int subsamples = 4;
+
+    static void rasterize(const Polygons& polys, RasterGrid& grid, RasterMode mode,
+                          size_t threads = std::thread::hardware_concurrency()) {
+        if (!grid.cells || grid.stride < grid.width || grid.cellSize <= 0)
+            throw std::invalid_argument("Invalid raster grid");
+
+        size_t tilesX = (grid.width + tileSize - 1) / tileSize;
+        size_t tilesY = (grid.height + tileSize - 1) / tileSize;
+        std::vector<std::vector<uint32_t>> bins(tilesX * tilesY);
+        if (bins.empty())
+            return;
+
+        for (size_t p = 0; p < polys.size(); ++p) {
+            const Box<double>& box = polys.bounds(p);
+            long c0, r0, c1, r1;
+            if (!cellRange(grid, box, c0, r0, c1, r1))
+                continue;
+            for (long ty = r0 / long(tileSize); ty <= r1 / long(tileSize); ++ty)
+                for (long tx = c0 / long(tileSize); tx <= c1 / long(tileSize); ++tx)
+                    bins[ty * tilesX + tx].push_back(static_cast<uint32_t>(p));
+        }
+
+        std::atomic<size_t> nextTile{0};
+        auto worker = [&] {
+            std::vector<uint16_t> masks;
+            for (size_t t = nextTile++; t < bins.size(); t = nextTile++) {
+                size_t col0 = (t % tilesX) * tileSize, row0 = (t / tilesX) * tileSize;
+                size_t col1 = std::min(col0 + tileSize, grid.width);
+                size_t row1 = std::min(row0 + tileSize, grid.height);
+
+                if (mode == RasterMode::Occupancy)
+                    fillOccupancy(polys, bins[t], grid, col0, row0, col1, row1);
+                else
+                    fillCoverage(polys, bins[t], grid, col0, row0, col1, row1, masks);
+            }
+        };
+
+        threads = std::clamp<size_t>(threads, 1, bins.size());
+        TaskScheduler::global().forEachChunk(threads, threads, [&](size_t, size_t, size_t) { worker(); });
+    }
+
+private:
+    static bool cellRange(const RasterGrid& grid, const Box<double>& box,
+                          long& c0, long& r0, long& c1, long& r1) {
+        c0 = std::max(0L, cellOf(box.minX, grid.originX, grid.cellSize, grid.width));
+        r0 = std::max(0L, cellOf(box.minY, grid.originY, grid.cellSize, grid.height));
+        c1 = std::min(long(grid.width) - 1, cellOf(box.maxX, grid.originX, grid.cellSize, grid.width));
+        r1 = std::min(long(grid.height) - 1, cellOf(box.maxY, grid.originY, grid.cellSize, grid.height));
+        return c0 <= c1 && r0 <= r1;
+    }
+
+    // Cell of coordinate v, clamped to [-1, count] while still a double so
+    // boxes far off the grid (or NaN) never reach an out-of-range conversion.
+    static long cellOf(double v, double origin, double cellSize, size_t count) {
+        double cell = std::floor((v - origin) / cellSize);
+        return cell >= 0 ? long(std::min(cell, double(count))) : -1L;
+    }
+
+    // Rows of [row0, row1) that the polygon's bounding box touches.
+    static void rowsOf(const RasterGrid& grid, const Box<double>& box, size_t row0, size_t row1,
+                       size_t& first, size_t& last) {
+        double lo = std::floor((box.minY - grid.originY) / grid.cellSize);
+        double hi = std::floor((box.maxY - grid.originY) / grid.cellSize) + 1;
+        first = size_t(std::clamp(lo, double(row0), double(row1)));
+        last = size_t(std::clamp(hi, double(row0), double(row1)));
+    }
+
+    // x-interval of the polygon on the horizontal line y, from the half-planes
+    // a*x + b*y + c >= 0 of its edges; false if the line misses it.
+    static bool span(const Polygons& polys, size_t p, double y, double& xl, double& xr) {
+        auto xs = polys.xsOf(p), ys = polys.ysOf(p);
+        xr = std::numeric_limits<double>::infinity();
+        xl = -xr;
+
+        for (size_t i = 0; i < xs.size(); ++i) {
+            size_t j = (i + 1) % xs.size();
+            double a = -(ys[j] - ys[i]);
+            double b = xs[j] - xs[i];
+            double rest = b * (y - ys[i]) - a * xs[i];
+
+            if (a > 0)
+                xl = std::max(xl, -rest / a);
+            else if (a < 0)
+                xr = std::min(xr, -rest / a);
+            else if (rest < 0)
+                return false;
+        }
+        return xl <= xr;
+    }
+
+    static void fillOccupancy(const Polygons& polys, const std::vector<uint32_t>& bin, RasterGrid& grid,
+                              size_t col0, size_t row0, size_t col1, size_t row1) {
+        for (uint32_t p : bin) {
+            size_t first, last;
+            rowsOf(grid, polys.bounds(p), row0, row1, first, last);
+
+            for (size_t row = first; row < last; ++row) {
+                double y = grid.originY + (row + 0.5) * grid.cellSize;
+                double xl, xr;
+                if (!span(polys, p, y, xl, xr))
+                    continue;
+
+                long c0 = long(std::clamp(std::ceil((xl - grid.originX) / grid.cellSize - 0.5),
+                                          double(col0), double(col1)));
+                long c1 = long(std::clamp(std::floor((xr - grid.originX) / grid.cellSize - 0.5),
+                                          double(col0) - 1, double(col1) - 1));
+                if (c0 > c1)
+                    continue;
+
+                uint8_t* rowCells = grid.cells + row * grid.stride;
+                std::fill(rowCells + c0, rowCells + c1 + 1, uint8_t{1});
+            }
+        }
+    }
+
+    // Accumulates a 16-bit subsample mask per cell (bit = subRow * 4 + subCol),
+    // so overlapping figures are unioned exactly at subsample resolution.
+    static void fillCoverage(const Polygons& polys, const std::vector<uint32_t>& bin, RasterGrid& grid,
+                             size_t col0, size_t row0, size_t col1, size_t row1,
+                             std::vector<uint16_t>& masks) {
+        if (bin.empty())
+            return;
+
+        size_t tileWidth = col1 - col0;
+        masks.assign(tileWidth * (row1 - row0), 0);
+        double sub = grid.cellSize / subsamples;
+
+        for (uint32_t p : bin) {
+            size_t first, last;
+            rowsOf(grid, polys.bounds(p), row0, row1, first, last);
+
+            for (size_t row = first; row < last; ++row) {
+                uint16_t* rowMasks = &masks[(row - row0) * tileWidth];
+
+                for (int subRow = 0; subRow < subsamples; ++subRow) {
+                    double y = grid.originY + row * grid.cellSize + (subRow + 0.5) * sub;
+                    double xl, xr;
+                    if (!span(polys, p, y, xl, xr))
+                        continue;
+
+                    long lo = long(col0) * subsamples, hi = long(col1) * subsamples - 1;
+                    long s0 = long(std::clamp(std::ceil((xl - grid.originX) / sub - 0.5), double(lo), double(hi + 1)));
+                    long s1 = long(std::clamp(std::floor((xr - grid.originX) / sub - 0.5), double(lo - 1), double(hi)));
+                    if (s0 > s1)
+                        continue;
+
+                    long c0 = s0 / subsamples, c1 = s1 / subsamples;
+                    uint16_t full = uint16_t(0xF << (subRow * subsamples));
+
+                    auto partial = [&](long cell) {
+                        long from = std::max(s0, cell * subsamples) - cell * subsamples;
+                        long to = std::min(s1, cell * subsamples + subsamples - 1) - cell * subsamples;
+                        uint16_t bits = uint16_t(((1u << (to - from + 1)) - 1) << from);
+                        rowMasks[cell - col0] |= uint16_t(bits << (subRow * subsamples));
+                    };
+
+                    partial(c0);
+                    if (c1 > c0) {
+                        for (long cell = c0 + 1; cell < c1; ++cell)
+                            rowMasks[cell - col0] |= full;
+                        partial(c1);
+                    }
+                }
+            }
+        }
+
+        for (size_t row = row0; row < row1; ++row) {
+            const uint16_t* rowMasks = &masks[(row - row0) * tileWidth];
+            uint8_t* rowCells = grid.cells + row * grid.stride;
+            for (size_t col = col0; col < col1; ++col) {
+                int covered = std::popcount(rowMasks[col - col0]);
+                uint8_t value = uint8_t((covered * 255 + 8) / 16);
+                rowCells[col] = std::max(rowCells[col], value);
+            }
+        }
+    }
+};
+
+template <FigureContainer C>
+void rasterize(const C& figures, RasterGrid& grid, RasterMode mode,
+               size_t threads = std::thread::hardware_concurrency()) {
+    Rasterizer::rasterize(Polygons(figures), grid, mode, threads);
+}
@@ -0,0 +1,279 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Work-stealing thread pool. Every worker owns a deque: tasks submitted from
+// a worker go to the back of its own deque and it pops from the back (newest
+// first, cache-warm), while idle workers steal from the front of other
+// deques (oldest first, usually the biggest pieces of a split range). Tasks
+// submitted from other threads are spread over the deques round-robin.
+// Threads waiting on a TaskGroup run queued tasks instead of blocking, so
+// nested parallel calls cannot deadlock the pool.
+class TaskScheduler {
+public:
+    using Task = std::function<void()>;
+
+    explicit TaskScheduler(size_t workers = std::max<size_t>(std::thread::hardware_concurrency(), 1))
+        : queues(std::max<size_t>(workers, 1)) {
+        for (size_t i = 0; i < queues.size(); ++i)
+            threads.emplace_back([this, i] { workerLoop(i); });
+    }
+
+    ~TaskScheduler() {
+        {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& t : threads)
+            t.join();
+    }
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    // Shared pool with one worker per hardware thread.
+    static TaskScheduler& global() {
+        static TaskScheduler scheduler;
+        return scheduler;
+    }
+
+    size_t workerCount() const {
+        return queues.size();
+    }
+
+    void submit(Task task) {
+        size_t target = (current.owner == this) ? current.index : nextQueue++ % queues.size();
+        {
+            std::lock_guard<std::mutex> lock(queues[target].mutex);
+            queues[target].tasks.push_back(std::move(task));
+        }
+        queued.fetch_add(1);
+        if (sleeping.load()) {
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            wake.notify_one();
+        }
+    }
+
+    // Runs one queued task on the calling thread; false when there was none.
+    bool runOne() {
+        Task task;
+        if (!take(task))
+            return false;
+        task();
+        return true;
+    }
+
+    // Calls body(chunkBegin, chunkEnd) over [begin, end). The range is split in
+    // halves down to `grain` elements, one half becoming a stealable task;
+    // grain 0 picks about eight chunks per worker, and a range no larger than
+    // the grain runs inline without touching the pool.
+    template <typename F>
+    void parallelFor(size_t begin, size_t end, F&& body, size_t grain = 0);
+
+    // Maps every chunk with map(chunkBegin, chunkEnd) and folds the partial
+    // results left to right with combine, so the result only depends on the grain.
+    template <typename T, typename M, typename C>
+    T parallelReduce(size_t begin, size_t end, T identity, M&& map, C&& combine, size_t grain = 0);
+
+    // Splits [0, count) into `parts` even chunks and runs work(begin, end, part)
+    // for each of them as a task.
+    template <typename F>
+    void forEachChunk(size_t count, size_t parts, F&& work);
+
+    size_t defaultGrain(size_t count) const {
+        return std::max<size_t>(1, count / (8 * workerCount()));
+    }
+
+private:
+    struct alignas(64) Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct WorkerSlot {
+        TaskScheduler* owner;
+        size_t index;
+    };
+
+    bool take(Task& task) {
+        size_t n = queues.size();
+        bool worker = current.owner == this;
+
+        if (worker) {
+            Queue& own = queues[current.index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.tasks.empty()) {
+                task = std::move(own.tasks.back());
+                own.tasks.pop_back();
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+
+        size_t start = worker ? current.index + 1 : victim++;
+        for (size_t k = 0; k < n; ++k) {
+            Queue& other = queues[(start + k) % n];
+            std::lock_guard<std::mutex> lock(other.mutex);
+            if (!other.tasks.empty()) {
+                task = std::move(other.tasks.front());
+                other.tasks.pop_front();
+                queued.fetch_sub(1);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void workerLoop(size_t index) {
+        current = WorkerSlot{this, index};
+        while (true) {
+            if (runOne())
+                continue;
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            ++sleeping;
+            wake.wait(lock, [this] { return stopping || queued.load() > 0; });
+            --sleeping;
+            if (stopping && !queued.load())
+                return;
+        }
+    }
+
+    static inline thread_local WorkerSlot current{};
+    static inline thread_local size_t victim = 0;
+
+    std::vector<Queue> queues;
+    std::vector<std::thread> threads;
+    std::atomic<size_t> queued{0};
+    std::atomic<size_t> nextQueue{0};
+    std::atomic<size_t> sleeping{0};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
+    bool stopping = false;
+};
+
+// Fork/join: run() hands tasks to the scheduler, wait() returns once all of
+// them finished, helping to execute queued tasks meanwhile, and rethrows the
+// first exception a task threw.
+class TaskGroup {
+public:
+    explicit TaskGroup(TaskScheduler& scheduler = TaskScheduler::global()) : scheduler(scheduler) {}
+
+    ~TaskGroup() {
+        while (pending.load(std::memory_order_acquire))
+            if (!scheduler.runOne())
+                std::this_thread::yield();
+    }
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename F>
+    void run(F&& work) {
+        pending.fetch_add(1, std::memory_order_relaxed);
+        scheduler.submit([this, work = std::forward<F>(work)]() mutable {
+            {
+                auto task = std::move(work);
+                try {
+                    task();
+                } catch (...) {
+                    std::lock_guard<std::mutex> lock(errorMutex);
+                    if (!error)
+                        error = std::current_exception();
+                }
+            }
+            pending.fetch_sub(1, std::memory_order_release);
+        });
+    }
+
+    void wait() {
+        while (pending.load(std::memory_order_acquire))
+            if (!scheduler.runOne())
+                std::this_thread::yield();
+
+        std::lock_guard<std::mutex> lock(errorMutex);
+        if (error)
+            std::rethrow_exception(std::exchange(error, nullptr));
+    }
+
+private:
+    TaskScheduler& scheduler;
+    std::atomic<size_t> pending{0};
+    std::mutex errorMutex;
+    std::exception_ptr error;
+};
+
+template <typename F>
+void TaskScheduler::parallelFor(size_t begin, size_t end, F&& body, size_t grain) {
+    if (begin >= end)
+        return;
+    if (!grain)
+        grain = defaultGrain(end - begin);
+    if (end - begin <= grain) {
+        body(begin, end);
+        return;
+    }
+
+    // Declared before the group so that it outlives the tasks referring to it.
+    std::function<void(size_t, size_t)> split;
+    TaskGroup group(*this);
+    split = [&](size_t b, size_t e) {
+        while (e - b > grain) {
+            size_t mid = b + (e - b) / 2;
+            group.run([&split, mid, e] { split(mid, e); });
+            e = mid;
+        }
+        body(b, e);
+    };
+    split(begin, end);
+    group.wait();
+}
+
+template <typename T, typename M, typename C>
+T TaskScheduler::parallelReduce(size_t begin, size_t end, T identity, M&& map, C&& combine, size_t grain) {
+    if (begin >= end)
+        return identity;
+    if (!grain)
+        grain = defaultGrain(end - begin);
+
+    size_t chunks = (end - begin + grain - 1) / grain;
+    std::vector<T> partial(chunks, identity);
+    parallelFor(0, chunks, [&](size_t c0, size_t c1) {
+        for (size_t c = c0; c < c1; ++c)
+            partial[c] = map(begin + c * grain, std::min(begin + (c + 1) * grain, end));
+    }, 1);
+
+    T result = identity;
+    for (auto& value : partial)
+        result = combine(std::move(result), std::move(value));
+    return result;
+}
+
+template <typename F>
+void TaskScheduler::forEachChunk(size_t count, size_t parts, F&& work) {
+    parts = std::clamp<size_t>(parts, 1, std::max<size_t>(count, 1));
+    if (parts == 1) {
+        work(size_t(0), count, size_t(0));
+        return;
+    }
+
+    size_t chunk = (count + parts - 1) / parts;
+    TaskGroup group(*this);
+    for (size_t part = 1; part < parts; ++part)
+        group.run([&work, part, chunk, count] {
+            work(std::min(part * chunk, count), std::min((part + 1) * chunk, count), part);
+        });
+    work(size_t(0), std::min(chunk, count), size_t(0));
+    group.wait();
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include "array.h"
+#include "segments.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Array built from blocks of 64, 128, 256, ... elements. Growing allocates
+// one more block and never moves existing elements, so add() has no copy
+// spike and references from operator[] stay valid across add(). Indexing
+// goes through the block table in O(1); iteration and forEachBlock() walk
+// one contiguous block at a time.
+template <typename T>
+class SegmentedArray {
+    using Segments = GeometricSegments<6>;
+
+    template <bool Const>
+    class BasicIterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = std::conditional_t<Const, const T*, T*>;
+        using reference = std::conditional_t<Const, const T&, T&>;
+
+        BasicIterator() = default;
+
+        BasicIterator(const SegmentedArray* owner, size_t index) : owner(owner), index(index) {
+            if (index < owner->size) {
+                segment = Segments::segmentOf(index);
+                ptr = owner->blocks[segment] + Segments::offsetOf(index);
+                blockEnd = owner->blocks[segment] + Segments::capacity(segment);
+            }
+        }
+
+        reference operator*() const {
+            return *ptr;
+        }
+
+        pointer operator->() const {
+            return ptr;
+        }
+
+        BasicIterator& operator++() {
+            ++index;
+            if (++ptr == blockEnd && index < owner->size) {
+                ++segment;
+                ptr = owner->blocks[segment];
+                blockEnd = ptr + Segments::capacity(segment);
+            }
+            return *this;
+        }
+
+        BasicIterator operator++(int) {
+            BasicIterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        bool operator==(const BasicIterator& other) const {
+            return index == other.index;
+        }
+
+    private:
+        const SegmentedArray* owner = nullptr;
+        size_t index = 0;
+        size_t segment = 0;
+        T* ptr = nullptr;
+        T* blockEnd = nullptr;
+    };
+
+public:
+    using iterator = BasicIterator<false>;
+    using const_iterator = BasicIterator<true>;
+
+    SegmentedArray() = default;
+
+    ~SegmentedArray() {
+        clear();
+    }
+
+    SegmentedArray(const SegmentedArray&) = delete;
+    SegmentedArray& operator=(const SegmentedArray&) = delete;
+
+    SegmentedArray(SegmentedArray&& other) noexcept
+        : blocks(std::exchange(other.blocks, {})), size(std::exchange(other.size, 0)), verbose(other.verbose) {}
+
+    SegmentedArray& operator=(SegmentedArray&& other) noexcept {
+        if (this != &other) {
+            clear();
+            blocks = std::exchange(other.blocks, {});
+            size = std::exchange(other.size, 0);
+            verbose = other.verbose;
+        }
+        return *this;
+    }
+
+    template <typename U>
+    void add(U&& fig) {
+        if (size == Segments::maxSize)
+            throw std::length_error("SegmentedArray is full");
+        size_t s = Segments::segmentOf(size);
+        if (!blocks[s])
+            blocks[s] = std::allocator<T>().allocate(Segments::capacity(s));
+        std::construct_at(&slot(size), std::forward<U>(fig));
+        ++size;
+    }
+
+    void remove(size_t index) {
+        if (!size)
+            throw std::out_of_range("Array is empty");
+        if (index >= size)
+            throw std::out_of_range("Index out of range");
+
+        for (size_t i = index; i < size - 1; ++i)
+            slot(i) = std::move(slot(i + 1));
+        std::destroy_at(&slot(size - 1));
+
+        --size;
+        if (verbose)
+            std::cout << "Element at index " << index << " removed.\n";
+    }
+
+    T& operator[](size_t index) {
+        if (index >= size)
+            throw std::out_of_range("Index out of range");
+        return slot(index);
+    }
+
+    const T& operator[](size_t index) const {
+        if (index >= size)
+            throw std::out_of_range("Index out of range");
+        return slot(index);
+    }
+
+    int getSize() const {
+        return static_cast<int>(size);
+    }
+
+    void setVerbose(bool enabled) {
+        verbose = enabled;
+    }
+
+    iterator begin() {
+        return iterator(this, 0);
+    }
+
+    iterator end() {
+        return iterator(this, size);
+    }
+
+    const_iterator begin() const {
+        return const_iterator(this, 0);
+    }
+
+    const_iterator end() const {
+        return const_iterator(this, size);
+    }
+
+    // Calls fn(std::span<const T>) for each filled part of a block, in order.
+    template <typename F>
+    void forEachBlock(F&& fn) const {
+        for (size_t s = 0; s < Segments::maxSegments && Segments::start(s) < size; ++s)
+            fn(std::span<const T>(blocks[s], std::min(Segments::capacity(s), size - Segments::start(s))));
+    }
+
+    template <typename F>
+    void forEachBlock(F&& fn) {
+        for (size_t s = 0; s < Segments::maxSegments && Segments::start(s) < size; ++s)
+            fn(std::span<T>(blocks[s], std::min(Segments::capacity(s), size - Segments::start(s))));
+    }
+
+    void printAll() const {
+        TextWriter out(std::cout);
+        printAll(out);
+    }
+
+    void printAll(TextWriter& out) const {
+        printFigures(*this, out);
+    }
+
+    void printCenters() const {
+        TextWriter out(std::cout);
+        printCenters(out);
+    }
+
+    void printCenters(TextWriter& out) const {
+        printFigureCenters(*this, out);
+    }
+
+    void printTotalArea() const {
+        TextWriter out(std::cout);
+        printTotalArea(out);
+    }
+
+    void printTotalArea(TextWriter& out) const {
+        printFiguresTotalArea(*this, out);
+    }
+
+private:
+    T& slot(size_t index) const {
+        return blocks[Segments::segmentOf(index)][Segments::offsetOf(index)];
+    }
+
+    void clear() {
+        for (size_t i = 0; i < size; ++i)
+            std::destroy_at(&slot(i));
+        for (size_t s = 0; s < Segments::maxSegments; ++s)
+            if (blocks[s])
+                std::allocator<T>().deallocate(blocks[s], Segments::capacity(s));
+        blocks = {};
+        size = 0;
+    }
+
+    std::array<T*, Segments::maxSegments> blocks{};
+    size_t size = 0;
+    bool verbose = true;
+};
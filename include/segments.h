@@ -0,0 +1,35 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+
+// Index math for storage made of segments that double in size: segment s
+// holds first << s elements, so existing segments never move as it grows.
+template <size_t FirstBits>
+struct GeometricSegments {
+    static constexpr size_t first = size_t(1) << FirstBits;
+    static constexpr size_t maxSegments = 64 - FirstBits;
+    // All segments together hold 2^64 - first elements; index + first
+    // stays representable below this.
+    static constexpr size_t maxSize = size_t(0) - first;
+
+    static constexpr size_t capacity(size_t segment) {
+        return first << segment;
+    }
+
+    static constexpr size_t start(size_t segment) {
+        return capacity(segment) - first;
+    }
+
+    // Callers keep index below maxSize. The masks only make the math total,
+    // so an index that wrapped still lands inside segment 0 rather than
+    // underflowing into a huge segment number.
+    static constexpr size_t segmentOf(size_t index) {
+        return std::bit_width((index + first) | first) - 1 - FirstBits;
+    }
+
+    static constexpr size_t offsetOf(size_t index) {
+        size_t position = index + first;
+        return position ^ std::bit_floor(position);
+    }
+};
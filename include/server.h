@@ -0,0 +1,944 @@
+#pragma once
+
+#include "array.h"
+#include "binary_format.h"
+#include "figure_store.h"
+#include "loader.h"
+#include "rtree.h"
+#include "sketch.h"
+#include "square.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <numbers>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+// Wire format shared by FigureServer and FigureClient, little-endian:
+//   frame      u32 size of the rest, u32 request id, u16 command count, commands
+//   add        'A', u8 kind, f64 x and y per vertex   -> u64 figure count
+//   remove     'R', u64 index                         -> u64 figure count
+//   area       'S'                                    -> f64 total area
+//   region     'Q', f64 minX, minY, maxX, maxY        -> u64 n, n x u64 index
+//   snapshot   'P'                                    -> u64 n, n bytes of a
+//                                                        binary figure file
+// The response frame carries the request id and one result per command: u8
+// status 0 and the value above, or status 1, u16 length and an error message.
+// Responses come back in request order, so clients may pipeline requests.
+struct FigureProtocol {
+    static constexpr size_t maxFrame = 64 << 20;
+
+    // The rest of the frame cannot be parsed.
+    struct MalformedFrame : std::runtime_error {
+        using std::runtime_error::runtime_error;
+    };
+
+    static void put16(std::vector<unsigned char>& out, uint16_t v) {
+        out.push_back(static_cast<unsigned char>(v));
+        out.push_back(static_cast<unsigned char>(v >> 8));
+    }
+
+    static void put32(std::vector<unsigned char>& out, uint32_t v) {
+        for (int i = 0; i < 4; ++i)
+            out.push_back(static_cast<unsigned char>(v >> (8 * i)));
+    }
+
+    static void put64(std::vector<unsigned char>& out, uint64_t v) {
+        size_t at = out.size();
+        out.resize(at + 8);
+        BinaryFormat::storeLE(&out[at], v);
+    }
+
+    static void putF64(std::vector<unsigned char>& out, double v) {
+        put64(out, std::bit_cast<uint64_t>(v));
+    }
+
+    // writev for sockets, without SIGPIPE when the peer is gone: the error
+    // comes back as EPIPE instead of depending on the process signal state.
+    static ssize_t sendv(int fd, iovec* iov, int count) {
+        msghdr msg{};
+        msg.msg_iov = iov;
+        msg.msg_iovlen = static_cast<size_t>(count);
+        return ::sendmsg(fd, &msg, MSG_NOSIGNAL);
+    }
+
+    static uint32_t load32(const unsigned char* in) {
+        return uint32_t(in[0]) | uint32_t(in[1]) << 8 | uint32_t(in[2]) << 16 | uint32_t(in[3]) << 24;
+    }
+
+    // Bounds-checked cursor over one frame.
+    class Reader {
+    public:
+        Reader(const unsigned char* data, size_t size) : data(data), size(size) {}
+
+        const unsigned char* take(size_t n) {
+            if (n > size - pos)
+                throw MalformedFrame("Truncated frame");
+            const unsigned char* at = data + pos;
+            pos += n;
+            return at;
+        }
+
+        uint8_t u8() {
+            return *take(1);
+        }
+
+        uint16_t u16() {
+            return BinaryFormat::loadLE16(take(2));
+        }
+
+        uint32_t u32() {
+            return load32(take(4));
+        }
+
+        uint64_t u64() {
+            return BinaryFormat::loadLE(take(8));
+        }
+
+        double f64() {
+            return std::bit_cast<double>(u64());
+        }
+
+        bool done() const {
+            return pos == size;
+        }
+
+    private:
+        const unsigned char* data;
+        size_t size;
+        size_t pos = 0;
+    };
+};
+
+// Owns one figure collection (in memory, or a FigureStore) and serves it on
+// a Unix domain socket from a single epoll loop. Every complete frame that
+// has arrived on a connection is answered in one go, so pipelined requests
+// cost one read and one write between them. Responses are queued as shared
+// buffers and sent with sendmsg straight from them: the encoded snapshot is
+// cached until the collection changes and handed to every client that asks
+// for it without being copied. A connection with too much unsent output is
+// not read from until it drains.
+template <Scalar T>
+class FigureServer {
+public:
+    explicit FigureServer(const std::string& socketPath, FigureStore<T>* store = nullptr)
+        : path(socketPath), store(store) {
+        if (path.size() >= sizeof(sockaddr_un::sun_path))
+            throw std::invalid_argument("Socket path is too long: " + path);
+        if (store)
+            store->setVerbose(false);
+        memoryFigures.setVerbose(false);
+        for (const auto& fig : figures())
+            totalArea += static_cast<double>(*fig);
+
+        listenFd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+        stopFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (listenFd < 0 || epollFd < 0 || stopFd < 0) {
+            closeAll();
+            throw std::runtime_error("Cannot create server sockets");
+        }
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+        ::unlink(path.c_str());
+        if (::bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0 || ::listen(listenFd, 128) < 0) {
+            closeAll();
+            throw std::runtime_error("Cannot listen on " + path);
+        }
+
+        watch(listenFd, EPOLLIN);
+        watch(stopFd, EPOLLIN);
+    }
+
+    ~FigureServer() {
+        for (auto& [fd, conn] : connections)
+            ::close(fd);
+        closeAll();
+        ::unlink(path.c_str());
+    }
+
+    FigureServer(const FigureServer&) = delete;
+    FigureServer& operator=(const FigureServer&) = delete;
+
+    // Serves until stop() is called.
+    void run() {
+        epoll_event events[64];
+        while (true) {
+            int n = ::epoll_wait(epollFd, events, 64, -1);
+            if (n < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::runtime_error("epoll_wait failed");
+            }
+            for (int i = 0; i < n; ++i) {
+                int fd = events[i].data.fd;
+                if (fd == stopFd) {
+                    uint64_t value;
+                    [[maybe_unused]] auto r = ::read(stopFd, &value, sizeof(value));
+                    return;
+                }
+                if (fd == listenFd)
+                    acceptAll();
+                else
+                    serve(fd, events[i].events);
+            }
+        }
+    }
+
+    // Makes run() return; safe to call from another thread or a signal handler.
+    void stop() {
+        uint64_t one = 1;
+        [[maybe_unused]] auto r = ::write(stopFd, &one, sizeof(one));
+    }
+
+    const Array<std::shared_ptr<Figure<T>>>& figures() const {
+        return store ? store->figures() : memoryFigures;
+    }
+
+private:
+    using Buffer = std::shared_ptr<const std::vector<unsigned char>>;
+
+    static constexpr size_t outputLimit = 16 << 20;
+    static constexpr size_t reindexThreshold = 1024;
+
+    struct IndexRange {
+        size_t begin, end;
+        RTree<T> tree;
+    };
+
+    struct Connection {
+        std::vector<unsigned char> in;
+        std::deque<Buffer> out;
+        size_t outOffset = 0;
+        size_t outBytes = 0;
+        uint32_t events = 0;
+        bool peerClosed = false;  // read side hit EOF; close once out drains
+    };
+
+    void watch(int fd, uint32_t events) {
+        epoll_event ev{};
+        ev.events = events;
+        ev.data.fd = fd;
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &ev);
+    }
+
+    void closeAll() {
+        for (int* fd : {&listenFd, &epollFd, &stopFd})
+            if (*fd >= 0) {
+                ::close(*fd);
+                *fd = -1;
+            }
+    }
+
+    void acceptAll() {
+        while (true) {
+            int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd < 0)
+                return;
+            connections[fd].events = EPOLLIN;
+            watch(fd, EPOLLIN);
+        }
+    }
+
+    void drop(int fd) {
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+        ::close(fd);
+        connections.erase(fd);
+    }
+
+    void serve(int fd, uint32_t events) {
+        auto it = connections.find(fd);
+        if (it == connections.end())
+            return;
+        Connection& conn = it->second;
+
+        if (events & (EPOLLERR | EPOLLHUP)) {
+            drop(fd);
+            return;
+        }
+        if ((events & EPOLLIN) && !conn.peerClosed && conn.outBytes < outputLimit) {
+            if (!readInput(fd, conn)) {
+                drop(fd);
+                return;
+            }
+            try {
+                answer(conn);
+            } catch (const std::exception&) {
+                drop(fd);
+                return;
+            }
+        }
+        // A client that half-closed after its last request still gets the
+        // answers to every complete frame it sent.
+        if (!flush(fd, conn) || (conn.peerClosed && conn.out.empty())) {
+            drop(fd);
+            return;
+        }
+
+        uint32_t wanted = (!conn.peerClosed && conn.outBytes < outputLimit ? uint32_t(EPOLLIN) : 0) |
+                          (conn.out.empty() ? 0 : uint32_t(EPOLLOUT));
+        if (wanted != conn.events) {
+            conn.events = wanted;
+            epoll_event ev{};
+            ev.events = wanted;
+            ev.data.fd = fd;
+            ::epoll_ctl(epollFd, EPOLL_CTL_MOD, fd, &ev);
+        }
+    }
+
+    // False when the connection failed; EOF only marks the peer closed.
+    // Stops once the buffer could hold the largest frame or the output is
+    // over its limit; epoll is level-triggered, so the rest is read on the
+    // next EPOLLIN, after what is buffered has been answered.
+    bool readInput(int fd, Connection& conn) {
+        unsigned char chunk[1 << 16];
+        while (conn.in.size() <= 4 + FigureProtocol::maxFrame && conn.outBytes < outputLimit) {
+            ssize_t n = ::read(fd, chunk, sizeof(chunk));
+            if (n > 0) {
+                conn.in.insert(conn.in.end(), chunk, chunk + n);
+                continue;
+            }
+            if (n == 0) {
+                conn.peerClosed = true;
+                return true;
+            }
+            if (errno == EINTR)
+                continue;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        return true;
+    }
+
+    // Answers every complete frame in the input buffer; throws on a frame
+    // that cannot be parsed at all.
+    void answer(Connection& conn) {
+        size_t pos = 0;
+        while (conn.in.size() - pos >= 4) {
+            size_t size = FigureProtocol::load32(&conn.in[pos]);
+            if (size > FigureProtocol::maxFrame)
+                throw std::runtime_error("Frame too large");
+            if (conn.in.size() - pos - 4 < size)
+                break;
+            respond(conn, FigureProtocol::Reader(&conn.in[pos + 4], size));
+            pos += 4 + size;
+        }
+        conn.in.erase(conn.in.begin(), conn.in.begin() + pos);
+
+        // Group commit: everything answered here is durable before any of
+        // the responses is sent.
+        if (store)
+            store->commit();
+    }
+
+    void respond(Connection& conn, FigureProtocol::Reader request) {
+        uint32_t id = request.u32();
+        uint16_t count = request.u16();
+
+        // The frame is built as a list of buffers so a cached snapshot can be
+        // queued as it is; the size field is patched in once all are known.
+        std::vector<Buffer> parts;
+        auto current = std::make_shared<std::vector<unsigned char>>();
+        auto head = current;
+        FigureProtocol::put32(*current, 0);
+        FigureProtocol::put32(*current, id);
+        FigureProtocol::put16(*current, count);
+        size_t frameSize = current->size();
+
+        bool broken = false;
+        for (uint16_t c = 0; c < count; ++c) {
+            size_t before = current->size();
+            if (broken) {
+                error(*current, "Skipped after a malformed command");
+                frameSize += current->size() - before;
+                continue;
+            }
+            try {
+                Buffer attached = execute(request, *current);
+                if (attached) {
+                    frameSize += current->size() - before + attached->size();
+                    parts.push_back(std::exchange(current, std::make_shared<std::vector<unsigned char>>()));
+                    parts.push_back(std::move(attached));
+                    continue;
+                }
+            } catch (const FigureProtocol::MalformedFrame& e) {
+                current->resize(before);
+                error(*current, e.what());
+                broken = true;
+            } catch (const std::exception& e) {
+                current->resize(before);
+                error(*current, e.what());
+            }
+            frameSize += current->size() - before;
+        }
+        parts.push_back(std::move(current));
+
+        uint32_t size = static_cast<uint32_t>(frameSize - 4);
+        for (int i = 0; i < 4; ++i)
+            (*head)[i] = static_cast<unsigned char>(size >> (8 * i));
+
+        for (auto& part : parts)
+            if (!part->empty()) {
+                conn.outBytes += part->size();
+                conn.out.push_back(std::move(part));
+            }
+    }
+
+    static void error(std::vector<unsigned char>& out, std::string_view message) {
+        message = message.substr(0, 0xffff);
+        out.push_back(1);
+        FigureProtocol::put16(out, static_cast<uint16_t>(message.size()));
+        out.insert(out.end(), message.begin(), message.end());
+    }
+
+    // Runs one command and appends its result; a returned buffer is sent
+    // right after what was appended. Throws MalformedFrame when the command
+    // cannot be parsed, other exceptions when it failed.
+    Buffer execute(FigureProtocol::Reader& request, std::vector<unsigned char>& out) {
+        switch (request.u8()) {
+            case 'A': {
+                uint8_t kind = request.u8();
+                if (kind >= BinaryFormat::kinds)
+                    throw FigureProtocol::MalformedFrame("Unknown figure kind");
+                std::vector<Point<T>> vertices(BinaryFormat::vertexCounts[kind]);
+                for (auto& v : vertices) {
+                    T x = coordinate(request.f64());
+                    T y = coordinate(request.f64());
+                    v = Point<T>(x, y);
+                }
+                checkShape(static_cast<FigureKind>(kind), vertices);
+                auto fig = BinaryFormat::makeFigure<T>(static_cast<FigureKind>(kind), vertices);
+                double area = static_cast<double>(*fig);
+                store ? store->add(std::move(fig)) : memoryFigures.add(std::move(fig));
+                totalArea += area;
+                snapshotBytes.reset();
+                out.push_back(0);
+                FigureProtocol::put64(out, figures().getSize());
+                return nullptr;
+            }
+            case 'R': {
+                uint64_t index = request.u64();
+                const auto& figs = figures();
+                double area = index < static_cast<uint64_t>(figs.getSize()) ? static_cast<double>(*figs[index]) : 0.0;
+                store ? store->remove(index) : memoryFigures.remove(index);
+                totalArea -= area;
+                unindex(index);
+                snapshotBytes.reset();
+                out.push_back(0);
+                FigureProtocol::put64(out, figures().getSize());
+                return nullptr;
+            }
+            case 'S': {
+                out.push_back(0);
+                FigureProtocol::putF64(out, totalArea);
+                return nullptr;
+            }
+            case 'Q': {
+                double minX = request.f64(), minY = request.f64(), maxX = request.f64(), maxY = request.f64();
+                auto found = region(Box<T>(static_cast<T>(minX), static_cast<T>(minY),
+                                           static_cast<T>(maxX), static_cast<T>(maxY)));
+                out.push_back(0);
+                FigureProtocol::put64(out, found.size());
+                for (size_t i : found)
+                    FigureProtocol::put64(out, i);
+                return nullptr;
+            }
+            case 'P': {
+                // Compacting the log is left to the store's snapshotInterval.
+                if (!snapshotBytes) {
+                    snapshotBytes = std::make_shared<const std::vector<unsigned char>>(
+                        BinaryFigureWriter::encode(figures()));
+                }
+                out.push_back(0);
+                FigureProtocol::put64(out, snapshotBytes->size());
+                return snapshotBytes;
+            }
+            default:
+                throw FigureProtocol::MalformedFrame("Unknown command");
+        }
+    }
+
+    // Figures after a removed one move down by one place: the ranges past it
+    // shift, and only the tree that covered it is rebuilt.
+    void unindex(size_t index) {
+        if (index >= indexed)
+            return;
+        --indexed;
+        const auto& figs = figures();
+        for (size_t r = regionIndex.size(); r-- > 0;) {
+            IndexRange& range = regionIndex[r];
+            --range.end;
+            if (range.begin <= index) {
+                if (range.begin == range.end) {
+                    regionIndex.erase(regionIndex.begin() + r);
+                } else {
+                    std::vector<Box<T>> boxes;
+                    boxes.reserve(range.end - range.begin);
+                    for (size_t i = range.begin; i < range.end; ++i)
+                        boxes.push_back(figs[i]->bounds());
+                    range.tree = RTree<T>(boxes);
+                }
+                return;
+            }
+            --range.begin;
+        }
+    }
+
+    // Client numbers become T only when they are finite and in its range.
+    static T coordinate(double v) {
+        using Limits = std::numeric_limits<T>;
+        double low = static_cast<double>(Limits::lowest());
+        bool inRange = std::is_integral_v<T> ? v >= low && v < std::ldexp(1.0, Limits::digits)
+                                             : v >= low && v <= static_cast<double>(Limits::max());
+        if (!inRange)
+            throw FigureProtocol::MalformedFrame("Coordinates must be finite and in range");
+        return static_cast<T>(v);
+    }
+
+    // Client vertices are stored as they are, so they must be a figure the
+    // constructors could have built: sizes pass the loader's checks, and the
+    // vertices are counter-clockwise and form an isosceles triangle on its
+    // first side or a regular polygon. Checked in double, to within rounding.
+    static void checkShape(FigureKind kind, std::span<const Point<T>> vertices) {
+        using Loader = FigureLoader<T>;
+        std::vector<Point<double>> v;
+        double scale = 0;
+        for (const auto& p : vertices) {
+            v.emplace_back(p);
+            scale = std::max(scale, std::hypot(v.back().x(), v.back().y()));
+        }
+        double tolerance = std::is_integral_v<T> ? 1.0 : 1024 * std::numeric_limits<T>::epsilon() * scale;
+
+        Point<double> side = v[1] - v[0];
+        double length = std::hypot(side.x(), side.y());
+        if (Loader::tooLarge(length))
+            throw FigureProtocol::MalformedFrame("Figure is too large");
+        if (Loader::negligible(length, scale))
+            throw FigureProtocol::MalformedFrame("Points are too close together");
+
+        if (kind == FigureKind::Triangle) {
+            Point<double> apex = v[2] - (v[0] + v[1]) / 2;
+            double height = side.cross(apex) / length;
+            if (height <= 0)
+                throw FigureProtocol::MalformedFrame("Vertices must be counter-clockwise");
+            if (Loader::tooLarge(height))
+                throw FigureProtocol::MalformedFrame("Figure is too large");
+            if (Loader::negligible(height, scale))
+                throw FigureProtocol::MalformedFrame("Height is too small");
+            if (std::abs(side.dot(apex)) / length > tolerance)
+                throw FigureProtocol::MalformedFrame("Vertices do not form a triangle");
+            return;
+        }
+
+        // Each side is the previous one turned by the exterior angle.
+        size_t n = v.size();
+        double turn = 2 * std::numbers::pi / static_cast<double>(n);
+        double c = std::cos(turn), s = std::sin(turn);
+        for (size_t i = 0; i < n; ++i) {
+            Point<double> current = v[(i + 1) % n] - v[i];
+            Point<double> next = v[(i + 2) % n] - v[(i + 1) % n];
+            Point<double> miss = next - (current * c + current.perp() * s);
+            if (std::hypot(miss.x(), miss.y()) > tolerance)
+                throw FigureProtocol::MalformedFrame(kind == FigureKind::Square ? "Vertices do not form a square"
+                                                                                 : "Vertices do not form an octagon");
+        }
+    }
+
+    // The figures [0, indexed) are covered by R-trees over consecutive index
+    // ranges whose sizes shrink towards the end; figures added since are
+    // scanned directly until there are enough of them for a tree of their
+    // own. A new tree is merged with the previous one while it is at least
+    // as large, so every figure is re-indexed O(log n) times in total.
+    std::vector<size_t> region(const Box<T>& window) {
+        const auto& figs = figures();
+        size_t n = figs.getSize();
+        if (n - indexed > reindexThreshold) {
+            size_t begin = indexed;
+            while (!regionIndex.empty() && regionIndex.back().end - regionIndex.back().begin <= n - begin) {
+                begin = regionIndex.back().begin;
+                regionIndex.pop_back();
+            }
+            std::vector<Box<T>> boxes;
+            boxes.reserve(n - begin);
+            for (size_t i = begin; i < n; ++i)
+                boxes.push_back(figs[i]->bounds());
+            regionIndex.push_back(IndexRange{begin, n, RTree<T>(boxes)});
+            indexed = n;
+        }
+
+        std::vector<size_t> found;
+        for (const auto& range : regionIndex) {
+            auto hits = range.tree.query(window);
+            std::sort(hits.begin(), hits.end());
+            for (size_t i : hits)
+                found.push_back(range.begin + i);
+        }
+        for (size_t i = indexed; i < n; ++i)
+            if (figs[i]->bounds().intersects(window))
+                found.push_back(i);
+        return found;
+    }
+
+    // False when the connection failed.
+    bool flush(int fd, Connection& conn) {
+        while (!conn.out.empty()) {
+            iovec iov[64];
+            int n = 0;
+            size_t offset = conn.outOffset;
+            for (auto it = conn.out.begin(); it != conn.out.end() && n < 64; ++it, offset = 0) {
+                iov[n].iov_base = const_cast<unsigned char*>((*it)->data() + offset);
+                iov[n].iov_len = (*it)->size() - offset;
+                ++n;
+            }
+
+            ssize_t written = FigureProtocol::sendv(fd, iov, n);
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+
+            size_t left = static_cast<size_t>(written);
+            conn.outBytes -= left;
+            while (left) {
+                size_t rest = conn.out.front()->size() - conn.outOffset;
+                if (left < rest) {
+                    conn.outOffset += left;
+                    break;
+                }
+                left -= rest;
+                conn.out.pop_front();
+                conn.outOffset = 0;
+            }
+        }
+        return true;
+    }
+
+    std::string path;
+    FigureStore<T>* store;
+    Array<std::shared_ptr<Figure<T>>> memoryFigures;
+    std::vector<IndexRange> regionIndex;
+    size_t indexed = 0;
+    double totalArea = 0.0;
+    Buffer snapshotBytes;
+    std::unordered_map<int, Connection> connections;
+    int listenFd = -1;
+    int epollFd = -1;
+    int stopFd = -1;
+};
+
+// Commands of one request frame, built on the client side.
+class FigureRequest {
+public:
+    template <Scalar T>
+    FigureRequest& add(const Figure<T>& fig) {
+        body.push_back('A');
+        body.push_back(static_cast<unsigned char>(BinaryFormat::kindOf(fig)));
+        for (size_t v = 0; v < fig.vertexCount(); ++v) {
+            FigureProtocol::putF64(body, static_cast<double>(fig.vertex(v).x()));
+            FigureProtocol::putF64(body, static_cast<double>(fig.vertex(v).y()));
+        }
+        ops.push_back('A');
+        return *this;
+    }
+
+    FigureRequest& remove(uint64_t index) {
+        body.push_back('R');
+        FigureProtocol::put64(body, index);
+        ops.push_back('R');
+        return *this;
+    }
+
+    FigureRequest& area() {
+        body.push_back('S');
+        ops.push_back('S');
+        return *this;
+    }
+
+    template <Scalar T>
+    FigureRequest& region(const Box<T>& window) {
+        body.push_back('Q');
+        for (T v : {window.minX, window.minY, window.maxX, window.maxY})
+            FigureProtocol::putF64(body, static_cast<double>(v));
+        ops.push_back('Q');
+        return *this;
+    }
+
+    FigureRequest& snapshot() {
+        body.push_back('P');
+        ops.push_back('P');
+        return *this;
+    }
+
+    size_t size() const {
+        return ops.size();
+    }
+
+    void clear() {
+        body.clear();
+        ops.clear();
+    }
+
+private:
+    friend class FigureClient;
+
+    std::vector<unsigned char> body;
+    std::vector<char> ops;
+};
+
+struct FigureResult {
+    bool ok = false;
+    std::string error;
+    uint64_t count = 0;                   // add, remove
+    double area = 0.0;                    // area
+    std::vector<uint64_t> indices;        // region
+    std::vector<unsigned char> snapshot;  // snapshot
+};
+
+// Blocking client for FigureServer. send() may be called several times
+// before the matching receive() calls to keep requests in flight.
+class FigureClient {
+public:
+    explicit FigureClient(const std::string& socketPath) {
+        if (socketPath.size() >= sizeof(sockaddr_un::sun_path))
+            throw std::invalid_argument("Socket path is too long: " + socketPath);
+        fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd < 0)
+            throw std::runtime_error("Cannot create socket");
+
+        sockaddr_un addr{};
+        addr.sun_family = AF_UNIX;
+        std::memcpy(addr.sun_path, socketPath.c_str(), socketPath.size() + 1);
+        if (::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) < 0) {
+            ::close(fd);
+            throw std::runtime_error("Cannot connect to " + socketPath);
+        }
+    }
+
+    ~FigureClient() {
+        ::close(fd);
+    }
+
+    FigureClient(const FigureClient&) = delete;
+    FigureClient& operator=(const FigureClient&) = delete;
+
+    uint32_t send(const FigureRequest& request) {
+        if (request.ops.size() > 0xffff)
+            throw std::invalid_argument("Too many commands in one request");
+        uint32_t id = nextId++;
+
+        std::vector<unsigned char> header;
+        FigureProtocol::put32(header, static_cast<uint32_t>(6 + request.body.size()));
+        FigureProtocol::put32(header, id);
+        FigureProtocol::put16(header, static_cast<uint16_t>(request.ops.size()));
+
+        iovec iov[2] = {{header.data(), header.size()},
+                        {const_cast<unsigned char*>(request.body.data()), request.body.size()}};
+        writeAll(iov, 2);
+        inFlight.push_back(request.ops);
+        return id;
+    }
+
+    // Results of the oldest request still in flight.
+    std::vector<FigureResult> receive() {
+        if (inFlight.empty())
+            throw std::logic_error("No request in flight");
+        std::vector<char> ops = std::move(inFlight.front());
+        inFlight.pop_front();
+
+        unsigned char sizeBytes[4];
+        readAll(sizeBytes, 4);
+        std::vector<unsigned char> frame(FigureProtocol::load32(sizeBytes));
+        readAll(frame.data(), frame.size());
+
+        FigureProtocol::Reader in(frame.data(), frame.size());
+        in.u32();
+        if (in.u16() != ops.size())
+            throw std::runtime_error("Response does not match the request");
+
+        std::vector<FigureResult> results(ops.size());
+        for (size_t i = 0; i < ops.size(); ++i) {
+            FigureResult& r = results[i];
+            r.ok = in.u8() == 0;
+            if (!r.ok) {
+                uint16_t length = in.u16();
+                const unsigned char* text = in.take(length);
+                r.error.assign(reinterpret_cast<const char*>(text), length);
+                continue;
+            }
+            switch (ops[i]) {
+                case 'A':
+                case 'R':
+                    r.count = in.u64();
+                    break;
+                case 'S':
+                    r.area = in.f64();
+                    break;
+                case 'Q':
+                    r.indices.resize(in.u64());
+                    for (auto& index : r.indices)
+                        index = in.u64();
+                    break;
+                case 'P': {
+                    uint64_t length = in.u64();
+                    const unsigned char* bytes = in.take(length);
+                    r.snapshot.assign(bytes, bytes + length);
+                    break;
+                }
+            }
+        }
+        return results;
+    }
+
+    std::vector<FigureResult> call(const FigureRequest& request) {
+        send(request);
+        return receive();
+    }
+
+private:
+    void writeAll(iovec* iov, int count) {
+        while (count) {
+            ssize_t written = FigureProtocol::sendv(fd, iov, count);
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::runtime_error("Cannot send request");
+            }
+            size_t left = static_cast<size_t>(written);
+            while (count && left >= iov->iov_len) {
+                left -= iov->iov_len;
+                ++iov;
+                --count;
+            }
+            if (count) {
+                iov->iov_base = static_cast<unsigned char*>(iov->iov_base) + left;
+                iov->iov_len -= left;
+            }
+        }
+    }
+
+    void readAll(unsigned char* data, size_t size) {
+        while (size) {
+            ssize_t n = ::read(fd, data, size);
+            if (n < 0 && errno == EINTR)
+                continue;
+            if (n <= 0)
+                throw std::runtime_error("Connection closed by server");
+            data += n;
+            size -= static_cast<size_t>(n);
+        }
+    }
+
+    int fd = -1;
+    uint32_t nextId = 0;
+    std::deque<std::vector<char>> inFlight;
+};
+
+struct LoadOptions {
+    size_t connections = 4;
+    size_t requests = 10000;  // per connection
+    size_t batch = 16;        // commands per request
+    size_t depth = 8;         // requests in flight per connection
+    double extent = 1000.0;
+};
+
+struct LoadReport {
+    uint64_t requests = 0;
+    uint64_t commands = 0;
+    double seconds = 0.0;
+    double p50 = 0.0, p90 = 0.0, p99 = 0.0, max = 0.0;  // microseconds per request
+};
+
+// Drives a FigureServer from `connections` threads. Each request mixes adds
+// of random squares with region queries and ends with an area query; the
+// latency of a request runs from its send to its response.
+inline LoadReport runLoad(const std::string& socketPath, const LoadOptions& options = {}) {
+    using Clock = std::chrono::steady_clock;
+    std::vector<QuantileSketch> latencies(options.connections);
+    std::vector<std::exception_ptr> errors(options.connections);
+    std::atomic<uint64_t> commands{0};
+
+    auto start = Clock::now();
+    std::vector<std::thread> threads;
+    for (size_t c = 0; c < options.connections; ++c)
+        threads.emplace_back([&, c] {
+            try {
+                FigureClient client(socketPath);
+                std::mt19937 rng(static_cast<unsigned>(c + 1));
+                std::uniform_real_distribution<double> pos(0.0, options.extent);
+                std::deque<Clock::time_point> sent;
+                FigureRequest request;
+
+                for (size_t r = 0; r < options.requests || !sent.empty();) {
+                    if (r < options.requests && sent.size() < std::max<size_t>(options.depth, 1)) {
+                        request.clear();
+                        for (size_t k = 0; k + 1 < std::max<size_t>(options.batch, 1); ++k) {
+                            double x = pos(rng), y = pos(rng);
+                            if (k % 2)
+                                request.region(Box<double>(x, y, x + 20, y + 20));
+                            else
+                                request.add(Square<double>(Point<double>(x, y), Point<double>(x + 1, y)));
+                        }
+                        request.area();
+                        client.send(request);
+                        commands += request.size();
+                        sent.push_back(Clock::now());
+                        ++r;
+                        continue;
+                    }
+                    for (const auto& result : client.receive())
+                        if (!result.ok)
+                            throw std::runtime_error("Server error: " + result.error);
+                    latencies[c].add(std::chrono::duration<double, std::micro>(Clock::now() - sent.front()).count());
+                    sent.pop_front();
+                }
+            } catch (...) {
+                errors[c] = std::current_exception();
+            }
+        });
+    for (auto& t : threads)
+        t.join();
+    for (auto& e : errors)
+        if (e)
+            std::rethrow_exception(e);
+
+    QuantileSketch all;
+    for (const auto& sketch : latencies)
+        all.merge(sketch);
+
+    LoadReport report;
+    report.seconds = std::chrono::duration<double>(Clock::now() - start).count();
+    report.requests = all.count();
+    report.commands = commands.load();
+    if (!all.empty()) {
+        report.p50 = all.quantile(0.5);
+        report.p90 = all.quantile(0.9);
+        report.p99 = all.quantile(0.99);
+        report.max = all.max();
+    }
+    return report;
+}
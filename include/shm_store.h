@@ -0,0 +1,495 @@
+#pragma once
+
+#include "array.h"
+#include "binary_format.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Figure collection in a POSIX shared-memory segment, written by one process
+// and scanned in place by any number of others:
+//
+//   header    magic, capacities, column offsets, publish counters
+//   columns   per figure: kind (u8), first vertex (u64), area, center x and
+//             y, bounds min x, min y, max x, max y (f64);
+//             per vertex: xs, ys (f64)
+//
+// Every column starts on a cache line and is addressed by its offset from
+// the start of the segment, so each process may map it anywhere. Area,
+// center and bounds are computed once by the writer, which makes the usual
+// queries plain column scans for the readers.
+//
+// Publishing: an append fills in the columns past the published count and
+// then raises the count with a release store; readers load the count once
+// per query and never look past it. An update in place is bracketed by a
+// sequence counter that is odd while the writer is inside; a query that saw
+// it odd, or saw it move while running, is retried (a seqlock). Updates keep
+// the figure type, so offsets are never rewritten. The numbers an update
+// rewrites are read and written with relaxed atomic operations, so a racing
+// read only sees stale values, which the retry discards.
+
+struct SharedFigureHeader {
+    enum Column : size_t {
+        Kinds,
+        FirstVertex,
+        Area,
+        CenterX,
+        CenterY,
+        MinX,
+        MinY,
+        MaxX,
+        MaxY,
+        Xs,
+        Ys,
+        Columns
+    };
+
+    static constexpr uint32_t magicValue = 0x4d474946;  // "FIGM" little-endian
+    static constexpr uint32_t currentVersion = 1;
+
+    // Bytes column c takes for the given capacities.
+    static uint64_t columnBytes(size_t c, uint64_t capacity, uint64_t vertexCapacity) {
+        switch (c) {
+            case Kinds:
+                return capacity;
+            case FirstVertex:
+                return (capacity + 1) * sizeof(uint64_t);
+            case Xs:
+            case Ys:
+                return vertexCapacity * sizeof(double);
+            default:
+                return capacity * sizeof(double);
+        }
+    }
+
+    std::atomic<uint32_t> magic;
+    uint32_t version;
+    uint64_t capacity;
+    uint64_t vertexCapacity;
+    uint64_t segmentSize;
+    uint64_t columns[Columns];
+    alignas(64) std::atomic<uint64_t> sequence;
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> vertices;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "Shared header counters must be lock-free to work across processes");
+static_assert(std::atomic_ref<double>::is_always_lock_free,
+              "Shared columns are read with atomic loads and must be lock-free");
+
+// Queries shared by the writer and the read-only views.
+template <Scalar T>
+class SharedFigureColumns {
+public:
+    size_t size() const {
+        return header->count.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const {
+        return header->capacity;
+    }
+
+    // Changes with every published append or update.
+    uint64_t version() const {
+        return header->sequence.load(std::memory_order_acquire) / 2 + header->count.load(std::memory_order_acquire);
+    }
+
+    double totalArea() const {
+        return read([&](size_t n) {
+            const double* area = column<double>(SharedFigureHeader::Area);
+            double total = 0.0;
+            for (size_t i = 0; i < n; ++i)
+                total += load(area[i]);
+            return total;
+        });
+    }
+
+    double area(size_t index) const {
+        return read([&](size_t n) {
+            check(index, n);
+            return load(column<double>(SharedFigureHeader::Area)[index]);
+        });
+    }
+
+    Point<T> center(size_t index) const {
+        return read([&](size_t n) {
+            check(index, n);
+            return centerAt(index);
+        });
+    }
+
+    std::vector<Point<T>> centers() const {
+        return read([&](size_t n) {
+            std::vector<Point<T>> result;
+            result.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+                result.push_back(centerAt(i));
+            return result;
+        });
+    }
+
+    Box<T> bounds(size_t index) const {
+        return read([&](size_t n) {
+            check(index, n);
+            return Box<T>(static_cast<T>(load(column<double>(SharedFigureHeader::MinX)[index])),
+                          static_cast<T>(load(column<double>(SharedFigureHeader::MinY)[index])),
+                          static_cast<T>(load(column<double>(SharedFigureHeader::MaxX)[index])),
+                          static_cast<T>(load(column<double>(SharedFigureHeader::MaxY)[index])));
+        });
+    }
+
+    // Indices of the figures whose bounds intersect the region, ascending.
+    std::vector<size_t> region(const Box<T>& box) const {
+        return read([&](size_t n) {
+            const double* minX = column<double>(SharedFigureHeader::MinX);
+            const double* minY = column<double>(SharedFigureHeader::MinY);
+            const double* maxX = column<double>(SharedFigureHeader::MaxX);
+            const double* maxY = column<double>(SharedFigureHeader::MaxY);
+            double qMinX = box.minX, qMinY = box.minY, qMaxX = box.maxX, qMaxY = box.maxY;
+            std::vector<size_t> result;
+            for (size_t i = 0; i < n; ++i)
+                if (load(minX[i]) <= qMaxX && qMinX <= load(maxX[i]) && load(minY[i]) <= qMaxY && qMinY <= load(maxY[i]))
+                    result.push_back(i);
+            return result;
+        });
+    }
+
+    FigureKind kind(size_t index) const {
+        return read([&](size_t n) {
+            check(index, n);
+            return static_cast<FigureKind>(column<uint8_t>(SharedFigureHeader::Kinds)[index]);
+        });
+    }
+
+    // Converts one stored figure back into its shape.
+    std::shared_ptr<Figure<T>> figure(size_t index) const {
+        Record record = read([&](size_t n) {
+            check(index, n);
+            return recordAt(index);
+        });
+        return record.make();
+    }
+
+    Array<std::shared_ptr<Figure<T>>> figures() const {
+        std::vector<Record> records = read([&](size_t n) {
+            std::vector<Record> result;
+            result.reserve(n);
+            for (size_t i = 0; i < n; ++i)
+                result.push_back(recordAt(i));
+            return result;
+        });
+        Array<std::shared_ptr<Figure<T>>> result;
+        result.setVerbose(false);
+        for (const Record& record : records)
+            result.add(record.make());
+        return result;
+    }
+
+protected:
+    // Raw copy of one figure, turned into a shape once the read is known
+    // to be consistent.
+    struct Record {
+        FigureKind kind = FigureKind::Square;
+        std::array<Point<T>, 8> vertices;
+
+        std::shared_ptr<Figure<T>> make() const {
+            size_t n = BinaryFormat::vertexCounts[static_cast<size_t>(kind)];
+            return BinaryFormat::makeFigure<T>(kind, std::span<const Point<T>>(vertices.data(), n));
+        }
+    };
+
+    SharedFigureColumns() = default;
+
+    void attach(unsigned char* segment) {
+        base = segment;
+        header = reinterpret_cast<SharedFigureHeader*>(segment);
+    }
+
+    template <typename V>
+    V* column(SharedFigureHeader::Column c) const {
+        return reinterpret_cast<V*>(base + header->columns[c]);
+    }
+
+    // Runs fn(published count) until it ran without an update in between.
+    template <typename F>
+    auto read(F&& fn) const {
+        for (;;) {
+            uint64_t before = header->sequence.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            auto result = fn(static_cast<size_t>(header->count.load(std::memory_order_acquire)));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (header->sequence.load(std::memory_order_relaxed) == before)
+                return result;
+        }
+    }
+
+    // The columns an update rewrites are read with relaxed atomic loads (and
+    // written with relaxed atomic stores), so a read that races the writer
+    // gets stale numbers instead of undefined behaviour; the seqlock retry
+    // discards them.
+    static double load(const double& value) {
+        return std::atomic_ref<double>(const_cast<double&>(value)).load(std::memory_order_relaxed);
+    }
+
+    static void check(size_t index, size_t n) {
+        if (index >= n)
+            throw std::out_of_range("Index out of range");
+    }
+
+    Point<T> centerAt(size_t index) const {
+        return Point<T>(static_cast<T>(load(column<double>(SharedFigureHeader::CenterX)[index])),
+                        static_cast<T>(load(column<double>(SharedFigureHeader::CenterY)[index])));
+    }
+
+    Record recordAt(size_t index) const {
+        Record record;
+        uint8_t kind = column<uint8_t>(SharedFigureHeader::Kinds)[index];
+        size_t first = column<uint64_t>(SharedFigureHeader::FirstVertex)[index];
+        if (kind >= BinaryFormat::kinds || first > header->vertexCapacity ||
+            BinaryFormat::vertexCounts[kind] > header->vertexCapacity - first)
+            throw std::runtime_error("Corrupted shared figure store");
+        record.kind = static_cast<FigureKind>(kind);
+        size_t n = BinaryFormat::vertexCounts[kind];
+        const double* xs = column<double>(SharedFigureHeader::Xs) + first;
+        const double* ys = column<double>(SharedFigureHeader::Ys) + first;
+        for (size_t v = 0; v < n; ++v)
+            record.vertices[v] = Point<T>(static_cast<T>(load(xs[v])), static_cast<T>(load(ys[v])));
+        return record;
+    }
+
+    unsigned char* base = nullptr;
+    SharedFigureHeader* header = nullptr;
+};
+
+// The writer side. Creates the segment (the name must not exist yet) and
+// removes the name again when destroyed; views that are already open keep
+// their mapping. Only this object may change the segment.
+template <Scalar T>
+class SharedFigureStore : public SharedFigureColumns<T> {
+public:
+    // Room for `capacity` figures; by default every one may be an octagon.
+    SharedFigureStore(const std::string& name, size_t capacity, size_t vertexCapacity = 0)
+        : name(name) {
+        if (name.size() < 2 || name[0] != '/' || name.find('/', 1) != std::string::npos)
+            throw std::invalid_argument("Shared memory name must look like /name: " + name);
+        if (!vertexCapacity)
+            vertexCapacity = capacity * BinaryFormat::vertexCounts[static_cast<size_t>(FigureKind::Octagon)];
+
+        std::array<uint64_t, SharedFigureHeader::Columns> columns;
+        size_t offset = align64(sizeof(SharedFigureHeader));
+        for (size_t c = 0; c < SharedFigureHeader::Columns; ++c) {
+            columns[c] = offset;
+            offset = align64(offset + SharedFigureHeader::columnBytes(c, capacity, vertexCapacity));
+        }
+        length = offset;
+
+        int fd = ::shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0644);
+        if (fd < 0)
+            throw std::runtime_error("Cannot create shared memory " + name);
+        if (::ftruncate(fd, static_cast<off_t>(length)) < 0) {
+            ::close(fd);
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("Cannot size shared memory " + name);
+        }
+        void* mapped = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED) {
+            ::shm_unlink(name.c_str());
+            throw std::runtime_error("Cannot map shared memory " + name);
+        }
+
+        // The segment comes zero-filled; the magic goes in last so a view
+        // opened meanwhile refuses the half-made header.
+        auto* h = new (mapped) SharedFigureHeader;
+        h->version = SharedFigureHeader::currentVersion;
+        h->capacity = capacity;
+        h->vertexCapacity = vertexCapacity;
+        h->segmentSize = length;
+        for (size_t c = 0; c < SharedFigureHeader::Columns; ++c)
+            h->columns[c] = columns[c];
+        h->sequence.store(0, std::memory_order_relaxed);
+        h->count.store(0, std::memory_order_relaxed);
+        h->vertices.store(0, std::memory_order_relaxed);
+        this->attach(static_cast<unsigned char*>(mapped));
+        h->magic.store(SharedFigureHeader::magicValue, std::memory_order_release);
+    }
+
+    ~SharedFigureStore() {
+        ::munmap(this->base, length);
+        ::shm_unlink(name.c_str());
+    }
+
+    SharedFigureStore(const SharedFigureStore&) = delete;
+    SharedFigureStore& operator=(const SharedFigureStore&) = delete;
+
+    // Returns the index of the new figure.
+    size_t append(const Figure<T>& fig) {
+        size_t index = write(fig);
+        publish();
+        return index;
+    }
+
+    // Converts and writes the whole container, then publishes it at once;
+    // if a figure does not fit, none of them is published.
+    template <FigureContainer C>
+    void append(const C& figs) {
+        try {
+            for (int i = 0; i < figs.getSize(); ++i)
+                write(asFigure(figs[i]));
+        } catch (...) {
+            pending = 0;
+            throw;
+        }
+        publish();
+    }
+
+    // Replaces a figure by one of the same type.
+    void update(size_t index, const Figure<T>& fig) {
+        size_t n = this->header->count.load(std::memory_order_relaxed);
+        this->check(index, n);
+        FigureKind kind = BinaryFormat::kindOf(fig);
+        if (kind != static_cast<FigureKind>(this->template column<uint8_t>(SharedFigureHeader::Kinds)[index]))
+            throw std::invalid_argument("Update must keep the figure type");
+
+        uint64_t sequence = this->header->sequence.load(std::memory_order_relaxed);
+        this->header->sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        store(index, fig, this->template column<uint64_t>(SharedFigureHeader::FirstVertex)[index]);
+        this->header->sequence.store(sequence + 2, std::memory_order_release);
+    }
+
+    const std::string& segmentName() const {
+        return name;
+    }
+
+private:
+    static size_t align64(size_t offset) {
+        return (offset + 63) & ~size_t(63);
+    }
+
+    // Writes past the published count; readers cannot see it yet.
+    size_t write(const Figure<T>& fig) {
+        FigureKind kind = BinaryFormat::kindOf(fig);
+        size_t vertexCount = BinaryFormat::vertexCounts[static_cast<size_t>(kind)];
+        size_t index = pendingCount();
+        size_t first = this->template column<uint64_t>(SharedFigureHeader::FirstVertex)[index];
+        if (index == this->header->capacity || first + vertexCount > this->header->vertexCapacity)
+            throw std::length_error("Shared figure store is full");
+
+        this->template column<uint8_t>(SharedFigureHeader::Kinds)[index] = static_cast<uint8_t>(kind);
+        store(index, fig, first);
+        this->template column<uint64_t>(SharedFigureHeader::FirstVertex)[index + 1] = first + vertexCount;
+        ++pending;
+        return index;
+    }
+
+    void store(size_t index, const Figure<T>& fig, size_t first) {
+        double* xs = this->template column<double>(SharedFigureHeader::Xs) + first;
+        double* ys = this->template column<double>(SharedFigureHeader::Ys) + first;
+        for (size_t v = 0; v < fig.vertexCount(); ++v) {
+            Point<T> p = fig.vertex(v);
+            put(xs[v], p.x());
+            put(ys[v], p.y());
+        }
+        Point<T> c = fig.center();
+        Box<T> b = fig.bounds();
+        put(this->template column<double>(SharedFigureHeader::Area)[index], static_cast<double>(fig));
+        put(this->template column<double>(SharedFigureHeader::CenterX)[index], c.x());
+        put(this->template column<double>(SharedFigureHeader::CenterY)[index], c.y());
+        put(this->template column<double>(SharedFigureHeader::MinX)[index], b.minX);
+        put(this->template column<double>(SharedFigureHeader::MinY)[index], b.minY);
+        put(this->template column<double>(SharedFigureHeader::MaxX)[index], b.maxX);
+        put(this->template column<double>(SharedFigureHeader::MaxY)[index], b.maxY);
+    }
+
+    // The counterpart of load() for readers that race an update.
+    static void put(double& slot, double value) {
+        std::atomic_ref<double>(slot).store(value, std::memory_order_relaxed);
+    }
+
+    size_t pendingCount() const {
+        return this->header->count.load(std::memory_order_relaxed) + pending;
+    }
+
+    void publish() {
+        size_t n = pendingCount();
+        pending = 0;
+        this->header->vertices.store(this->template column<uint64_t>(SharedFigureHeader::FirstVertex)[n],
+                                     std::memory_order_relaxed);
+        this->header->count.store(n, std::memory_order_release);
+    }
+
+    std::string name;
+    size_t length = 0;
+    size_t pending = 0;
+};
+
+// Read-only mapping of a store created by another process (or this one).
+template <Scalar T>
+class SharedFigureView : public SharedFigureColumns<T> {
+public:
+    explicit SharedFigureView(const std::string& name) {
+        int fd = ::shm_open(name.c_str(), O_RDONLY, 0);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open shared memory " + name);
+        struct stat st;
+        if (::fstat(fd, &st) < 0 || static_cast<size_t>(st.st_size) < sizeof(SharedFigureHeader)) {
+            ::close(fd);
+            throw std::runtime_error("Not a shared figure store: " + name);
+        }
+        length = static_cast<size_t>(st.st_size);
+        void* mapped = ::mmap(nullptr, length, PROT_READ, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+            throw std::runtime_error("Cannot map shared memory " + name);
+
+        auto* h = static_cast<const SharedFigureHeader*>(mapped);
+        if (h->magic.load(std::memory_order_acquire) != SharedFigureHeader::magicValue ||
+            h->version != SharedFigureHeader::currentVersion || h->segmentSize > length || !columnsFit(*h, length)) {
+            ::munmap(mapped, length);
+            throw std::runtime_error("Not a shared figure store: " + name);
+        }
+        this->attach(static_cast<unsigned char*>(mapped));
+    }
+
+    ~SharedFigureView() {
+        ::munmap(this->base, length);
+    }
+
+    SharedFigureView(const SharedFigureView&) = delete;
+    SharedFigureView& operator=(const SharedFigureView&) = delete;
+
+private:
+    // Every column, at its capacity, lies inside the mapping and is aligned
+    // for the atomic loads; the header comes from another process.
+    static bool columnsFit(const SharedFigureHeader& h, size_t length) {
+        if (h.capacity > length || h.vertexCapacity > length)
+            return false;
+        for (size_t c = 0; c < SharedFigureHeader::Columns; ++c) {
+            uint64_t offset = h.columns[c];
+            if (offset < sizeof(SharedFigureHeader) || offset % 64 != 0 || offset > length ||
+                SharedFigureHeader::columnBytes(c, h.capacity, h.vertexCapacity) > length - offset)
+                return false;
+        }
+        return true;
+    }
+
+    size_t length = 0;
+};
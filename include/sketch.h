@@ -0,0 +1,325 @@
+#pragma once
+
+#include "array.h"
+#include "box.h"
+#include "scheduler.h"
+#include "transform.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <random>
+#include <span>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// KLL quantile sketch. Values enter level 0; when a level outgrows its
+// capacity it is sorted and every other value moves one level up with twice
+// the weight. Capacities shrink by 2/3 per level below the top, so at most
+// about 3k values are kept for any stream length and the rank error stays
+// around 1.7/k. Sketches built with the same k merge level by level.
+class QuantileSketch {
+public:
+    explicit QuantileSketch(size_t k = 200) : k(k), levels(1), limit(k) {
+        if (k < 8)
+            throw std::invalid_argument("Sketch accuracy k must be at least 8");
+    }
+
+    void add(double value) {
+        if (std::isnan(value))
+            throw std::invalid_argument("Cannot add NaN to a sketch");
+        levels[0].push_back(value);
+        lowest = std::min(lowest, value);
+        highest = std::max(highest, value);
+        ++total;
+        if (++stored > limit)
+            compress();
+    }
+
+    void add(std::span<const double> values) {
+        for (double value : values)
+            add(value);
+    }
+
+    void merge(const QuantileSketch& other) {
+        if (other.k != k)
+            throw std::invalid_argument("Cannot merge sketches with different k");
+        if (levels.size() < other.levels.size()) {
+            levels.resize(other.levels.size());
+            limit = totalCapacity();
+        }
+        for (size_t h = 0; h < other.levels.size(); ++h)
+            levels[h].insert(levels[h].end(), other.levels[h].begin(), other.levels[h].end());
+        stored += other.stored;
+        lowest = std::min(lowest, other.lowest);
+        highest = std::max(highest, other.highest);
+        total += other.total;
+        compress();
+    }
+
+    uint64_t count() const {
+        return total;
+    }
+
+    bool empty() const {
+        return total == 0;
+    }
+
+    // Number of values actually stored.
+    size_t retained() const {
+        return stored;
+    }
+
+    double min() const {
+        checkNotEmpty();
+        return lowest;
+    }
+
+    double max() const {
+        checkNotEmpty();
+        return highest;
+    }
+
+    // Value whose rank is about q * count(); q = 0 and q = 1 are exact.
+    double quantile(double q) const {
+        checkNotEmpty();
+        if (!(q >= 0.0 && q <= 1.0))
+            throw std::invalid_argument("Quantile must be in [0, 1]");
+        if (q == 0.0)
+            return lowest;
+        if (q == 1.0)
+            return highest;
+
+        auto items = weighted();
+        double target = q * total;
+        uint64_t seen = 0;
+        for (const auto& [value, weight] : items) {
+            seen += weight;
+            if (seen >= target)
+                return value;
+        }
+        return highest;
+    }
+
+    // Estimated fraction of values <= value.
+    double rank(double value) const {
+        checkNotEmpty();
+        uint64_t below = 0;
+        for (size_t h = 0; h < levels.size(); ++h)
+            for (double v : levels[h])
+                if (v <= value)
+                    below += uint64_t(1) << h;
+        return static_cast<double>(below) / total;
+    }
+
+private:
+    void checkNotEmpty() const {
+        if (!total)
+            throw std::out_of_range("Sketch is empty");
+    }
+
+    size_t capacity(size_t level) const {
+        size_t depth = levels.size() - 1 - level;
+        return std::max<size_t>(2, static_cast<size_t>(std::ceil(k * std::pow(2.0 / 3.0, depth))));
+    }
+
+    size_t totalCapacity() const {
+        size_t n = 0;
+        for (size_t h = 0; h < levels.size(); ++h)
+            n += capacity(h);
+        return n;
+    }
+
+    // Compacts the lowest full level until the sketch fits its capacity again.
+    void compress() {
+        while (stored > limit) {
+            size_t h = 0;
+            while (levels[h].size() < capacity(h))
+                ++h;
+            if (h + 1 == levels.size()) {
+                levels.emplace_back();
+                limit = totalCapacity();
+            }
+
+            auto& level = levels[h];
+            std::sort(level.begin(), level.end());
+            // An odd value out stays at this level; of the rest, a coin flip
+            // picks whether the even or the odd positions move up.
+            size_t keep = level.size() % 2;
+            size_t offset = coin() & 1;
+            for (size_t i = keep + offset; i < level.size(); i += 2)
+                levels[h + 1].push_back(level[i]);
+            stored -= level.size() - keep - (level.size() - keep) / 2;
+            level.resize(keep);
+        }
+    }
+
+    std::vector<std::pair<double, uint64_t>> weighted() const {
+        std::vector<std::pair<double, uint64_t>> items;
+        items.reserve(retained());
+        for (size_t h = 0; h < levels.size(); ++h)
+            for (double v : levels[h])
+                items.emplace_back(v, uint64_t(1) << h);
+        std::sort(items.begin(), items.end());
+        return items;
+    }
+
+    size_t k;
+    std::vector<std::vector<double>> levels;
+    uint64_t total = 0;
+    double lowest = std::numeric_limits<double>::infinity();
+    double highest = -std::numeric_limits<double>::infinity();
+    size_t stored = 0;
+    size_t limit;
+    std::minstd_rand coin{0x6b6c6c};
+};
+
+// Fixed grid of counters over an extent; points outside it are only counted.
+template <Scalar T>
+class Histogram2D {
+public:
+    Histogram2D(const Box<T>& extent, size_t binsX, size_t binsY)
+        : extent(extent), binsX(binsX), binsY(binsY), counts(binsX * binsY) {
+        if (!binsX || !binsY)
+            throw std::invalid_argument("Histogram needs at least one bin per axis");
+        if (!(extent.minX < extent.maxX && extent.minY < extent.maxY))
+            throw std::invalid_argument("Histogram extent must have positive size");
+    }
+
+    void add(const Point<T>& p) {
+        if (!extent.contains(p)) {
+            ++outside;
+            return;
+        }
+        ++counts[binY(p.y()) * binsX + binX(p.x())];
+    }
+
+    void merge(const Histogram2D& other) {
+        if (!(other.extent == extent) || other.binsX != binsX || other.binsY != binsY)
+            throw std::invalid_argument("Cannot merge histograms with different bins");
+        for (size_t i = 0; i < counts.size(); ++i)
+            counts[i] += other.counts[i];
+        outside += other.outside;
+    }
+
+    uint64_t at(size_t x, size_t y) const {
+        if (x >= binsX || y >= binsY)
+            throw std::out_of_range("Bin out of range");
+        return counts[y * binsX + x];
+    }
+
+    Box<T> binBounds(size_t x, size_t y) const {
+        if (x >= binsX || y >= binsY)
+            throw std::out_of_range("Bin out of range");
+        return Box<T>(edge(extent.minX, extent.maxX, x, binsX), edge(extent.minY, extent.maxY, y, binsY),
+                      edge(extent.minX, extent.maxX, x + 1, binsX), edge(extent.minY, extent.maxY, y + 1, binsY));
+    }
+
+    uint64_t inside() const {
+        uint64_t n = 0;
+        for (uint64_t c : counts)
+            n += c;
+        return n;
+    }
+
+    uint64_t outliers() const {
+        return outside;
+    }
+
+    size_t width() const {
+        return binsX;
+    }
+
+    size_t height() const {
+        return binsY;
+    }
+
+private:
+    // Edge i of bins along [min, max], computed in double: a bin width in
+    // integer T would drop the remainder and leave the last bins short of
+    // the extent. For integer T the edge rounds up to the first value that
+    // binX/binY put into bin i.
+    static T edge(T min, T max, size_t i, size_t bins) {
+        if (i == bins)
+            return max;
+        double e = double(min) + (double(max) - double(min)) * double(i) / double(bins);
+        if constexpr (std::is_integral_v<T>)
+            return static_cast<T>(std::ceil(e));
+        else
+            return static_cast<T>(e);
+    }
+
+    size_t binX(T x) const {
+        double t = (double(x) - extent.minX) / (double(extent.maxX) - extent.minX);
+        return std::min(binsX - 1, static_cast<size_t>(t * binsX));
+    }
+
+    size_t binY(T y) const {
+        double t = (double(y) - extent.minY) / (double(extent.maxY) - extent.minY);
+        return std::min(binsY - 1, static_cast<size_t>(t * binsY));
+    }
+
+    Box<T> extent;
+    size_t binsX, binsY;
+    std::vector<uint64_t> counts;
+    uint64_t outside = 0;
+};
+
+// Area quantiles and center density of a figure stream in bounded memory.
+template <Scalar T>
+class FigureSketch {
+public:
+    FigureSketch(const Box<T>& extent, size_t binsX, size_t binsY, size_t k = 200)
+        : areaSketch(k), centerHistogram(extent, binsX, binsY) {}
+
+    void add(const Figure<T>& fig) {
+        areaSketch.add(static_cast<double>(fig));
+        centerHistogram.add(fig.center());
+    }
+
+    template <FigureContainer C>
+    void addAll(const C& figures) {
+        for (int i = 0; i < figures.getSize(); ++i)
+            add(asFigure(figures[i]));
+    }
+
+    void merge(const FigureSketch& other) {
+        areaSketch.merge(other.areaSketch);
+        centerHistogram.merge(other.centerHistogram);
+    }
+
+    const QuantileSketch& areas() const {
+        return areaSketch;
+    }
+
+    const Histogram2D<T>& centers() const {
+        return centerHistogram;
+    }
+
+private:
+    QuantileSketch areaSketch;
+    Histogram2D<T> centerHistogram;
+};
+
+// Builds one sketch per chunk on the scheduler and merges them.
+template <FigureContainer C>
+auto sketchFigures(const C& figures, const Box<FigureScalar<std::remove_cvref_t<decltype(figures[0])>>>& extent,
+                   size_t binsX, size_t binsY, size_t k = 200,
+                   TaskScheduler& scheduler = TaskScheduler::global()) {
+    using T = FigureScalar<std::remove_cvref_t<decltype(figures[0])>>;
+    FigureSketch<T> empty(extent, binsX, binsY, k);
+    return scheduler.parallelReduce(size_t(0), size_t(figures.getSize()), empty,
+        [&](size_t begin, size_t end) {
+            FigureSketch<T> sketch = empty;
+            for (size_t i = begin; i < end; ++i)
+                sketch.add(asFigure(figures[i]));
+            return sketch;
+        },
+        [](FigureSketch<T> a, const FigureSketch<T>& b) {
+            a.merge(b);
+            return a;
+        });
+}
@@ -1,111 +1,146 @@
-#pragma once
-
-#include "figure.h"
-
-#include <cmath>
-#include <array>
-
-template <Scalar T>
-class Square : public Figure<T> {
-public:
-    Square() {
-        for (auto& point : points)
-            point = std::make_unique<Point<T>>();
-    }
-
-    Square(const Point<T>& A, const Point<T>& B) {
-        calculatePoints(A, B);
-    }
-
-    Square(const Square& other) {
-        for (int i = 0; i < 4; ++i)
-            points[i] = std::make_unique<Point<T>>(*other.points[i]);
-    }
-
-    Square& operator=(const Square& other) {
-        if (this == &other)
-            return *this;
-        
-        for (int i = 0; i < 4; ++i)
-            points[i] = std::make_unique<Point<T>>(*other.points[i]);
-        
-        return *this;
-    }
-
-    Square(Square&& other) noexcept {
-        for (int i = 0; i < 4; ++i)
-            points[i] = std::move(other.points[i]);
-    }
-
-    Square& operator=(Square&& other) noexcept {
-        if (this == &other)
-            return *this;
-        
-        for (int i = 0; i < 4; ++i)
-            points[i] = std::move(other.points[i]);
-        
-        return *this;
-    }
-
-    Point<T> center() const override {
-        T sumX{0}, sumY{0};
-
-        for (const auto& point : points) {
-            sumX += point->x();
-            sumY += point->y();
-        }
-
-        return Point<T>(sumX / 4, sumY / 4);
-    }
-
-    operator double() const override {
-        T side = std::hypot(points[1]->x() - points[0]->x(),
-                            points[1]->y() - points[0]->y());
-        return static_cast<double>(side * side);
-    }
-
-    bool equals(const Figure<T>& other) const override {
-        const auto* otherSquare = dynamic_cast<const Square<T>*>(&other);
-        
-        if (!otherSquare)
-            return false;
-
-        for (size_t i = 0; i < 4; ++i)
-            if (*(points[i]) != *(otherSquare->points[i]))
-                return false;
-        
-        return true;
-    }
-
-protected:
-    void print(std::ostream& os) const override {
-        os << "Square: ";
-        for (const auto& point : points)
-            os << *point << " ";
-    }
-
-    void read(std::istream& is) override {
-        Point<T> A, B;
-        std::cout << "Enter bottom side points (A and B): ";
-        is >> A >> B;
-        calculatePoints(A, B);
-    }
-
-private:
-    std::array<std::unique_ptr<Point<T>>, 4> points;
-
-    void calculatePoints(const Point<T>& A, const Point<T>& B) {
-        T dx = B.x() - A.x();
-        T dy = B.y() - A.y();
-
-        if (dx == 0 && dy == 0) {
-            std::cout << "Points are identical, resetting to unit square.\n";
-            return calculatePoints(Point<T>(0,0), Point<T>(1,0));
-        }
-
-        points[0] = std::make_unique<Point<T>>(A);
-        points[1] = std::make_unique<Point<T>>(B);
-        points[2] = std::make_unique<Point<T>>(B.x() - dy, B.y() + dx);
-        points[3] = std::make_unique<Point<T>>(A.x() - dy, A.y() + dx);
-    }
+#pragma once
+
+#include "figure.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <array>
+
+template <Scalar T>
+class Square : public Figure<T> {
+public:
+    Square() {
+        for (auto& point : points)
+            point = std::make_unique<Point<T>>();
+    }
+
+    Square(const Point<T>& A, const Point<T>& B) {
+        calculatePoints(A, B);
+    }
+
+    Square(const Square& other) {
+        for (int i = 0; i < 4; ++i)
+            points[i] = std::make_unique<Point<T>>(*other.points[i]);
+    }
+
+    Square& operator=(const Square& other) {
+        if (this == &other)
+            return *this;
+        
+        for (int i = 0; i < 4; ++i)
+            points[i] = std::make_unique<Point<T>>(*other.points[i]);
+        
+        return *this;
+    }
+
+    Square(Square&& other) noexcept {
+        for (int i = 0; i < 4; ++i)
+            points[i] = std::move(other.points[i]);
+    }
+
+    Square& operator=(Square&& other) noexcept {
+        if (this == &other)
+            return *this;
+        
+        for (int i = 0; i < 4; ++i)
+            points[i] = std::move(other.points[i]);
+        
+        return *this;
+    }
+
+    // Restores a figure from its vertex(0..3) values without recomputing them.
+    static Square fromVertices(std::span<const Point<T>, 4> vertices) {
+        Square fig;
+        for (size_t i = 0; i < 4; ++i)
+            *fig.points[i] = vertices[i];
+        return fig;
+    }
+
+    Point<T> center() const override {
+        Point<T> sum;
+
+        for (const auto& point : points)
+            sum += *point;
+
+        return sum / 4;
+    }
+
+    operator double() const override {
+        return static_cast<double>((*points[1] - *points[0]).length2());
+    }
+
+    bool equals(const Figure<T>& other) const override {
+        const auto* otherSquare = dynamic_cast<const Square<T>*>(&other);
+        
+        if (!otherSquare)
+            return false;
+
+        for (size_t i = 0; i < 4; ++i)
+            if (*(points[i]) != *(otherSquare->points[i]))
+                return false;
+        
+        return true;
+    }
+
+    std::string_view name() const override {
+        return "Square";
+    }
+
+    size_t vertexCount() const override {
+        return 4;
+    }
+
+    Point<T> vertex(size_t index) const override {
+        if (index >= 4)
+            throw std::out_of_range("Vertex index out of range");
+        return *points[index];
+    }
+
+    bool contains(const Point<T>& p) const override {
+        // Project onto the two sides meeting at A: inside iff both projections
+        // fall within the side length. Done in double, like containsConvex.
+        Point<double> a(*points[0]);
+        Point<double> u = Point<double>(*points[1]) - a;
+        Point<double> v = Point<double>(*points[3]) - a;
+        Point<double> d = Point<double>(p) - a;
+
+        double du = d.dot(u), dv = d.dot(v);
+        return du >= 0 && du <= u.length2() && dv >= 0 && dv <= v.length2();
+    }
+
+protected:
+    void print(std::ostream& os) const override {
+        os << name() << ": ";
+        for (const auto& point : points)
+            os << *point << " ";
+    }
+
+    void read(std::istream& is) override {
+        Point<T> A, B;
+        std::cout << "Enter bottom side points (A and B): ";
+        is >> A >> B;
+        calculatePoints(A, B);
+    }
+
+    void applyTransform(const Affine2<T>& m) override {
+        for (auto& point : points)
+            *point = m.apply(*point);
+    }
+
+private:
+    std::array<std::unique_ptr<Point<T>>, 4> points;
+
+    void calculatePoints(const Point<T>& A, const Point<T>& B) {
+        Point<T> side = B - A;
+
+        if (side == Point<T>()) {
+            std::cout << "Points are identical, resetting to unit square.\n";
+            return calculatePoints(Point<T>(0,0), Point<T>(1,0));
+        }
+
+        points[0] = std::make_unique<Point<T>>(A);
+        points[1] = std::make_unique<Point<T>>(B);
+        points[2] = std::make_unique<Point<T>>(B + side.perp());
+        points[3] = std::make_unique<Point<T>>(A + side.perp());
+    }
 };
\ No newline at end of file
@@ -0,0 +1,124 @@
+#pragma once
+
+#include "point.h"
+
+#include <cerrno>
+#include <charconv>
+#include <concepts>
+#include <functional>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <unistd.h>
+
+// Buffered text output. Numbers are formatted with std::to_chars into one
+// reusable buffer that goes to the sink in large chunks; floating point uses
+// the shortest %g form with 6 significant digits, which is what a default
+// std::ostream prints, so output matches the operator<< based format byte for byte.
+class TextWriter {
+public:
+    static constexpr size_t bufferSize = 1 << 16;
+
+    explicit TextWriter(std::string& out)
+        : sink([&out](const char* data, size_t size) { out.append(data, size); }) {
+        buffer.resize(bufferSize);
+    }
+
+    explicit TextWriter(std::ostream& os)
+        : sink([&os](const char* data, size_t size) { os.write(data, static_cast<std::streamsize>(size)); }) {
+        buffer.resize(bufferSize);
+    }
+
+    explicit TextWriter(int fd) : sink([fd](const char* data, size_t size) { writeAll(fd, data, size); }) {
+        buffer.resize(bufferSize);
+    }
+
+    ~TextWriter() {
+        try {
+            flush();
+        } catch (...) {
+        }
+    }
+
+    TextWriter(const TextWriter&) = delete;
+    TextWriter& operator=(const TextWriter&) = delete;
+
+    void flush() {
+        if (used) {
+            sink(buffer.data(), used);
+            used = 0;
+        }
+    }
+
+    TextWriter& operator<<(std::string_view text) {
+        if (text.size() > bufferSize - used) {
+            flush();
+            if (text.size() > bufferSize) {
+                sink(text.data(), text.size());
+                return *this;
+            }
+        }
+        text.copy(buffer.data() + used, text.size());
+        used += text.size();
+        return *this;
+    }
+
+    TextWriter& operator<<(const char* text) {
+        return *this << std::string_view(text);
+    }
+
+    TextWriter& operator<<(char c) {
+        reserve(1);
+        buffer[used++] = c;
+        return *this;
+    }
+
+    template <typename N>
+        requires((std::integral<N> && !std::same_as<N, bool>) || std::floating_point<N>)
+    TextWriter& operator<<(N value) {
+        reserve(maxNumberLength);
+        char* first = buffer.data() + used;
+        std::to_chars_result result;
+
+        if constexpr (std::floating_point<N>)
+            result = std::to_chars(first, first + maxNumberLength, value, std::chars_format::general, 6);
+        else
+            result = std::to_chars(first, first + maxNumberLength, value);
+
+        used += result.ptr - first;
+        return *this;
+    }
+
+    template <Scalar T>
+    TextWriter& operator<<(const Point<T>& p) {
+        return *this << '(' << p.x() << ", " << p.y() << ')';
+    }
+
+private:
+    static constexpr size_t maxNumberLength = 64;
+
+    void reserve(size_t size) {
+        if (bufferSize - used < size)
+            flush();
+    }
+
+    static void writeAll(int fd, const char* data, size_t size) {
+        while (size) {
+            ssize_t written = ::write(fd, data, size);
+            if (written < 0) {
+                if (errno == EINTR)
+                    continue;
+                throw std::runtime_error("Failed to write output");
+            }
+            data += written;
+            size -= static_cast<size_t>(written);
+        }
+    }
+
+    std::function<void(const char*, size_t)> sink;
+    std::vector<char> buffer;
+    size_t used = 0;
+};
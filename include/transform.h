@@ -0,0 +1,94 @@
+#pragma once
+
+#include "array.h"
+#include "polygons.h"
+
+#include <utility>
+
+template <Scalar T>
+T scalarOf(const Figure<T>&);
+
+template <typename E>
+using FigureScalar = decltype(scalarOf(asFigure(std::declval<const E&>())));
+
+template <typename E>
+void transformAll(Array<E>& figures, const Affine2<FigureScalar<E>>& m) {
+    for (int i = 0; i < figures.getSize(); ++i)
+        asFigure(figures[i]).transform(m);
+}
+
+template <typename E>
+void translateAll(Array<E>& figures, FigureScalar<E> dx, FigureScalar<E> dy) {
+    transformAll(figures, Affine2<FigureScalar<E>>::translation(dx, dy));
+}
+
+template <typename E>
+void rotateAll(Array<E>& figures, double angle, const Point<FigureScalar<E>>& pivot = {}) {
+    transformAll(figures, Affine2<FigureScalar<E>>::rotation(angle, pivot));
+}
+
+template <typename E>
+void scaleAll(Array<E>& figures, FigureScalar<E> factor, const Point<FigureScalar<E>>& pivot = {}) {
+    transformAll(figures, Affine2<FigureScalar<E>>::scaling(factor, pivot));
+}
+
+// Collects transforms on an Array as one composed matrix and applies it in a
+// single pass the next time a figure is read through operator[] (or on flush).
+// Reading the Array directly bypasses the pending transform. Whatever is
+// still pending is applied on destruction; an exception from a figure there
+// is swallowed, so call flush() first where a failure must be seen.
+template <typename E>
+class LazyTransform {
+public:
+    using T = FigureScalar<E>;
+
+    explicit LazyTransform(Array<E>& figures) : figures(figures) {}
+
+    ~LazyTransform() {
+        try {
+            flush();
+        } catch (...) {
+        }
+    }
+
+    LazyTransform(const LazyTransform&) = delete;
+    LazyTransform& operator=(const LazyTransform&) = delete;
+
+    void transform(const Affine2<T>& m) {
+        if (!m.isSimilarity())
+            throw std::invalid_argument("Transform must be a rotation, uniform scale or translation");
+        pending = m * pending;
+    }
+
+    void translate(T dx, T dy) {
+        transform(Affine2<T>::translation(dx, dy));
+    }
+
+    void rotate(double angle, const Point<T>& pivot = Point<T>()) {
+        transform(Affine2<T>::rotation(angle, pivot));
+    }
+
+    void scale(T factor, const Point<T>& pivot = Point<T>()) {
+        transform(Affine2<T>::scaling(factor, pivot));
+    }
+
+    const Affine2<T>& pendingTransform() const {
+        return pending;
+    }
+
+    void flush() {
+        if (pending.isIdentity())
+            return;
+        transformAll(figures, pending);
+        pending = Affine2<T>();
+    }
+
+    const E& operator[](size_t index) {
+        flush();
+        return figures[index];
+    }
+
+private:
+    Array<E>& figures;
+    Affine2<T> pending;
+};
@@ -1,129 +1,155 @@
-#pragma once
-
-#include "figure.h"
-
-#include <cmath>
-
-template <Scalar T>
-class Triangle : public Figure<T> {
-public:
-    Triangle() {
-        for (auto& point : points)
-            point = std::make_unique<Point<T>>();
-    }
-
-    Triangle(const Point<T>& A, const Point<T>& B, T h) {
-        calculatePoints(A, B, h);
-    }
-
-    Triangle(const Triangle& other) {
-        for (int i = 0; i < 3; ++i)
-            points[i] = std::make_unique<Point<T>>(*other.points[i]);
-    }
-
-    Triangle& operator=(const Triangle& other) {
-        if (this == &other)
-            return *this;
-        
-        for (int i = 0; i < 3; ++i)
-            points[i] = std::make_unique<Point<T>>(*other.points[i]);
-        
-        return *this;
-    }
-
-    Triangle(Triangle&& other) noexcept {
-        for (int i = 0; i < 3; ++i)
-            points[i] = std::move(other.points[i]);
-    }
-
-    Triangle& operator=(Triangle&& other) noexcept {
-        if (this == &other)
-            return *this;
-        
-        for (int i = 0; i < 3; ++i)
-            points[i] = std::move(other.points[i]);
-        
-        return *this;
-    }
-
-    Point<T> center() const override {
-        T sumX{0}, sumY{0};
-
-        for (const auto& point : points) {
-            sumX += point->x();
-            sumY += point->y();
-        }
-
-        return Point<T>(sumX / 3, sumY / 3);
-    }
-
-    operator double() const override {
-        T base = std::hypot(points[1]->x() - points[0]->x(),
-                            points[1]->y() - points[0]->y());
-
-        Point<T> middle_of_base = Point<T>((points[0]->x() + points[1]->x()) / 2,
-                                           (points[0]->y() + points[1]->y()) / 2);
-        
-        T height = std::hypot(points[2]->x() - middle_of_base.x(),
-                              points[2]->y() - middle_of_base.y());
-        
-        return static_cast<double>(0.5 * base * height);
-    }
-
-    bool equals(const Figure<T>& other) const override {
-        const auto* otherTriangle = dynamic_cast<const Triangle<T>*>(&other);
-        
-        if (!otherTriangle)
-            return false;
-
-        for (size_t i = 0; i < 3; ++i)
-            if (*(points[i]) != *(otherTriangle->points[i]))
-                return false;
-        
-        return true;
-    }
-
-protected:
-    void print(std::ostream& os) const override {
-        os << "Triangle: ";
-        for (const auto& point : points)
-            os << *point << " ";
-    }
-
-    void read(std::istream& is) override {
-        Point<T> A, B;
-        T h;
-        std::cout << "Enter base points (A and B) and height (h): ";
-        is >> A >> B >> h;
-        calculatePoints(A, B, h);
-    }
-
-private:
-    std::array<std::unique_ptr<Point<T>>, 3> points;
-
-    void calculatePoints(const Point<T>& A, const Point<T>& B, T h) {
-        if (h <= 0) {
-            std::cout << "Height must be positive, resetting to unit triangle.\n";
-            return calculatePoints(Point<T>(0,0), Point<T>(1,0), 1);
-        }
-        
-        T dx = B.x() - A.x();
-        T dy = B.y() - A.y();
-        T length = std::hypot(dx, dy);
-
-        if (!length) {
-            std::cout << "Points are identical, resetting to unit triangle.\n";
-            return calculatePoints(Point<T>(0,0), Point<T>(1,0), 1);
-        }
-
-        T nx = -dy / length;
-        T ny = dx / length;
-
-        T midX = (A.x() + B.x()) / 2;
-        T midY = (A.y() + B.y()) / 2;
-
-        points[0] = std::make_unique<Point<T>>(A);
-        points[1] = std::make_unique<Point<T>>(B);
-        points[2] = std::make_unique<Point<T>>(midX + nx * h, midY + ny * h);
-    }
+#pragma once
+
+#include "figure.h"
+
+#include <cmath>
+#include <stdexcept>
+
+template <Scalar T>
+class Triangle : public Figure<T> {
+public:
+    Triangle() {
+        for (auto& point : points)
+            point = std::make_unique<Point<T>>();
+    }
+
+    Triangle(const Point<T>& A, const Point<T>& B, T h) {
+        calculatePoints(A, B, h);
+    }
+
+    Triangle(const Triangle& other) {
+        for (int i = 0; i < 3; ++i)
+            points[i] = std::make_unique<Point<T>>(*other.points[i]);
+    }
+
+    Triangle& operator=(const Triangle& other) {
+        if (this == &other)
+            return *this;
+        
+        for (int i = 0; i < 3; ++i)
+            points[i] = std::make_unique<Point<T>>(*other.points[i]);
+        
+        return *this;
+    }
+
+    Triangle(Triangle&& other) noexcept {
+        for (int i = 0; i < 3; ++i)
+            points[i] = std::move(other.points[i]);
+    }
+
+    Triangle& operator=(Triangle&& other) noexcept {
+        if (this == &other)
+            return *this;
+        
+        for (int i = 0; i < 3; ++i)
+            points[i] = std::move(other.points[i]);
+        
+        return *this;
+    }
+
+    // Restores a figure from its vertex(0..2) values without recomputing them.
+    static Triangle fromVertices(std::span<const Point<T>, 3> vertices) {
+        Triangle fig;
+        for (size_t i = 0; i < 3; ++i)
+            *fig.points[i] = vertices[i];
+        return fig;
+    }
+
+    Point<T> center() const override {
+        Point<T> sum;
+
+        for (const auto& point : points)
+            sum += *point;
+
+        return sum / 3;
+    }
+
+    operator double() const override {
+        Point<T> middle_of_base = (*points[0] + *points[1]) / 2;
+
+        Point<T> side = *points[1] - *points[0];
+        Point<T> apex = *points[2] - middle_of_base;
+        double base = std::hypot(static_cast<double>(side.x()), static_cast<double>(side.y()));
+        double height = std::hypot(static_cast<double>(apex.x()), static_cast<double>(apex.y()));
+
+        return 0.5 * base * height;
+    }
+
+    bool equals(const Figure<T>& other) const override {
+        const auto* otherTriangle = dynamic_cast<const Triangle<T>*>(&other);
+        
+        if (!otherTriangle)
+            return false;
+
+        for (size_t i = 0; i < 3; ++i)
+            if (*(points[i]) != *(otherTriangle->points[i]))
+                return false;
+        
+        return true;
+    }
+
+    std::string_view name() const override {
+        return "Triangle";
+    }
+
+    size_t vertexCount() const override {
+        return 3;
+    }
+
+    Point<T> vertex(size_t index) const override {
+        if (index >= 3)
+            throw std::out_of_range("Vertex index out of range");
+        return *points[index];
+    }
+
+    bool contains(const Point<T>& p) const override {
+        return Figure<T>::containsConvex(points, p);
+    }
+
+protected:
+    void print(std::ostream& os) const override {
+        os << name() << ": ";
+        for (const auto& point : points)
+            os << *point << " ";
+    }
+
+    void read(std::istream& is) override {
+        Point<T> A, B;
+        T h;
+        std::cout << "Enter base points (A and B) and height (h): ";
+        is >> A >> B >> h;
+        calculatePoints(A, B, h);
+    }
+
+    void applyTransform(const Affine2<T>& m) override {
+        for (auto& point : points)
+            *point = m.apply(*point);
+    }
+
+private:
+    std::array<std::unique_ptr<Point<T>>, 3> points;
+
+    void calculatePoints(const Point<T>& A, const Point<T>& B, T h) {
+        if (h <= 0) {
+            std::cout << "Height must be positive, resetting to unit triangle.\n";
+            return calculatePoints(Point<T>(0,0), Point<T>(1,0), 1);
+        }
+        
+        Point<T> side = B - A;
+        // hypot, not sqrt(length2()): the square overflows or underflows T
+        // long before the length does.
+        T length = static_cast<T>(std::hypot(static_cast<double>(side.x()), static_cast<double>(side.y())));
+
+        if (!length) {
+            std::cout << "Points are identical, resetting to unit triangle.\n";
+            return calculatePoints(Point<T>(0,0), Point<T>(1,0), 1);
+        }
+
+        Point<T> normal = side.perp() / length;
+        Point<T> middle = (A + B) / 2;
+
+        points[0] = std::make_unique<Point<T>>(A);
+        points[1] = std::make_unique<Point<T>>(B);
+        points[2] = std::make_unique<Point<T>>(middle + normal * h);
+    }
 };
\ No newline at end of file
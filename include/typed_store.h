@@ -0,0 +1,65 @@
+#pragma once
+
+#include "array.h"
+#include "square.h"
+#include "triangle.h"
+#include "octagon.h"
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+
+// Figures kept by value in one Array per type, so a scan over one type
+// touches only that type's elements and needs no virtual dispatch.
+template <Scalar T>
+class TypedFigureStore {
+public:
+    void add(const Square<T>& fig) {
+        squareItems.add(fig);
+    }
+
+    void add(const Triangle<T>& fig) {
+        triangleItems.add(fig);
+    }
+
+    void add(const Octagon<T>& fig) {
+        octagonItems.add(fig);
+    }
+
+    void add(const Figure<T>& fig) {
+        if (auto* sq = dynamic_cast<const Square<T>*>(&fig))
+            add(*sq);
+        else if (auto* tri = dynamic_cast<const Triangle<T>*>(&fig))
+            add(*tri);
+        else if (auto* oct = dynamic_cast<const Octagon<T>*>(&fig))
+            add(*oct);
+        else
+            throw std::invalid_argument("Unsupported figure type: " + std::string(fig.name()));
+    }
+
+    int getSize() const {
+        return squareItems.getSize() + triangleItems.getSize() + octagonItems.getSize();
+    }
+
+    const Array<Square<T>>& squares() const {
+        return squareItems;
+    }
+
+    const Array<Triangle<T>>& triangles() const {
+        return triangleItems;
+    }
+
+    const Array<Octagon<T>>& octagons() const {
+        return octagonItems;
+    }
+
+    auto segments() const {
+        return std::tie(squareItems, triangleItems, octagonItems);
+    }
+
+private:
+    Array<Square<T>> squareItems;
+    Array<Triangle<T>> triangleItems;
+    Array<Octagon<T>> octagonItems;
+};
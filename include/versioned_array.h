@@ -0,0 +1,270 @@
+#pragma once
+
+#include "array.h"
+
+#include <algorithm>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+// Array whose readers work on immutable snapshots.
+//
+// Elements live in fixed-size chunks that are never modified once
+// published. A write copies only the chunks it touches (the last one for
+// add, the chunk of the element for set, the chunks from the index onwards
+// for remove), shares the rest with the previous version and publishes the
+// new version with one atomic store. addAll pays that once for a whole
+// batch instead of once per element. snapshot() is a shared_ptr copy, so a
+// long report can run on a snapshot while other threads keep writing.
+// Writers are serialized by a mutex; readers never take it.
+template <typename T>
+class VersionedArray {
+    using Chunk = std::vector<T>;
+
+    struct Version {
+        std::vector<std::shared_ptr<const Chunk>> chunks;
+        size_t size = 0;
+        uint64_t number = 0;
+    };
+
+public:
+    static constexpr size_t defaultChunkSize = 256;
+
+    class Snapshot {
+    public:
+        class Iterator {
+        public:
+            using iterator_category = std::forward_iterator_tag;
+            using value_type = T;
+            using difference_type = std::ptrdiff_t;
+            using pointer = const T*;
+            using reference = const T&;
+
+            Iterator() = default;
+            Iterator(const Snapshot* owner, size_t index) : owner(owner), index(index) {}
+
+            reference operator*() const {
+                return owner->at(index);
+            }
+
+            pointer operator->() const {
+                return &owner->at(index);
+            }
+
+            Iterator& operator++() {
+                ++index;
+                return *this;
+            }
+
+            Iterator operator++(int) {
+                Iterator old = *this;
+                ++index;
+                return old;
+            }
+
+            bool operator==(const Iterator& other) const {
+                return index == other.index;
+            }
+
+        private:
+            const Snapshot* owner = nullptr;
+            size_t index = 0;
+        };
+
+        Snapshot(std::shared_ptr<const Version> version, size_t chunkSize)
+            : version(std::move(version)), chunkSize(chunkSize) {}
+
+        int getSize() const {
+            return static_cast<int>(version->size);
+        }
+
+        uint64_t number() const {
+            return version->number;
+        }
+
+        const T& operator[](size_t index) const {
+            if (index >= version->size)
+                throw std::out_of_range("Index out of range");
+            return at(index);
+        }
+
+        Iterator begin() const {
+            return Iterator(this, 0);
+        }
+
+        Iterator end() const {
+            return Iterator(this, version->size);
+        }
+
+        void printAll() const {
+            TextWriter out(std::cout);
+            printAll(out);
+        }
+
+        void printAll(TextWriter& out) const {
+            printFigures(*this, out);
+        }
+
+        void printCenters() const {
+            TextWriter out(std::cout);
+            printCenters(out);
+        }
+
+        void printCenters(TextWriter& out) const {
+            printFigureCenters(*this, out);
+        }
+
+        void printTotalArea() const {
+            TextWriter out(std::cout);
+            printTotalArea(out);
+        }
+
+        void printTotalArea(TextWriter& out) const {
+            printFiguresTotalArea(*this, out);
+        }
+
+    private:
+        const T& at(size_t index) const {
+            return (*version->chunks[index / chunkSize])[index % chunkSize];
+        }
+
+        std::shared_ptr<const Version> version;
+        size_t chunkSize;
+    };
+
+    explicit VersionedArray(size_t chunkSize = defaultChunkSize)
+        : chunkSize(chunkSize), current(std::make_shared<const Version>()) {
+        if (!chunkSize)
+            throw std::invalid_argument("Chunk size must be positive");
+    }
+
+    VersionedArray(const VersionedArray&) = delete;
+    VersionedArray& operator=(const VersionedArray&) = delete;
+
+    Snapshot snapshot() const {
+        return Snapshot(current.load(std::memory_order_acquire), chunkSize);
+    }
+
+    int getSize() const {
+        return static_cast<int>(current.load(std::memory_order_acquire)->size);
+    }
+
+    template <typename U>
+    void add(U&& fig) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        Version next = *current.load(std::memory_order_relaxed);
+
+        if (next.size % chunkSize == 0) {
+            auto chunk = std::make_shared<Chunk>();
+            chunk->reserve(chunkSize);
+            chunk->push_back(std::forward<U>(fig));
+            next.chunks.push_back(std::move(chunk));
+        } else {
+            auto chunk = std::make_shared<Chunk>(*next.chunks.back());
+            chunk->push_back(std::forward<U>(fig));
+            next.chunks.back() = std::move(chunk);
+        }
+        ++next.size;
+        publish(std::move(next));
+    }
+
+    // Appends the batch as one version: the chunk table and the partly
+    // filled last chunk are copied once, not once per element as with add.
+    void addAll(std::vector<T> batch) {
+        if (batch.empty())
+            return;
+        std::lock_guard<std::mutex> lock(writeMutex);
+        Version next = *current.load(std::memory_order_relaxed);
+
+        std::shared_ptr<Chunk> open;
+        if (next.size % chunkSize) {
+            open = std::make_shared<Chunk>(*next.chunks.back());
+            open->reserve(chunkSize);
+            next.chunks.back() = open;
+        }
+        for (auto& item : batch) {
+            if (next.size % chunkSize == 0) {
+                open = std::make_shared<Chunk>();
+                open->reserve(chunkSize);
+                next.chunks.push_back(open);
+            }
+            open->push_back(std::move(item));
+            ++next.size;
+        }
+        publish(std::move(next));
+    }
+
+    template <typename U>
+    void set(size_t index, U&& fig) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        Version next = *current.load(std::memory_order_relaxed);
+        if (index >= next.size)
+            throw std::out_of_range("Index out of range");
+
+        auto& slot = next.chunks[index / chunkSize];
+        auto chunk = std::make_shared<Chunk>(*slot);
+        (*chunk)[index % chunkSize] = std::forward<U>(fig);
+        slot = std::move(chunk);
+        publish(std::move(next));
+    }
+
+    void remove(size_t index) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        Version next = *current.load(std::memory_order_relaxed);
+        if (!next.size)
+            throw std::out_of_range("Array is empty");
+        if (index >= next.size)
+            throw std::out_of_range("Index out of range");
+
+        // Everything from the removed element onwards shifts left by one.
+        size_t first = index / chunkSize;
+        Chunk tail;
+        tail.reserve(next.size - first * chunkSize);
+        for (size_t c = first; c < next.chunks.size(); ++c)
+            tail.insert(tail.end(), next.chunks[c]->begin(), next.chunks[c]->end());
+        tail.erase(tail.begin() + (index - first * chunkSize));
+
+        next.chunks.resize(first);
+        for (size_t i = 0; i < tail.size(); i += chunkSize) {
+            size_t end = std::min(i + chunkSize, tail.size());
+            next.chunks.push_back(std::make_shared<const Chunk>(tail.begin() + i, tail.begin() + end));
+        }
+        --next.size;
+        publish(std::move(next));
+        if (verbose)
+            std::cout << "Element at index " << index << " removed.\n";
+    }
+
+    // Turns the per-operation messages (as in Array::remove) on or off.
+    void setVerbose(bool enabled) {
+        std::lock_guard<std::mutex> lock(writeMutex);
+        verbose = enabled;
+    }
+
+    void printAll() const {
+        snapshot().printAll();
+    }
+
+    void printCenters() const {
+        snapshot().printCenters();
+    }
+
+    void printTotalArea() const {
+        snapshot().printTotalArea();
+    }
+
+private:
+    void publish(Version&& next) {
+        next.number = ++versions;
+        current.store(std::make_shared<const Version>(std::move(next)), std::memory_order_release);
+    }
+
+    size_t chunkSize;
+    std::atomic<std::shared_ptr<const Version>> current;
+    std::mutex writeMutex;
+    uint64_t versions = 0;
+    bool verbose = true;  // guarded by writeMutex
+};
@@ -0,0 +1,240 @@
+#pragma once
+
+#include "binary_format.h"
+#include "figure.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+// FIFO over a power-of-two buffer. Grows by doubling only when it is full,
+// so a window whose evictions keep pace with inserts never allocates again.
+template <typename T>
+class RingBuffer {
+public:
+    explicit RingBuffer(size_t capacity = 16) {
+        size_t n = 1;
+        while (n < capacity)
+            n <<= 1;
+        items = std::make_unique<T[]>(n);
+        mask = n - 1;
+    }
+
+    void push(T item) {
+        if (count == capacity())
+            grow();
+        items[(head + count) & mask] = std::move(item);
+        ++count;
+    }
+
+    T pop() {
+        if (!count)
+            throw std::out_of_range("Ring buffer is empty");
+        T item = std::move(items[head]);
+        head = (head + 1) & mask;
+        --count;
+        return item;
+    }
+
+    const T& front() const {
+        if (!count)
+            throw std::out_of_range("Ring buffer is empty");
+        return items[head];
+    }
+
+    const T& operator[](size_t index) const {
+        if (index >= count)
+            throw std::out_of_range("Index out of range");
+        return items[(head + index) & mask];
+    }
+
+    size_t size() const {
+        return count;
+    }
+
+    bool empty() const {
+        return count == 0;
+    }
+
+    size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    void grow() {
+        size_t n = capacity() * 2;
+        auto bigger = std::make_unique<T[]>(n);
+        for (size_t i = 0; i < count; ++i)
+            bigger[i] = std::move(items[(head + i) & mask]);
+        items = std::move(bigger);
+        head = 0;
+        mask = n - 1;
+    }
+
+    std::unique_ptr<T[]> items;
+    size_t mask = 0;
+    size_t head = 0;
+    size_t count = 0;
+};
+
+using WindowClock = std::chrono::steady_clock;
+
+// Aggregates of the figures currently in a window.
+struct WindowStats {
+    uint64_t count = 0;
+    double totalArea = 0.0;
+    std::array<uint64_t, BinaryFormat::kinds> perKind{};
+
+    uint64_t countOf(FigureKind kind) const {
+        return perKind[static_cast<size_t>(kind)];
+    }
+
+    double averageArea() const {
+        return count ? totalArea / count : 0.0;
+    }
+};
+
+// What a window keeps per figure: enough to undo its contribution.
+struct WindowEntry {
+    WindowClock::time_point time;
+    double area = 0.0;
+    FigureKind kind = FigureKind::Square;
+};
+
+// Rolling aggregates over the last N figures or the last span of time.
+// Inserts add to the aggregates and evictions subtract from them, so both
+// are O(1); only the per-figure entries are stored, never the figures.
+template <Scalar T>
+class SlidingWindow {
+public:
+    static SlidingWindow lastFigures(size_t figures) {
+        if (!figures)
+            throw std::invalid_argument("Window must hold at least one figure");
+        return SlidingWindow(figures, WindowClock::duration::max());
+    }
+
+    static SlidingWindow lastDuration(WindowClock::duration span) {
+        if (span <= WindowClock::duration::zero())
+            throw std::invalid_argument("Window duration must be positive");
+        return SlidingWindow(0, span);
+    }
+
+    void add(const Figure<T>& fig, WindowClock::time_point now = WindowClock::now()) {
+        WindowEntry entry{now, static_cast<double>(fig), BinaryFormat::kindOf(fig)};
+        if (maxFigures && entries.size() == maxFigures)
+            evict();
+        entries.push(entry);
+        ++current.count;
+        current.totalArea += entry.area;
+        ++current.perKind[static_cast<size_t>(entry.kind)];
+        advance(now);
+    }
+
+    // Drops the figures older than the window span as of `now`.
+    void advance(WindowClock::time_point now = WindowClock::now()) {
+        if (span == WindowClock::duration::max())
+            return;
+        while (!entries.empty() && now - entries.front().time >= span)
+            evict();
+    }
+
+    const WindowStats& stats() const {
+        return current;
+    }
+
+    size_t size() const {
+        return entries.size();
+    }
+
+    size_t capacity() const {
+        return entries.capacity();
+    }
+
+private:
+    SlidingWindow(size_t maxFigures, WindowClock::duration span)
+        : entries(maxFigures ? maxFigures : 16), maxFigures(maxFigures), span(span) {}
+
+    void evict() {
+        WindowEntry entry = entries.pop();
+        --current.count;
+        --current.perKind[static_cast<size_t>(entry.kind)];
+        // Subtracting rounds differently than adding did; an empty window
+        // restarts from an exact zero so the drift cannot accumulate forever.
+        current.totalArea = current.count ? current.totalArea - entry.area : 0.0;
+    }
+
+    RingBuffer<WindowEntry> entries;
+    size_t maxFigures;
+    WindowClock::duration span;
+    WindowStats current;
+};
+
+// Consecutive non-overlapping windows of N figures or a fixed span of time.
+// When a window closes its aggregates go to the callback and counting
+// restarts; nothing per figure is kept at all.
+template <Scalar T>
+class TumblingWindow {
+public:
+    using Callback = std::function<void(const WindowStats&)>;
+
+    static TumblingWindow everyFigures(size_t figures, Callback onClose) {
+        if (!figures)
+            throw std::invalid_argument("Window must hold at least one figure");
+        return TumblingWindow(figures, WindowClock::duration::max(), std::move(onClose));
+    }
+
+    static TumblingWindow everyDuration(WindowClock::duration span, Callback onClose) {
+        if (span <= WindowClock::duration::zero())
+            throw std::invalid_argument("Window duration must be positive");
+        return TumblingWindow(0, span, std::move(onClose));
+    }
+
+    void add(const Figure<T>& fig, WindowClock::time_point now = WindowClock::now()) {
+        advance(now);
+        if (!current.count)
+            opened = now;
+        ++current.count;
+        current.totalArea += static_cast<double>(fig);
+        ++current.perKind[static_cast<size_t>(BinaryFormat::kindOf(fig))];
+        if (maxFigures && current.count == maxFigures)
+            flush();
+    }
+
+    // Closes the open window if its span has passed as of `now`.
+    void advance(WindowClock::time_point now = WindowClock::now()) {
+        if (current.count && span != WindowClock::duration::max() && now - opened >= span)
+            flush();
+    }
+
+    // Closes the open window early; an empty window is not reported.
+    void flush() {
+        if (!current.count)
+            return;
+        WindowStats closed = std::exchange(current, WindowStats{});
+        ++closedWindows;
+        onClose(closed);
+    }
+
+    const WindowStats& stats() const {
+        return current;
+    }
+
+    uint64_t windowsClosed() const {
+        return closedWindows;
+    }
+
+private:
+    TumblingWindow(size_t maxFigures, WindowClock::duration span, Callback onClose)
+        : maxFigures(maxFigures), span(span), onClose(std::move(onClose)) {}
+
+    size_t maxFigures;
+    WindowClock::duration span;
+    Callback onClose;
+    WindowStats current;
+    WindowClock::time_point opened;
+    uint64_t closedWindows = 0;
+};
@@ -1,176 +1,280 @@
-/*
-    Вариант 16. 
-    Фигуры: 8-угольник | Треугольник | Квадрат
-*/
-
-#include "array.h"
-#include "triangle.h"
-#include "square.h"
-#include "octagon.h"
-
-#include <climits>
-#include <iostream>
-#include <memory>
-
-void cinClear() {
-    std::cin.clear();
-    std::cin.ignore(INT_MAX, '\n');
-}
-
-template <typename T>
-T readNumer(const std::string& prompt) {
-    T value;
-    std::cout << prompt;
-    if (std::cin >> value) {
-        cinClear();
-        return value;
-    }
-    cinClear();
-    return -1;
-}
-
-int readInt(const std::string& prompt) {
-    return readNumer<int>(prompt);
-}
-
-double readDouble(const std::string& prompt) {
-    return readNumer<double>(prompt);
-}
-
-int main() {    
-    Array<std::shared_ptr<Figure<double>>> baseFigures;
-
-    baseFigures.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0)));
-    baseFigures.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(1, 0), 1.0));
-    baseFigures.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
-
-    std::cout << "\nBase container (Array<std::shared_ptr<Figure<double>>>):\n";
-    baseFigures.printAll();
-
-    std::cout << "\nCenters:\n";
-    baseFigures.printCenters();
-
-    std::cout << "\n";
-    baseFigures.printTotalArea();
-
-    
-    Array<Square<double>> squares;
-
-    auto sq = Square<double>(Point<double>(0, 0), Point<double>(2, 0));
-
-    squares.add(sq);
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
-
-    std::cout << "\nThe Legacy Container (Array<Square<double>>):\n";
-    squares.printAll();
-
-    std::cout << "\nCenters:\n";
-    squares.printCenters();
-
-    std::cout << "\n";
-    squares.printTotalArea();
-
-    
-    std::cout << "\n\n=== Switching to interactive mode ===\n";
-
-    Array<std::shared_ptr<Figure<double>>> figures;
-
-    while (true) {
-        std::cout << "\nMenu:\n"
-                  << "1. Add Figure\n"
-                  << "2. Remove Figure\n"
-                  << "3. Print All Figures\n"
-                  << "4. Print Centers\n"
-                  << "5. Total Area\n"
-                  << "0. Exit\n"
-                  << "-> ";
-
-        int choice = readInt("");
-
-        switch (choice) {
-            case 0:
-                std::cout << "Exiting...\n\n";
-                return 0;
-
-            case 1: {
-                std::cout << "Select Figure Type:\n"
-                          << "  1. Square\n"
-                          << "  2. Triangle\n"
-                          << "  3. Octagon\n"
-                          << "  -> ";
-
-                int figureType = readInt("");
-
-                switch (figureType) {
-                    case 1: {
-                        auto sq = std::make_shared<Square<double>>();
-                        std::cin >> *sq;
-                        figures.add(sq);
-                        break;
-                    }
-                    case 2: {
-                        auto tri = std::make_shared<Triangle<double>>();
-                        std::cin >> *tri;
-                        figures.add(tri);
-                        break;
-                    }
-                    case 3: {
-                        auto oct = std::make_shared<Octagon<double>>();
-                        std::cin >> *oct;
-                        figures.add(oct);
-                        break;
-                    }
-                    default:
-                        std::cout << "Invalid figure type.\n";
-                        break;
-                }
-                break;
-            }
-
-            case 2: {
-                if (!figures.getSize()) {
-                    std::cout << "Array is empty.\n";
-                    break;
-                }
-
-                int index = readInt("Enter index of figure to remove: ");
-                try {
-                    figures.remove(index);
-                } catch (const std::out_of_range& e) {
-                    std::cout << e.what() << "\n";
-                }
-                break;
-            }
-
-            case 3:
-                try {
-                    figures.printAll();
-                } catch (const std::out_of_range& e) {
-                    std::cout << e.what() << "\n";
-                }
-                break;
-
-            case 4:
-                try {
-                    figures.printCenters();
-                } catch (const std::out_of_range& e) {
-                    std::cout << e.what() << "\n";
-                }
-                break;
-
-            case 5:
-                try {
-                    figures.printTotalArea();
-                } catch (const std::out_of_range& e) {
-                    std::cout << e.what() << "\n";
-                }
-                break;
-
-            default:
-                std::cout << "Invalid choice. Try a number between 0 and 5.\n";
-                break;
-        }
-    }
-
-    return 0;
+/*
+    Вариант 16. 
+    Фигуры: 8-угольник | Треугольник | Квадрат
+*/
+
+#include "array.h"
+#include "triangle.h"
+#include "square.h"
+#include "octagon.h"
+#include "figure_store.h"
+#include "batch.h"
+#include "server.h"
+
+#include <climits>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+
+void cinClear() {
+    std::cin.clear();
+    std::cin.ignore(INT_MAX, '\n');
+}
+
+template <typename T>
+T readNumer(const std::string& prompt) {
+    T value;
+    std::cout << prompt;
+    if (std::cin >> value) {
+        cinClear();
+        return value;
+    }
+    cinClear();
+    return -1;
+}
+
+int readInt(const std::string& prompt) {
+    return readNumer<int>(prompt);
+}
+
+double readDouble(const std::string& prompt) {
+    return readNumer<double>(prompt);
+}
+
+FigureServer<double>* runningServer = nullptr;
+
+void stopServer(int) {
+    if (runningServer)
+        runningServer->stop();
+}
+
+// Usage: HW4_VAR16 [--store DIR] [--script FILE|-] [--quiet]
+//        HW4_VAR16 [--store DIR] --serve SOCKET
+//        HW4_VAR16 --loadgen SOCKET
+// With --store the figures are kept in DIR (snapshot + log) and restored on
+// the next start. With --script the commands of FILE (or stdin for '-') are
+// run without the demo and the menu, see BatchRunner. --quiet drops the
+// per-operation messages. --serve shares the figures with other processes
+// over a Unix domain socket until SIGINT/SIGTERM, see FigureServer, and
+// --loadgen measures such a server.
+int main(int argc, char** argv) {
+    std::string storeDir, script, serveSocket, loadSocket;
+    bool quiet = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--store" && i + 1 < argc) {
+            storeDir = argv[++i];
+        } else if (arg == "--script" && i + 1 < argc) {
+            script = argv[++i];
+        } else if (arg == "--serve" && i + 1 < argc) {
+            serveSocket = argv[++i];
+        } else if (arg == "--loadgen" && i + 1 < argc) {
+            loadSocket = argv[++i];
+        } else if (arg == "--quiet") {
+            quiet = true;
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--store DIR] [--script FILE|-] [--quiet]\n"
+                      << "       " << argv[0] << " [--store DIR] --serve SOCKET\n"
+                      << "       " << argv[0] << " --loadgen SOCKET\n";
+            return 1;
+        }
+    }
+
+    if (!loadSocket.empty()) {
+        LoadOptions options;
+        LoadReport report = runLoad(loadSocket, options);
+        std::cout << report.requests << " requests (" << report.commands << " commands) over "
+                  << options.connections << " connections in " << report.seconds << " s: "
+                  << report.requests / report.seconds << " requests/s\n"
+                  << "latency us: p50 " << report.p50 << ", p90 " << report.p90 << ", p99 " << report.p99
+                  << ", max " << report.max << "\n";
+        return 0;
+    }
+
+    // Interactive changes are made durable one by one; a script commits in
+    // groups and once more when the store closes, and the server commits
+    // every batch of requests before answering it.
+    bool interactive = script.empty() && serveSocket.empty();
+    std::unique_ptr<FigureStore<double>> store;
+    if (!storeDir.empty())
+        store = std::make_unique<FigureStore<double>>(
+            storeDir, interactive ? FigureStore<double>::Options{1, 1024} : FigureStore<double>::Options{});
+
+    if (!serveSocket.empty()) {
+        FigureServer<double> server(serveSocket, store.get());
+        runningServer = &server;
+        std::signal(SIGINT, stopServer);
+        std::signal(SIGTERM, stopServer);
+        std::signal(SIGPIPE, SIG_IGN);
+        std::cout << "Serving " << server.figures().getSize() << " figures on " << serveSocket << std::endl;
+        server.run();
+        runningServer = nullptr;
+        return 0;
+    }
+
+    if (!script.empty()) {
+        std::ifstream file;
+        if (script != "-") {
+            file.open(script);
+            if (!file) {
+                std::cerr << "Cannot open " << script << "\n";
+                return 1;
+            }
+        }
+
+        TextWriter out(std::cout);
+        BatchRunner<double> runner(out, std::cerr, store.get());
+        runner.setQuiet(quiet);
+        return runner.run(script == "-" ? std::cin : file) ? 1 : 0;
+    }
+
+    Array<std::shared_ptr<Figure<double>>> baseFigures;
+
+    baseFigures.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0)));
+    baseFigures.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(1, 0), 1.0));
+    baseFigures.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+
+    std::cout << "\nBase container (Array<std::shared_ptr<Figure<double>>>):\n";
+    baseFigures.printAll();
+
+    std::cout << "\nCenters:\n";
+    baseFigures.printCenters();
+
+    std::cout << "\n";
+    baseFigures.printTotalArea();
+
+    
+    Array<Square<double>> squares;
+
+    auto sq = Square<double>(Point<double>(0, 0), Point<double>(2, 0));
+
+    squares.add(sq);
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+
+    std::cout << "\nThe Legacy Container (Array<Square<double>>):\n";
+    squares.printAll();
+
+    std::cout << "\nCenters:\n";
+    squares.printCenters();
+
+    std::cout << "\n";
+    squares.printTotalArea();
+
+    
+    std::cout << "\n\n=== Switching to interactive mode ===\n";
+
+    Array<std::shared_ptr<Figure<double>>> memoryFigures;
+    memoryFigures.setVerbose(!quiet);
+    if (store)
+        store->setVerbose(!quiet);
+    auto figures = [&]() -> const Array<std::shared_ptr<Figure<double>>>& {
+        return store ? store->figures() : memoryFigures;
+    };
+    auto addFigure = [&](std::shared_ptr<Figure<double>> fig) {
+        store ? store->add(std::move(fig)) : memoryFigures.add(std::move(fig));
+    };
+
+    if (store)
+        std::cout << "Restored " << figures().getSize() << " figures from " << storeDir << "\n";
+
+    while (true) {
+        std::cout << "\nMenu:\n"
+                  << "1. Add Figure\n"
+                  << "2. Remove Figure\n"
+                  << "3. Print All Figures\n"
+                  << "4. Print Centers\n"
+                  << "5. Total Area\n"
+                  << "0. Exit\n"
+                  << "-> ";
+
+        int choice = readInt("");
+
+        switch (choice) {
+            case 0:
+                std::cout << "Exiting...\n\n";
+                return 0;
+
+            case 1: {
+                std::cout << "Select Figure Type:\n"
+                          << "  1. Square\n"
+                          << "  2. Triangle\n"
+                          << "  3. Octagon\n"
+                          << "  -> ";
+
+                int figureType = readInt("");
+
+                switch (figureType) {
+                    case 1: {
+                        auto sq = std::make_shared<Square<double>>();
+                        std::cin >> *sq;
+                        addFigure(sq);
+                        break;
+                    }
+                    case 2: {
+                        auto tri = std::make_shared<Triangle<double>>();
+                        std::cin >> *tri;
+                        addFigure(tri);
+                        break;
+                    }
+                    case 3: {
+                        auto oct = std::make_shared<Octagon<double>>();
+                        std::cin >> *oct;
+                        addFigure(oct);
+                        break;
+                    }
+                    default:
+                        std::cout << "Invalid figure type.\n";
+                        break;
+                }
+                break;
+            }
+
+            case 2: {
+                if (!figures().getSize()) {
+                    std::cout << "Array is empty.\n";
+                    break;
+                }
+
+                int index = readInt("Enter index of figure to remove: ");
+                try {
+                    store ? store->remove(index) : memoryFigures.remove(index);
+                } catch (const std::out_of_range& e) {
+                    std::cout << e.what() << "\n";
+                }
+                break;
+            }
+
+            case 3:
+                try {
+                    figures().printAll();
+                } catch (const std::out_of_range& e) {
+                    std::cout << e.what() << "\n";
+                }
+                break;
+
+            case 4:
+                try {
+                    figures().printCenters();
+                } catch (const std::out_of_range& e) {
+                    std::cout << e.what() << "\n";
+                }
+                break;
+
+            case 5:
+                try {
+                    figures().printTotalArea();
+                } catch (const std::out_of_range& e) {
+                    std::cout << e.what() << "\n";
+                }
+                break;
+
+            default:
+                std::cout << "Invalid choice. Try a number between 0 and 5.\n";
+                break;
+        }
+    }
+
+    return 0;
 }
\ No newline at end of file
@@ -1,730 +1,3082 @@
-#include <gtest/gtest.h>
-#include "array.h"
-#include "triangle.h"
-#include "square.h"
-#include "octagon.h"
-
-
-// Point
-
-TEST(PointTest, DefaultConstructor) {
-    Point<double> p;
-    EXPECT_DOUBLE_EQ(p.x(), 0.0);
-    EXPECT_DOUBLE_EQ(p.y(), 0.0);
-}
-
-TEST(PointTest, ParameterizedConstructor) {
-    Point<double> p(3.5, 4.2);
-    EXPECT_DOUBLE_EQ(p.x(), 3.5);
-    EXPECT_DOUBLE_EQ(p.y(), 4.2);
-}
-
-TEST(PointTest, EqualityOperator) {
-    Point<double> p1(1.0, 2.0);
-    Point<double> p2(1.0, 2.0);
-    Point<double> p3(1.0, 3.0);
-    EXPECT_TRUE(p1 == p2);
-    EXPECT_FALSE(p1 == p3);
-}
-
-
-// Square
-
-TEST(SquareTest, CenterAndArea) {
-    Square<double> sq(Point<double>(0, 0), Point<double>(2, 0));
-    auto c = sq.center();
-    EXPECT_NEAR(c.x(), 1.0, 1e-9);
-    EXPECT_NEAR(c.y(), 1.0, 1e-9);
-    EXPECT_NEAR(static_cast<double>(sq), 4.0, 1e-9);
-}
-
-TEST(SquareTest, EqualityOperator) {
-    Square<double> s1(Point<double>(0, 0), Point<double>(1, 0));
-    Square<double> s2(Point<double>(0, 0), Point<double>(1, 0));
-    const Figure<double>& f1 = s1;
-    const Figure<double>& f2 = s2;
-    EXPECT_TRUE(f1 == f2);
-}
-
-
-// Triangle 
-
-TEST(TriangleTest, CenterAndArea) {
-    Triangle<double> tri(Point<double>(0, 0), Point<double>(2, 0), 2.0);
-    auto c = tri.center();
-    EXPECT_NEAR(c.x(), 1.0, 1e-9);
-    EXPECT_NEAR(c.y(), 2.0 / 3.0, 1e-9);
-    EXPECT_NEAR(static_cast<double>(tri), 2.0, 1e-9);
-}
-
-TEST(TriangleTest, EqualityOperator) {
-    Triangle<double> t1(Point<double>(0, 0), Point<double>(2, 0), 2.0);
-    Triangle<double> t2(Point<double>(0, 0), Point<double>(2, 0), 2.0);
-    const Figure<double>& f1 = t1;
-    const Figure<double>& f2 = t2;
-    EXPECT_TRUE(f1 == f2);
-}
-
-
-// Octagon
-
-TEST(OctagonTest, CenterAndArea) {
-    Octagon<double> o(Point<double>(0, 0), Point<double>(1, 0));
-    auto c = o.center();
-    EXPECT_NEAR(c.x(), 0.0, 1e-9);
-    EXPECT_NEAR(c.y(), 0.0, 1e-9);
-    EXPECT_NEAR(static_cast<double>(o), 2.82842712, 1e-6);
-}
-
-TEST(OctagonTest, EqualityOperator) {
-    Octagon<double> o1(Point<double>(0, 0), Point<double>(1, 0));
-    Octagon<double> o2(Point<double>(0, 0), Point<double>(1, 0));
-    const Figure<double>& f1 = o1;
-    const Figure<double>& f2 = o2;
-    EXPECT_TRUE(f1 == f2);
-}
-
-
-// Array 
-
-// (shared_ptr<Figure>)
-
-class ArrayPolyTest : public ::testing::Test {
-protected:
-    void SetUp() override {
-        sq = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0));
-        tri = std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0);
-        oct = std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0));
-    }
-
-    Array<std::shared_ptr<Figure<double>>> arr;
-    std::shared_ptr<Square<double>> sq;
-    std::shared_ptr<Triangle<double>> tri;
-    std::shared_ptr<Octagon<double>> oct;
-};
-
-TEST_F(ArrayPolyTest, AddAndSize) {
-    EXPECT_EQ(arr.getSize(), 0);
-    arr.add(sq);
-    arr.add(tri);
-    EXPECT_EQ(arr.getSize(), 2);
-}
-
-TEST_F(ArrayPolyTest, RemoveWorks) {
-    arr.add(sq);
-    arr.add(tri);
-    arr.remove(0);
-    EXPECT_EQ(arr.getSize(), 1);
-}
-
-TEST_F(ArrayPolyTest, RemoveInvalidThrows) {
-    EXPECT_THROW(arr.remove(0), std::out_of_range);
-}
-
-TEST_F(ArrayPolyTest, PrintEmptyThrows) {
-    EXPECT_THROW(arr.printAll(), std::out_of_range);
-    EXPECT_THROW(arr.printCenters(), std::out_of_range);
-    EXPECT_THROW(arr.printTotalArea(), std::out_of_range);
-}
-
-TEST_F(ArrayPolyTest, TotalAreaOutput) {
-    arr.add(sq);
-    arr.add(tri);
-    testing::internal::CaptureStdout();
-    arr.printTotalArea();
-    std::string out = testing::internal::GetCapturedStdout();
-    EXPECT_TRUE(out.find("Total Area") != std::string::npos);
-}
-
-TEST_F(ArrayPolyTest, MoveSemantics) {
-    arr.add(sq);
-    arr.add(tri);
-    Array<std::shared_ptr<Figure<double>>> moved = std::move(arr);
-    EXPECT_EQ(moved.getSize(), 2);
-    EXPECT_EQ(arr.getSize(), 0);
-}
-
-
-// (Square<double>)
-
-TEST(ArraySquareDoubleTest, DefaultConstruction) {
-    Array<Square<double>> squares;
-    EXPECT_EQ(squares.getSize(), 0);
-}
-
-TEST(ArraySquareDoubleTest, AddMultipleSquares) {
-    Array<Square<double>> squares;
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
-    squares.add(Square<double>(Point<double>(1, 1), Point<double>(3, 1)));
-    EXPECT_EQ(squares.getSize(), 3);
-}
-
-TEST(ArraySquareDoubleTest, RemoveMiddleElement) {
-    Array<Square<double>> squares;
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(3, 0)));
-    
-    squares.remove(1);
-    EXPECT_EQ(squares.getSize(), 2);
-    
-    EXPECT_NEAR(static_cast<double>(squares[0]), 1.0, 1e-9);
-    EXPECT_NEAR(static_cast<double>(squares[1]), 9.0, 1e-9);
-}
-
-TEST(ArraySquareDoubleTest, RemoveLastElement) {
-    Array<Square<double>> squares;
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
-    
-    squares.remove(1);
-    EXPECT_EQ(squares.getSize(), 1);
-    EXPECT_NEAR(static_cast<double>(squares[0]), 1.0, 1e-9);
-}
-
-TEST(ArraySquareDoubleTest, IndexOperator) {
-    Array<Square<double>> squares;
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
-    
-    EXPECT_NEAR(static_cast<double>(squares[0]), 1.0, 1e-9);
-    EXPECT_NEAR(static_cast<double>(squares[1]), 4.0, 1e-9);
-}
-
-TEST(ArraySquareDoubleTest, IndexOutOfRange) {
-    Array<Square<double>> squares;
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
-    
-    EXPECT_THROW(squares[5], std::out_of_range);
-}
-
-TEST(ArraySquareDoubleTest, PrintEmptyArrayThrows) {
-    Array<Square<double>> squares;
-    EXPECT_THROW(squares.printAll(), std::out_of_range);
-    EXPECT_THROW(squares.printCenters(), std::out_of_range);
-    EXPECT_THROW(squares.printTotalArea(), std::out_of_range);
-}
-
-TEST(ArraySquareDoubleTest, TotalAreaCalculation) {
-    Array<Square<double>> squares;
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0))); // area = 1
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0))); // area = 4
-    
-    testing::internal::CaptureStdout();
-    squares.printTotalArea();
-    std::string output = testing::internal::GetCapturedStdout();
-    
-    EXPECT_TRUE(output.find("5") != std::string::npos);
-}
-
-TEST(ArraySquareDoubleTest, MoveConstructor) {
-    Array<Square<double>> squares;
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
-    
-    Array<Square<double>> moved(std::move(squares));
-    EXPECT_EQ(moved.getSize(), 2);
-    EXPECT_EQ(squares.getSize(), 0);
-}
-
-TEST(ArraySquareDoubleTest, MoveAssignment) {
-    Array<Square<double>> squares;
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
-    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
-    
-    Array<Square<double>> moved;
-    moved = std::move(squares);
-    
-    EXPECT_EQ(moved.getSize(), 2);
-    EXPECT_EQ(squares.getSize(), 0);
-}
-
-
-// (Square<int>)
-
-TEST(ArraySquareIntTest, WorksWithIntType) {
-    Array<Square<int>> squares;
-    squares.add(Square<int>(Point<int>(0, 0), Point<int>(3, 0)));
-    squares.add(Square<int>(Point<int>(0, 0), Point<int>(4, 0)));
-    
-    EXPECT_EQ(squares.getSize(), 2);
-    EXPECT_NO_THROW(squares.printAll());
-    EXPECT_NO_THROW(squares.printCenters());
-}
-
-TEST(ArraySquareIntTest, IntegerArithmetic) {
-    Array<Square<int>> squares;
-    squares.add(Square<int>(Point<int>(0, 0), Point<int>(5, 0))); // area = 25
-    
-    testing::internal::CaptureStdout();
-    squares.printTotalArea();
-    std::string output = testing::internal::GetCapturedStdout();
-    
-    EXPECT_TRUE(output.find("25") != std::string::npos);
-}
-
-TEST(ArraySquareIntTest, RemoveAndSize) {
-    Array<Square<int>> squares;
-    squares.add(Square<int>(Point<int>(0, 0), Point<int>(1, 0)));
-    squares.add(Square<int>(Point<int>(0, 0), Point<int>(2, 0)));
-    squares.add(Square<int>(Point<int>(0, 0), Point<int>(3, 0)));
-    
-    squares.remove(1);
-    EXPECT_EQ(squares.getSize(), 2);
-}
-
-
-// (Triangle<double>)
-
-TEST(ArrayTriangleDoubleTest, AddAndRemove) {
-    Array<Triangle<double>> triangles;
-    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
-    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(3, 0), 3.0));
-    
-    EXPECT_EQ(triangles.getSize(), 2);
-    triangles.remove(0);
-    EXPECT_EQ(triangles.getSize(), 1);
-}
-
-TEST(ArrayTriangleDoubleTest, PrintOperations) {
-    Array<Triangle<double>> triangles;
-    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
-    
-    EXPECT_NO_THROW(triangles.printAll());
-    EXPECT_NO_THROW(triangles.printCenters());
-    EXPECT_NO_THROW(triangles.printTotalArea());
-}
-
-TEST(ArrayTriangleDoubleTest, TotalArea) {
-    Array<Triangle<double>> triangles;
-    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(2, 0), 2.0)); // area = 2
-    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(4, 0), 2.0)); // area = 4
-    
-    testing::internal::CaptureStdout();
-    triangles.printTotalArea();
-    std::string output = testing::internal::GetCapturedStdout();
-    
-    EXPECT_TRUE(output.find("6") != std::string::npos);
-}
-
-TEST(ArrayTriangleDoubleTest, MoveSemantics) {
-    Array<Triangle<double>> triangles;
-    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
-    
-    Array<Triangle<double>> moved = std::move(triangles);
-    EXPECT_EQ(moved.getSize(), 1);
-    EXPECT_EQ(triangles.getSize(), 0);
-}
-
-
-// (Triangle<int>)
-
-TEST(ArrayTriangleIntTest, BasicOperations) {
-    Array<Triangle<int>> triangles;
-    triangles.add(Triangle<int>(Point<int>(0, 0), Point<int>(4, 0), 3));
-    triangles.add(Triangle<int>(Point<int>(0, 0), Point<int>(6, 0), 4));
-    
-    EXPECT_EQ(triangles.getSize(), 2);
-    EXPECT_NO_THROW(triangles.printAll());
-}
-
-
-// (Octagon<double>)
-
-TEST(ArrayOctagonDoubleTest, AddMultipleOctagons) {
-    Array<Octagon<double>> octagons;
-    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(1, 0)));
-    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(2, 0)));
-    octagons.add(Octagon<double>(Point<double>(5, 5), Point<double>(6, 5)));
-    
-    EXPECT_EQ(octagons.getSize(), 3);
-}
-
-TEST(ArrayOctagonDoubleTest, RemoveAll) {
-    Array<Octagon<double>> octagons;
-    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(1, 0)));
-    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(2, 0)));
-    
-    octagons.remove(0);
-    octagons.remove(0);
-    
-    EXPECT_EQ(octagons.getSize(), 0);
-    EXPECT_THROW(octagons.printAll(), std::out_of_range);
-}
-
-TEST(ArrayOctagonDoubleTest, PrintOperations) {
-    Array<Octagon<double>> octagons;
-    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(1, 0)));
-    
-    EXPECT_NO_THROW(octagons.printAll());
-    EXPECT_NO_THROW(octagons.printCenters());
-    EXPECT_NO_THROW(octagons.printTotalArea());
-}
-
-TEST(ArrayOctagonDoubleTest, IndexAccess) {
-    Array<Octagon<double>> octagons;
-    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(1, 0)));
-    
-    EXPECT_NO_THROW(octagons[0]);
-    EXPECT_THROW(octagons[1], std::out_of_range);
-}
-
-
-// Mixed
-
-TEST(ArrayMixedTest, GrowthBehavior) {
-    Array<Square<double>> squares;
-    
-    for (int i = 1; i <= 50; ++i)
-        squares.add(Square<double>(Point<double>(0, 0), Point<double>(i, 0)));
-    
-    EXPECT_EQ(squares.getSize(), 50);
-}
-
-TEST(ArrayMixedTest, RemoveFromEmptyThrows) {
-    Array<Triangle<double>> triangles;
-    EXPECT_THROW(triangles.remove(0), std::out_of_range);
-}
-
-
-// Integration
-
-TEST(IntegrationTest, AddRemoveAndPrintAll) {
-    Array<std::shared_ptr<Figure<double>>> figs;
-
-    auto sq = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0));
-    auto tri = std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0);
-    auto oct = std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0));
-
-    figs.add(sq);
-    figs.add(tri);
-    figs.add(oct);
-    
-    EXPECT_EQ(figs.getSize(), 3);
-
-    EXPECT_NO_THROW(figs.printAll());
-    EXPECT_NO_THROW(figs.printCenters());
-    EXPECT_NO_THROW(figs.printTotalArea());
-
-    figs.remove(1);
-    EXPECT_EQ(figs.getSize(), 2);
-}
-
-TEST(IntegrationTest, ComplexScenarioWithMultipleOperations) {
-    Array<std::shared_ptr<Figure<double>>> figs;
-    
-    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0)));
-    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(4, 0), 2.0));
-    figs.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
-    figs.add(std::make_shared<Square<double>>(Point<double>(5, 5), Point<double>(8, 5)));
-    
-    EXPECT_EQ(figs.getSize(), 4);
-    
-    figs.remove(1);
-    EXPECT_EQ(figs.getSize(), 3);
-    
-    figs.add(std::make_shared<Triangle<double>>(Point<double>(1, 1), Point<double>(3, 1), 1.5));
-    EXPECT_EQ(figs.getSize(), 4);
-    
-    EXPECT_NO_THROW(figs.printAll());
-    EXPECT_NO_THROW(figs.printCenters());
-    EXPECT_NO_THROW(figs.printTotalArea());
-    
-    figs.remove(0);
-    EXPECT_EQ(figs.getSize(), 3);
-}
-
-TEST(IntegrationTest, TotalAreaCalculationWithMixedFigures) {
-    Array<std::shared_ptr<Figure<double>>> figs;
-    
-    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0)));    
-    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(4, 0), 2.0));
-    
-    testing::internal::CaptureStdout();
-    figs.printTotalArea();
-    std::string output = testing::internal::GetCapturedStdout();
-    
-    EXPECT_TRUE(output.find("8") != std::string::npos);
-}
-
-TEST(IntegrationTest, RemoveAllElementsOneByOne) {
-    Array<std::shared_ptr<Figure<double>>> figs;
-    
-    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0)));
-    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
-    figs.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
-    
-    EXPECT_EQ(figs.getSize(), 3);
-    
-    figs.remove(2);
-    EXPECT_EQ(figs.getSize(), 2);
-    
-    figs.remove(1);
-    EXPECT_EQ(figs.getSize(), 1);
-    
-    figs.remove(0);
-    EXPECT_EQ(figs.getSize(), 0);
-    
-    EXPECT_THROW(figs.printAll(), std::out_of_range);
-    EXPECT_THROW(figs.remove(0), std::out_of_range);
-}
-
-TEST(IntegrationTest, LargeCollectionOfFigures) {
-    Array<std::shared_ptr<Figure<double>>> figs;
-    
-    for (int i = 0; i < 20; ++i) {
-        if (i % 3 == 0) {
-            figs.add(std::make_shared<Square<double>>(
-                Point<double>(i, 0), Point<double>(i + 1, 0)));
-        } else if (i % 3 == 1) {
-            figs.add(std::make_shared<Triangle<double>>(
-                Point<double>(i, 0), Point<double>(i + 2, 0), 1.0));
-        } else {
-            figs.add(std::make_shared<Octagon<double>>(
-                Point<double>(i, 0), Point<double>(i + 1, 0)));
-        }
-    }
-    
-    EXPECT_EQ(figs.getSize(), 20);
-    
-    for (int i = 9; i >= 0; --i)
-        figs.remove(i * 2);
-    
-    EXPECT_EQ(figs.getSize(), 10);
-    EXPECT_NO_THROW(figs.printAll());
-}
-
-TEST(IntegrationTest, AccessElementsAfterModifications) {
-    Array<std::shared_ptr<Figure<double>>> figs;
-    
-    auto sq1 = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0));
-    auto tri = std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0);
-    auto sq2 = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(3, 0));
-    
-    figs.add(sq1);
-    figs.add(tri);
-    figs.add(sq2);
-    
-    EXPECT_NEAR(static_cast<double>(*figs[0]), 1.0, 1e-9);  // sq1: area = 1
-    EXPECT_NEAR(static_cast<double>(*figs[1]), 2.0, 1e-9);  // tri: area = 2
-    EXPECT_NEAR(static_cast<double>(*figs[2]), 9.0, 1e-9);  // sq2: area = 9
-    
-    figs.remove(1);
-    
-    EXPECT_NEAR(static_cast<double>(*figs[0]), 1.0, 1e-9);  // sq1
-    EXPECT_NEAR(static_cast<double>(*figs[1]), 9.0, 1e-9);  // sq2
-}
-
-TEST(IntegrationTest, CentersCalculationForMixedFigures) {
-    Array<std::shared_ptr<Figure<double>>> figs;
-    
-    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0)));
-    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
-    figs.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
-    
-    auto c1 = figs[0]->center();
-    EXPECT_NEAR(c1.x(), 1.0, 1e-9);
-    EXPECT_NEAR(c1.y(), 1.0, 1e-9);
-    
-    auto c2 = figs[1]->center();
-    EXPECT_NEAR(c2.x(), 1.0, 1e-9);
-    EXPECT_NEAR(c2.y(), 2.0/3.0, 1e-9);
-    
-    auto c3 = figs[2]->center();
-    EXPECT_NEAR(c3.x(), 0.0, 1e-9);
-    EXPECT_NEAR(c3.y(), 0.0, 1e-9);
-}
-
-TEST(IntegrationTest, MoveEntireArrayWithFigures) {
-    Array<std::shared_ptr<Figure<double>>> figs;
-    
-    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0)));
-    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
-    figs.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
-    
-    EXPECT_EQ(figs.getSize(), 3);
-    
-    Array<std::shared_ptr<Figure<double>>> moved(std::move(figs));
-    
-    EXPECT_EQ(moved.getSize(), 3);
-    EXPECT_EQ(figs.getSize(), 0);
-    
-    EXPECT_NO_THROW(moved.printAll());
-    EXPECT_THROW(figs.printAll(), std::out_of_range);
-}
-
-TEST(IntegrationTest, ComparisonBetweenDifferentFigures) {
-    auto sq = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0));
-    auto tri = std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(4, 0), 2.0);
-    auto oct = std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0));
-    
-    EXPECT_FALSE(*sq == *tri);
-    EXPECT_FALSE(*sq == *oct);
-    EXPECT_FALSE(*tri == *oct);
-}
-
-TEST(IntegrationTest, SameFigureTypeButDifferentParameters) {
-    auto sq1 = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0));
-    auto sq2 = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0));
-    auto sq3 = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0));
-    
-    EXPECT_FALSE(*sq1 == *sq2);
-    EXPECT_TRUE(*sq1 == *sq3);
-}
-
-TEST(IntegrationTest, StressTestWithManyOperations) {
-    Array<std::shared_ptr<Figure<double>>> figs;
-    
-    for (int i = 0; i < 50; ++i)
-        figs.add(std::make_shared<Square<double>>(
-            Point<double>(i, 0), Point<double>(i + 1, 0)));
-    
-    EXPECT_EQ(figs.getSize(), 50);
-    
-    for (int i = 0; i < 25; ++i)
-        figs.remove(0);
-    
-    EXPECT_EQ(figs.getSize(), 25);
-    
-    for (int i = 0; i < 25; ++i)
-        figs.add(std::make_shared<Triangle<double>>(
-            Point<double>(i, 0), Point<double>(i + 2, 0), 1.0));
-        
-    EXPECT_EQ(figs.getSize(), 50);
-    
-    EXPECT_NO_THROW(figs.printAll());
-    EXPECT_NO_THROW(figs.printCenters());
-    EXPECT_NO_THROW(figs.printTotalArea());
-}
-
-TEST(IntegrationTest, IndexAccessWithBoundaryChecks) {
-    Array<std::shared_ptr<Figure<double>>> figs;
-    
-    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0)));
-    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
-    figs.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
-    
-    EXPECT_NO_THROW(figs[0]);
-    EXPECT_NO_THROW(figs[1]);
-    EXPECT_NO_THROW(figs[2]);
-    
-    EXPECT_THROW(figs[3], std::out_of_range);
-    EXPECT_THROW(figs[100], std::out_of_range);
-    
-    figs.remove(1);
-    EXPECT_NO_THROW(figs[0]);
-    EXPECT_NO_THROW(figs[1]);
-    EXPECT_THROW(figs[2], std::out_of_range);
-}
-
-TEST(IntegrationTest, EmptyArrayOperations) {
-    Array<std::shared_ptr<Figure<double>>> figs;
-    
-    EXPECT_THROW(figs.printAll(), std::out_of_range);
-    EXPECT_THROW(figs.printCenters(), std::out_of_range);
-    EXPECT_THROW(figs.printTotalArea(), std::out_of_range);
-    EXPECT_THROW(figs.remove(0), std::out_of_range);
-    EXPECT_THROW(figs[0], std::out_of_range);
-    
-    EXPECT_EQ(figs.getSize(), 0);
-}
-
-TEST(IntegrationTest, MixedIntAndDoubleSquares) {
-    Array<Square<int>> intSquares;
-    Array<Square<double>> doubleSquares;
-    
-    intSquares.add(Square<int>(Point<int>(0, 0), Point<int>(5, 0)));
-    doubleSquares.add(Square<double>(Point<double>(0, 0), Point<double>(5.0, 0)));
-    
-    EXPECT_NEAR(static_cast<double>(intSquares[0]), 25.0, 1e-9);
-    EXPECT_NEAR(static_cast<double>(doubleSquares[0]), 25.0, 1e-9);
-}
-
-TEST(IntegrationTest, RealWorldScenario) {
-    Array<std::shared_ptr<Figure<double>>> shapes;
-    
-    shapes.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(10, 0)));
-    shapes.add(std::make_shared<Triangle<double>>(Point<double>(0, 10), Point<double>(10, 10), 5.0));
-    shapes.add(std::make_shared<Octagon<double>>(Point<double>(5, 5), Point<double>(6, 5)));
-    
-    EXPECT_EQ(shapes.getSize(), 3);
-    
-    testing::internal::CaptureStdout();
-    shapes.printTotalArea();
-    std::string output = testing::internal::GetCapturedStdout();
-    EXPECT_TRUE(output.find("Total Area") != std::string::npos);
-    
-    auto buildingCenter = shapes[0]->center();
-    EXPECT_NEAR(buildingCenter.x(), 5.0, 1e-9);
-    EXPECT_NEAR(buildingCenter.y(), 5.0, 1e-9);
-}
-
-
-// Type Difference
-
-TEST(FigureTest, DifferentTypesNotEqual) {
-    Square<double> s(Point<double>(0, 0), Point<double>(1, 0));
-    Triangle<double> t(Point<double>(0, 0), Point<double>(1, 0), 1.0);
-    const Figure<double>& f1 = s;
-    const Figure<double>& f2 = t;
-    EXPECT_FALSE(f1 == f2);
-}
-
-TEST(FigureTest, DifferentTypesNotEqual_SameArea) {
-    Square<double> sq(Point<double>(0,0), Point<double>(2,0));
-    Triangle<double> tri(Point<double>(0,0), Point<double>(4,0), 2);
-
-    const Figure<double>& f1 = sq;
-    const Figure<double>& f2 = tri;
-
-    EXPECT_FALSE(f1 == f2);
-}
-
-TEST(FigureTest, DifferentTypesNotEqual_SameCenters) {
-    Square<double> sq(Point<double>(0,0), Point<double>(2,0));
-    Octagon<double> oct(Point<double>(1,1), Point<double>(2,1));
-
-    const Figure<double>& f1 = sq;
-    const Figure<double>& f2 = oct;
-
-    EXPECT_FALSE(f1 == f2);
-}
-
-TEST(FigureTest, DegenerateFiguresStillNotEqual) {
-    Triangle<double> t1(Point<double>(0,0), Point<double>(0,0), 0);
-    Square<double> sq(Point<double>(0,0), Point<double>(0,0));
-
-    const Figure<double>& f1 = t1;
-    const Figure<double>& f2 = sq;
-
-    EXPECT_FALSE(f1 == f2); 
-}
-
-TEST(FigureTest, SameTypeEqualButDifferentParameters) {
-    Square<double> s1(Point<double>(0,0), Point<double>(1,0));
-    Square<double> s2(Point<double>(0,0), Point<double>(2,0));
-
-    const Figure<double>& f1 = s1;
-    const Figure<double>& f2 = s2;
-
-    EXPECT_FALSE(f1 == f2);
-}
-
-TEST(FigureTest, OctagonAndTriangleNeverEqual) {
-    Octagon<double> o(Point<double>(0,0), Point<double>(3,0));
-    Triangle<double> t(Point<double>(0,0), Point<double>(6,0), 3);
-
-    const Figure<double>& f1 = o;
-    const Figure<double>& f2 = t;
-
-    EXPECT_FALSE(f1 == f2);
-}
-
-
-// Main
-
-int main(int argc, char **argv) {
-    ::testing::InitGoogleTest(&argc, argv);
-    return RUN_ALL_TESTS();
+#include <gtest/gtest.h>
+#include "array.h"
+#include "triangle.h"
+#include "square.h"
+#include "octagon.h"
+#include "rtree.h"
+#include "center_index.h"
+#include "hit_test.h"
+#include "collision.h"
+#include "coverage.h"
+#include "raster.h"
+#include "transform.h"
+#include "text_writer.h"
+#include "loader.h"
+#include "binary_format.h"
+#include "figure_store.h"
+#include "compressed.h"
+#include "concurrent_array.h"
+#include "versioned_array.h"
+#include "parallel.h"
+#include "segmented_array.h"
+#include "query.h"
+#include "sketch.h"
+#include "window.h"
+#include "pipeline.h"
+#include "batch.h"
+#include "server.h"
+#include "shm_store.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <execution>
+#include <filesystem>
+#include <fstream>
+#include <numeric>
+#include <random>
+#include <ranges>
+#include <set>
+#include <sstream>
+#include <thread>
+
+#include <sys/wait.h>
+
+
+// Point
+
+TEST(PointTest, DefaultConstructor) {
+    Point<double> p;
+    EXPECT_DOUBLE_EQ(p.x(), 0.0);
+    EXPECT_DOUBLE_EQ(p.y(), 0.0);
+}
+
+TEST(PointTest, ParameterizedConstructor) {
+    Point<double> p(3.5, 4.2);
+    EXPECT_DOUBLE_EQ(p.x(), 3.5);
+    EXPECT_DOUBLE_EQ(p.y(), 4.2);
+}
+
+TEST(PointTest, EqualityOperator) {
+    Point<double> p1(1.0, 2.0);
+    Point<double> p2(1.0, 2.0);
+    Point<double> p3(1.0, 3.0);
+    EXPECT_TRUE(p1 == p2);
+    EXPECT_FALSE(p1 == p3);
+}
+
+
+TEST(PointTest, VectorAlgebra) {
+    constexpr Point<int> a(1, 2), b(3, -1);
+    static_assert(a + b == Point<int>(4, 1));
+    static_assert(a - b == Point<int>(-2, 3));
+    static_assert(a * 2 == 2 * a);
+    static_assert(a.dot(b) == 1);
+    static_assert(a.cross(b) == -7);
+    static_assert(b.length2() == 10);
+    static_assert(a.perp() == Point<int>(-2, 1));
+
+    Point<double> p(1.5, -2.0);
+    p += Point<double>(0.5, 1.0);
+    p *= 2.0;
+    EXPECT_TRUE(p == Point<double>(4.0, -2.0));
+    EXPECT_TRUE(-p / 2.0 == Point<double>(-2.0, 1.0));
+}
+
+TEST(PointTest, BatchOperations) {
+    std::vector<Point<double>> pts{{1, 2}, {3, 4}, {-1, 0.5}};
+    std::span<Point<double>> span(pts);
+
+    translatePoints(span, Point<double>(1, -1));
+    scalePoints(span, 2.0);
+    EXPECT_TRUE(pts[0] == Point<double>(4, 2));
+    EXPECT_TRUE(pts[2] == Point<double>(0, -1));
+    EXPECT_TRUE(sumPoints(std::span<const Point<double>>(pts)) == Point<double>(12, 7));
+
+    std::vector<double> dots(3), crosses(3);
+    std::vector<Point<double>> other{{1, 0}, {0, 1}, {1, 1}};
+    dotPoints<double>(pts, other, dots);
+    crossPoints<double>(pts, other, crosses);
+    EXPECT_EQ(dots, (std::vector<double>{4, 6, -1}));
+    EXPECT_EQ(crosses, (std::vector<double>{-2, 8, 1}));
+    EXPECT_THROW(dotPoints<double>(pts, std::span<const Point<double>>(other).first(2), dots),
+                 std::invalid_argument);
+}
+
+
+// Square
+
+TEST(SquareTest, CenterAndArea) {
+    Square<double> sq(Point<double>(0, 0), Point<double>(2, 0));
+    auto c = sq.center();
+    EXPECT_NEAR(c.x(), 1.0, 1e-9);
+    EXPECT_NEAR(c.y(), 1.0, 1e-9);
+    EXPECT_NEAR(static_cast<double>(sq), 4.0, 1e-9);
+}
+
+TEST(SquareTest, EqualityOperator) {
+    Square<double> s1(Point<double>(0, 0), Point<double>(1, 0));
+    Square<double> s2(Point<double>(0, 0), Point<double>(1, 0));
+    const Figure<double>& f1 = s1;
+    const Figure<double>& f2 = s2;
+    EXPECT_TRUE(f1 == f2);
+}
+
+
+// Triangle 
+
+TEST(TriangleTest, CenterAndArea) {
+    Triangle<double> tri(Point<double>(0, 0), Point<double>(2, 0), 2.0);
+    auto c = tri.center();
+    EXPECT_NEAR(c.x(), 1.0, 1e-9);
+    EXPECT_NEAR(c.y(), 2.0 / 3.0, 1e-9);
+    EXPECT_NEAR(static_cast<double>(tri), 2.0, 1e-9);
+}
+
+TEST(TriangleTest, HugeAndTinySides) {
+    testing::internal::CaptureStdout();
+    Triangle<double> huge(Point<double>(0, 0), Point<double>(3e200, 4e200), 1e200);
+    Triangle<double> tiny(Point<double>(0, 0), Point<double>(3e-170, 4e-170), 1e-170);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "");
+
+    EXPECT_NEAR(huge.vertex(2).x() / 1e200, 1.5 - 0.8, 1e-12);
+    EXPECT_NEAR(huge.vertex(2).y() / 1e200, 2.0 + 0.6, 1e-12);
+    EXPECT_NEAR(tiny.vertex(2).x() / 1e-170, 1.5 - 0.8, 1e-12);
+    EXPECT_NEAR(tiny.vertex(2).y() / 1e-170, 2.0 + 0.6, 1e-12);
+}
+
+TEST(TriangleTest, EqualityOperator) {
+    Triangle<double> t1(Point<double>(0, 0), Point<double>(2, 0), 2.0);
+    Triangle<double> t2(Point<double>(0, 0), Point<double>(2, 0), 2.0);
+    const Figure<double>& f1 = t1;
+    const Figure<double>& f2 = t2;
+    EXPECT_TRUE(f1 == f2);
+}
+
+
+// Octagon
+
+TEST(OctagonTest, CenterAndArea) {
+    Octagon<double> o(Point<double>(0, 0), Point<double>(1, 0));
+    auto c = o.center();
+    EXPECT_NEAR(c.x(), 0.0, 1e-9);
+    EXPECT_NEAR(c.y(), 0.0, 1e-9);
+    EXPECT_NEAR(static_cast<double>(o), 2.82842712, 1e-6);
+}
+
+TEST(OctagonTest, EqualityOperator) {
+    Octagon<double> o1(Point<double>(0, 0), Point<double>(1, 0));
+    Octagon<double> o2(Point<double>(0, 0), Point<double>(1, 0));
+    const Figure<double>& f1 = o1;
+    const Figure<double>& f2 = o2;
+    EXPECT_TRUE(f1 == f2);
+}
+
+
+// Array 
+
+// (shared_ptr<Figure>)
+
+class ArrayPolyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        sq = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0));
+        tri = std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0);
+        oct = std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0));
+    }
+
+    Array<std::shared_ptr<Figure<double>>> arr;
+    std::shared_ptr<Square<double>> sq;
+    std::shared_ptr<Triangle<double>> tri;
+    std::shared_ptr<Octagon<double>> oct;
+};
+
+TEST_F(ArrayPolyTest, AddAndSize) {
+    EXPECT_EQ(arr.getSize(), 0);
+    arr.add(sq);
+    arr.add(tri);
+    EXPECT_EQ(arr.getSize(), 2);
+}
+
+TEST_F(ArrayPolyTest, RemoveWorks) {
+    arr.add(sq);
+    arr.add(tri);
+    arr.remove(0);
+    EXPECT_EQ(arr.getSize(), 1);
+}
+
+TEST_F(ArrayPolyTest, RemoveInvalidThrows) {
+    EXPECT_THROW(arr.remove(0), std::out_of_range);
+}
+
+TEST_F(ArrayPolyTest, PrintEmptyThrows) {
+    EXPECT_THROW(arr.printAll(), std::out_of_range);
+    EXPECT_THROW(arr.printCenters(), std::out_of_range);
+    EXPECT_THROW(arr.printTotalArea(), std::out_of_range);
+}
+
+TEST_F(ArrayPolyTest, TotalAreaOutput) {
+    arr.add(sq);
+    arr.add(tri);
+    testing::internal::CaptureStdout();
+    arr.printTotalArea();
+    std::string out = testing::internal::GetCapturedStdout();
+    EXPECT_TRUE(out.find("Total Area") != std::string::npos);
+}
+
+TEST_F(ArrayPolyTest, MoveSemantics) {
+    arr.add(sq);
+    arr.add(tri);
+    Array<std::shared_ptr<Figure<double>>> moved = std::move(arr);
+    EXPECT_EQ(moved.getSize(), 2);
+    EXPECT_EQ(arr.getSize(), 0);
+}
+
+
+// (Square<double>)
+
+TEST(ArraySquareDoubleTest, DefaultConstruction) {
+    Array<Square<double>> squares;
+    EXPECT_EQ(squares.getSize(), 0);
+}
+
+TEST(ArraySquareDoubleTest, AddMultipleSquares) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
+    squares.add(Square<double>(Point<double>(1, 1), Point<double>(3, 1)));
+    EXPECT_EQ(squares.getSize(), 3);
+}
+
+TEST(ArraySquareDoubleTest, RemoveMiddleElement) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(3, 0)));
+    
+    squares.remove(1);
+    EXPECT_EQ(squares.getSize(), 2);
+    
+    EXPECT_NEAR(static_cast<double>(squares[0]), 1.0, 1e-9);
+    EXPECT_NEAR(static_cast<double>(squares[1]), 9.0, 1e-9);
+}
+
+TEST(ArraySquareDoubleTest, RemoveLastElement) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
+    
+    squares.remove(1);
+    EXPECT_EQ(squares.getSize(), 1);
+    EXPECT_NEAR(static_cast<double>(squares[0]), 1.0, 1e-9);
+}
+
+TEST(ArraySquareDoubleTest, IndexOperator) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
+    
+    EXPECT_NEAR(static_cast<double>(squares[0]), 1.0, 1e-9);
+    EXPECT_NEAR(static_cast<double>(squares[1]), 4.0, 1e-9);
+}
+
+TEST(ArraySquareDoubleTest, IndexOutOfRange) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    
+    EXPECT_THROW(squares[5], std::out_of_range);
+}
+
+TEST(ArraySquareDoubleTest, PrintEmptyArrayThrows) {
+    Array<Square<double>> squares;
+    EXPECT_THROW(squares.printAll(), std::out_of_range);
+    EXPECT_THROW(squares.printCenters(), std::out_of_range);
+    EXPECT_THROW(squares.printTotalArea(), std::out_of_range);
+}
+
+TEST(ArraySquareDoubleTest, TotalAreaCalculation) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0))); // area = 1
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0))); // area = 4
+    
+    testing::internal::CaptureStdout();
+    squares.printTotalArea();
+    std::string output = testing::internal::GetCapturedStdout();
+    
+    EXPECT_TRUE(output.find("5") != std::string::npos);
+}
+
+TEST(ArraySquareDoubleTest, MoveConstructor) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
+    
+    Array<Square<double>> moved(std::move(squares));
+    EXPECT_EQ(moved.getSize(), 2);
+    EXPECT_EQ(squares.getSize(), 0);
+}
+
+TEST(ArraySquareDoubleTest, MoveAssignment) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
+    
+    Array<Square<double>> moved;
+    moved = std::move(squares);
+    
+    EXPECT_EQ(moved.getSize(), 2);
+    EXPECT_EQ(squares.getSize(), 0);
+}
+
+
+// (Square<int>)
+
+TEST(ArraySquareIntTest, WorksWithIntType) {
+    Array<Square<int>> squares;
+    squares.add(Square<int>(Point<int>(0, 0), Point<int>(3, 0)));
+    squares.add(Square<int>(Point<int>(0, 0), Point<int>(4, 0)));
+    
+    EXPECT_EQ(squares.getSize(), 2);
+    EXPECT_NO_THROW(squares.printAll());
+    EXPECT_NO_THROW(squares.printCenters());
+}
+
+TEST(ArraySquareIntTest, IntegerArithmetic) {
+    Array<Square<int>> squares;
+    squares.add(Square<int>(Point<int>(0, 0), Point<int>(5, 0))); // area = 25
+    
+    testing::internal::CaptureStdout();
+    squares.printTotalArea();
+    std::string output = testing::internal::GetCapturedStdout();
+    
+    EXPECT_TRUE(output.find("25") != std::string::npos);
+}
+
+TEST(ArraySquareIntTest, RemoveAndSize) {
+    Array<Square<int>> squares;
+    squares.add(Square<int>(Point<int>(0, 0), Point<int>(1, 0)));
+    squares.add(Square<int>(Point<int>(0, 0), Point<int>(2, 0)));
+    squares.add(Square<int>(Point<int>(0, 0), Point<int>(3, 0)));
+    
+    squares.remove(1);
+    EXPECT_EQ(squares.getSize(), 2);
+}
+
+
+// (Triangle<double>)
+
+TEST(ArrayTriangleDoubleTest, AddAndRemove) {
+    Array<Triangle<double>> triangles;
+    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
+    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(3, 0), 3.0));
+    
+    EXPECT_EQ(triangles.getSize(), 2);
+    triangles.remove(0);
+    EXPECT_EQ(triangles.getSize(), 1);
+}
+
+TEST(ArrayTriangleDoubleTest, PrintOperations) {
+    Array<Triangle<double>> triangles;
+    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
+    
+    EXPECT_NO_THROW(triangles.printAll());
+    EXPECT_NO_THROW(triangles.printCenters());
+    EXPECT_NO_THROW(triangles.printTotalArea());
+}
+
+TEST(ArrayTriangleDoubleTest, TotalArea) {
+    Array<Triangle<double>> triangles;
+    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(2, 0), 2.0)); // area = 2
+    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(4, 0), 2.0)); // area = 4
+    
+    testing::internal::CaptureStdout();
+    triangles.printTotalArea();
+    std::string output = testing::internal::GetCapturedStdout();
+    
+    EXPECT_TRUE(output.find("6") != std::string::npos);
+}
+
+TEST(ArrayTriangleDoubleTest, MoveSemantics) {
+    Array<Triangle<double>> triangles;
+    triangles.add(Triangle<double>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
+    
+    Array<Triangle<double>> moved = std::move(triangles);
+    EXPECT_EQ(moved.getSize(), 1);
+    EXPECT_EQ(triangles.getSize(), 0);
+}
+
+
+// (Triangle<int>)
+
+TEST(ArrayTriangleIntTest, BasicOperations) {
+    Array<Triangle<int>> triangles;
+    triangles.add(Triangle<int>(Point<int>(0, 0), Point<int>(4, 0), 3));
+    triangles.add(Triangle<int>(Point<int>(0, 0), Point<int>(6, 0), 4));
+    
+    EXPECT_EQ(triangles.getSize(), 2);
+    EXPECT_NO_THROW(triangles.printAll());
+}
+
+
+// (Octagon<double>)
+
+TEST(ArrayOctagonDoubleTest, AddMultipleOctagons) {
+    Array<Octagon<double>> octagons;
+    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(2, 0)));
+    octagons.add(Octagon<double>(Point<double>(5, 5), Point<double>(6, 5)));
+    
+    EXPECT_EQ(octagons.getSize(), 3);
+}
+
+TEST(ArrayOctagonDoubleTest, RemoveAll) {
+    Array<Octagon<double>> octagons;
+    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(2, 0)));
+    
+    octagons.remove(0);
+    octagons.remove(0);
+    
+    EXPECT_EQ(octagons.getSize(), 0);
+    EXPECT_THROW(octagons.printAll(), std::out_of_range);
+}
+
+TEST(ArrayOctagonDoubleTest, PrintOperations) {
+    Array<Octagon<double>> octagons;
+    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    
+    EXPECT_NO_THROW(octagons.printAll());
+    EXPECT_NO_THROW(octagons.printCenters());
+    EXPECT_NO_THROW(octagons.printTotalArea());
+}
+
+TEST(ArrayOctagonDoubleTest, IndexAccess) {
+    Array<Octagon<double>> octagons;
+    octagons.add(Octagon<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    
+    EXPECT_NO_THROW(octagons[0]);
+    EXPECT_THROW(octagons[1], std::out_of_range);
+}
+
+
+// Mixed
+
+TEST(ArrayMixedTest, GrowthBehavior) {
+    Array<Square<double>> squares;
+    
+    for (int i = 1; i <= 50; ++i)
+        squares.add(Square<double>(Point<double>(0, 0), Point<double>(i, 0)));
+    
+    EXPECT_EQ(squares.getSize(), 50);
+}
+
+TEST(ArrayMixedTest, RemoveFromEmptyThrows) {
+    Array<Triangle<double>> triangles;
+    EXPECT_THROW(triangles.remove(0), std::out_of_range);
+}
+
+
+// Integration
+
+TEST(IntegrationTest, AddRemoveAndPrintAll) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+
+    auto sq = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0));
+    auto tri = std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0);
+    auto oct = std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0));
+
+    figs.add(sq);
+    figs.add(tri);
+    figs.add(oct);
+    
+    EXPECT_EQ(figs.getSize(), 3);
+
+    EXPECT_NO_THROW(figs.printAll());
+    EXPECT_NO_THROW(figs.printCenters());
+    EXPECT_NO_THROW(figs.printTotalArea());
+
+    figs.remove(1);
+    EXPECT_EQ(figs.getSize(), 2);
+}
+
+TEST(IntegrationTest, ComplexScenarioWithMultipleOperations) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    
+    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0)));
+    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(4, 0), 2.0));
+    figs.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+    figs.add(std::make_shared<Square<double>>(Point<double>(5, 5), Point<double>(8, 5)));
+    
+    EXPECT_EQ(figs.getSize(), 4);
+    
+    figs.remove(1);
+    EXPECT_EQ(figs.getSize(), 3);
+    
+    figs.add(std::make_shared<Triangle<double>>(Point<double>(1, 1), Point<double>(3, 1), 1.5));
+    EXPECT_EQ(figs.getSize(), 4);
+    
+    EXPECT_NO_THROW(figs.printAll());
+    EXPECT_NO_THROW(figs.printCenters());
+    EXPECT_NO_THROW(figs.printTotalArea());
+    
+    figs.remove(0);
+    EXPECT_EQ(figs.getSize(), 3);
+}
+
+TEST(IntegrationTest, TotalAreaCalculationWithMixedFigures) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    
+    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0)));    
+    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(4, 0), 2.0));
+    
+    testing::internal::CaptureStdout();
+    figs.printTotalArea();
+    std::string output = testing::internal::GetCapturedStdout();
+    
+    EXPECT_TRUE(output.find("8") != std::string::npos);
+}
+
+TEST(IntegrationTest, RemoveAllElementsOneByOne) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    
+    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
+    figs.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+    
+    EXPECT_EQ(figs.getSize(), 3);
+    
+    figs.remove(2);
+    EXPECT_EQ(figs.getSize(), 2);
+    
+    figs.remove(1);
+    EXPECT_EQ(figs.getSize(), 1);
+    
+    figs.remove(0);
+    EXPECT_EQ(figs.getSize(), 0);
+    
+    EXPECT_THROW(figs.printAll(), std::out_of_range);
+    EXPECT_THROW(figs.remove(0), std::out_of_range);
+}
+
+TEST(IntegrationTest, LargeCollectionOfFigures) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    
+    for (int i = 0; i < 20; ++i) {
+        if (i % 3 == 0) {
+            figs.add(std::make_shared<Square<double>>(
+                Point<double>(i, 0), Point<double>(i + 1, 0)));
+        } else if (i % 3 == 1) {
+            figs.add(std::make_shared<Triangle<double>>(
+                Point<double>(i, 0), Point<double>(i + 2, 0), 1.0));
+        } else {
+            figs.add(std::make_shared<Octagon<double>>(
+                Point<double>(i, 0), Point<double>(i + 1, 0)));
+        }
+    }
+    
+    EXPECT_EQ(figs.getSize(), 20);
+    
+    for (int i = 9; i >= 0; --i)
+        figs.remove(i * 2);
+    
+    EXPECT_EQ(figs.getSize(), 10);
+    EXPECT_NO_THROW(figs.printAll());
+}
+
+TEST(IntegrationTest, AccessElementsAfterModifications) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    
+    auto sq1 = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0));
+    auto tri = std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0);
+    auto sq2 = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(3, 0));
+    
+    figs.add(sq1);
+    figs.add(tri);
+    figs.add(sq2);
+    
+    EXPECT_NEAR(static_cast<double>(*figs[0]), 1.0, 1e-9);  // sq1: area = 1
+    EXPECT_NEAR(static_cast<double>(*figs[1]), 2.0, 1e-9);  // tri: area = 2
+    EXPECT_NEAR(static_cast<double>(*figs[2]), 9.0, 1e-9);  // sq2: area = 9
+    
+    figs.remove(1);
+    
+    EXPECT_NEAR(static_cast<double>(*figs[0]), 1.0, 1e-9);  // sq1
+    EXPECT_NEAR(static_cast<double>(*figs[1]), 9.0, 1e-9);  // sq2
+}
+
+TEST(IntegrationTest, CentersCalculationForMixedFigures) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    
+    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0)));
+    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
+    figs.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+    
+    auto c1 = figs[0]->center();
+    EXPECT_NEAR(c1.x(), 1.0, 1e-9);
+    EXPECT_NEAR(c1.y(), 1.0, 1e-9);
+    
+    auto c2 = figs[1]->center();
+    EXPECT_NEAR(c2.x(), 1.0, 1e-9);
+    EXPECT_NEAR(c2.y(), 2.0/3.0, 1e-9);
+    
+    auto c3 = figs[2]->center();
+    EXPECT_NEAR(c3.x(), 0.0, 1e-9);
+    EXPECT_NEAR(c3.y(), 0.0, 1e-9);
+}
+
+TEST(IntegrationTest, MoveEntireArrayWithFigures) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    
+    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
+    figs.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+    
+    EXPECT_EQ(figs.getSize(), 3);
+    
+    Array<std::shared_ptr<Figure<double>>> moved(std::move(figs));
+    
+    EXPECT_EQ(moved.getSize(), 3);
+    EXPECT_EQ(figs.getSize(), 0);
+    
+    EXPECT_NO_THROW(moved.printAll());
+    EXPECT_THROW(figs.printAll(), std::out_of_range);
+}
+
+TEST(IntegrationTest, ComparisonBetweenDifferentFigures) {
+    auto sq = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0));
+    auto tri = std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(4, 0), 2.0);
+    auto oct = std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0));
+    
+    EXPECT_FALSE(*sq == *tri);
+    EXPECT_FALSE(*sq == *oct);
+    EXPECT_FALSE(*tri == *oct);
+}
+
+TEST(IntegrationTest, SameFigureTypeButDifferentParameters) {
+    auto sq1 = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0));
+    auto sq2 = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0));
+    auto sq3 = std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0));
+    
+    EXPECT_FALSE(*sq1 == *sq2);
+    EXPECT_TRUE(*sq1 == *sq3);
+}
+
+TEST(IntegrationTest, StressTestWithManyOperations) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    
+    for (int i = 0; i < 50; ++i)
+        figs.add(std::make_shared<Square<double>>(
+            Point<double>(i, 0), Point<double>(i + 1, 0)));
+    
+    EXPECT_EQ(figs.getSize(), 50);
+    
+    for (int i = 0; i < 25; ++i)
+        figs.remove(0);
+    
+    EXPECT_EQ(figs.getSize(), 25);
+    
+    for (int i = 0; i < 25; ++i)
+        figs.add(std::make_shared<Triangle<double>>(
+            Point<double>(i, 0), Point<double>(i + 2, 0), 1.0));
+        
+    EXPECT_EQ(figs.getSize(), 50);
+    
+    EXPECT_NO_THROW(figs.printAll());
+    EXPECT_NO_THROW(figs.printCenters());
+    EXPECT_NO_THROW(figs.printTotalArea());
+}
+
+TEST(IntegrationTest, IndexAccessWithBoundaryChecks) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    
+    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+    figs.add(std::make_shared<Triangle<double>>(Point<double>(0, 0), Point<double>(2, 0), 2.0));
+    figs.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+    
+    EXPECT_NO_THROW(figs[0]);
+    EXPECT_NO_THROW(figs[1]);
+    EXPECT_NO_THROW(figs[2]);
+    
+    EXPECT_THROW(figs[3], std::out_of_range);
+    EXPECT_THROW(figs[100], std::out_of_range);
+    
+    figs.remove(1);
+    EXPECT_NO_THROW(figs[0]);
+    EXPECT_NO_THROW(figs[1]);
+    EXPECT_THROW(figs[2], std::out_of_range);
+}
+
+TEST(IntegrationTest, EmptyArrayOperations) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    
+    EXPECT_THROW(figs.printAll(), std::out_of_range);
+    EXPECT_THROW(figs.printCenters(), std::out_of_range);
+    EXPECT_THROW(figs.printTotalArea(), std::out_of_range);
+    EXPECT_THROW(figs.remove(0), std::out_of_range);
+    EXPECT_THROW(figs[0], std::out_of_range);
+    
+    EXPECT_EQ(figs.getSize(), 0);
+}
+
+TEST(IntegrationTest, MixedIntAndDoubleSquares) {
+    Array<Square<int>> intSquares;
+    Array<Square<double>> doubleSquares;
+    
+    intSquares.add(Square<int>(Point<int>(0, 0), Point<int>(5, 0)));
+    doubleSquares.add(Square<double>(Point<double>(0, 0), Point<double>(5.0, 0)));
+    
+    EXPECT_NEAR(static_cast<double>(intSquares[0]), 25.0, 1e-9);
+    EXPECT_NEAR(static_cast<double>(doubleSquares[0]), 25.0, 1e-9);
+}
+
+TEST(IntegrationTest, RealWorldScenario) {
+    Array<std::shared_ptr<Figure<double>>> shapes;
+    
+    shapes.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(10, 0)));
+    shapes.add(std::make_shared<Triangle<double>>(Point<double>(0, 10), Point<double>(10, 10), 5.0));
+    shapes.add(std::make_shared<Octagon<double>>(Point<double>(5, 5), Point<double>(6, 5)));
+    
+    EXPECT_EQ(shapes.getSize(), 3);
+    
+    testing::internal::CaptureStdout();
+    shapes.printTotalArea();
+    std::string output = testing::internal::GetCapturedStdout();
+    EXPECT_TRUE(output.find("Total Area") != std::string::npos);
+    
+    auto buildingCenter = shapes[0]->center();
+    EXPECT_NEAR(buildingCenter.x(), 5.0, 1e-9);
+    EXPECT_NEAR(buildingCenter.y(), 5.0, 1e-9);
+}
+
+
+// Type Difference
+
+TEST(FigureTest, DifferentTypesNotEqual) {
+    Square<double> s(Point<double>(0, 0), Point<double>(1, 0));
+    Triangle<double> t(Point<double>(0, 0), Point<double>(1, 0), 1.0);
+    const Figure<double>& f1 = s;
+    const Figure<double>& f2 = t;
+    EXPECT_FALSE(f1 == f2);
+}
+
+TEST(FigureTest, DifferentTypesNotEqual_SameArea) {
+    Square<double> sq(Point<double>(0,0), Point<double>(2,0));
+    Triangle<double> tri(Point<double>(0,0), Point<double>(4,0), 2);
+
+    const Figure<double>& f1 = sq;
+    const Figure<double>& f2 = tri;
+
+    EXPECT_FALSE(f1 == f2);
+}
+
+TEST(FigureTest, DifferentTypesNotEqual_SameCenters) {
+    Square<double> sq(Point<double>(0,0), Point<double>(2,0));
+    Octagon<double> oct(Point<double>(1,1), Point<double>(2,1));
+
+    const Figure<double>& f1 = sq;
+    const Figure<double>& f2 = oct;
+
+    EXPECT_FALSE(f1 == f2);
+}
+
+TEST(FigureTest, DegenerateFiguresStillNotEqual) {
+    Triangle<double> t1(Point<double>(0,0), Point<double>(0,0), 0);
+    Square<double> sq(Point<double>(0,0), Point<double>(0,0));
+
+    const Figure<double>& f1 = t1;
+    const Figure<double>& f2 = sq;
+
+    EXPECT_FALSE(f1 == f2); 
+}
+
+TEST(FigureTest, SameTypeEqualButDifferentParameters) {
+    Square<double> s1(Point<double>(0,0), Point<double>(1,0));
+    Square<double> s2(Point<double>(0,0), Point<double>(2,0));
+
+    const Figure<double>& f1 = s1;
+    const Figure<double>& f2 = s2;
+
+    EXPECT_FALSE(f1 == f2);
+}
+
+TEST(FigureTest, OctagonAndTriangleNeverEqual) {
+    Octagon<double> o(Point<double>(0,0), Point<double>(3,0));
+    Triangle<double> t(Point<double>(0,0), Point<double>(6,0), 3);
+
+    const Figure<double>& f1 = o;
+    const Figure<double>& f2 = t;
+
+    EXPECT_FALSE(f1 == f2);
+}
+
+
+// Bounds
+
+TEST(BoundsTest, VerticesAndBoundingBox) {
+    Square<double> sq(Point<double>(0, 0), Point<double>(2, 0));
+    EXPECT_EQ(sq.vertexCount(), 4u);
+    EXPECT_TRUE(sq.vertex(2) == Point<double>(2, 2));
+    EXPECT_THROW(sq.vertex(4), std::out_of_range);
+
+    Box<double> box = sq.bounds();
+    EXPECT_DOUBLE_EQ(box.minX, 0.0);
+    EXPECT_DOUBLE_EQ(box.minY, 0.0);
+    EXPECT_DOUBLE_EQ(box.maxX, 2.0);
+    EXPECT_DOUBLE_EQ(box.maxY, 2.0);
+}
+
+
+// RTree
+
+static Array<std::shared_ptr<Figure<double>>> makeFigureGrid(int n) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    for (int i = 0; i < n; ++i) {
+        double x = (i * 37) % 101;
+        double y = (i * 53) % 97;
+        if (i % 3 == 0)
+            figs.add(std::make_shared<Square<double>>(Point<double>(x, y), Point<double>(x + 1, y)));
+        else if (i % 3 == 1)
+            figs.add(std::make_shared<Triangle<double>>(Point<double>(x, y), Point<double>(x + 2, y), 1.0));
+        else
+            figs.add(std::make_shared<Octagon<double>>(Point<double>(x, y), Point<double>(x + 1, y)));
+    }
+    return figs;
+}
+
+TEST(RTreeTest, EmptyTree) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    RTree<double> tree(figs);
+    EXPECT_EQ(tree.size(), 0u);
+    EXPECT_TRUE(tree.query(Box<double>(0, 0, 10, 10)).empty());
+    EXPECT_TRUE(tree.nearest(Point<double>(0, 0), 3).empty());
+}
+
+TEST(RTreeTest, WindowQueryMatchesLinearScan) {
+    auto figs = makeFigureGrid(500);
+    RTree<double> tree(figs);
+    EXPECT_EQ(tree.size(), 500u);
+
+    Box<double> window(20, 10, 45, 40);
+    auto found = tree.query(window);
+    std::sort(found.begin(), found.end());
+
+    std::vector<size_t> expected;
+    for (int i = 0; i < figs.getSize(); ++i)
+        if (figs[i]->bounds().intersects(window))
+            expected.push_back(i);
+
+    EXPECT_EQ(found, expected);
+}
+
+TEST(RTreeTest, NearestMatchesLinearScan) {
+    auto figs = makeFigureGrid(300);
+    RTree<double> tree(figs);
+    Point<double> p(50.5, 48.25);
+
+    auto found = tree.nearest(p, 5);
+    ASSERT_EQ(found.size(), 5u);
+
+    std::vector<double> distances;
+    for (int i = 0; i < figs.getSize(); ++i)
+        distances.push_back(figs[i]->bounds().distance2(p));
+    std::sort(distances.begin(), distances.end());
+
+    for (size_t i = 0; i < found.size(); ++i)
+        EXPECT_DOUBLE_EQ(figs[found[i]]->bounds().distance2(p), distances[i]);
+}
+
+
+// CenterIndex
+
+static std::vector<size_t> bruteNearest(const std::vector<Point<double>>& centers,
+                                        const Point<double>& p, size_t k) {
+    std::vector<size_t> ids(centers.size());
+    for (size_t i = 0; i < ids.size(); ++i)
+        ids[i] = i;
+
+    auto d2 = [&](size_t i) {
+        double dx = centers[i].x() - p.x(), dy = centers[i].y() - p.y();
+        return dx * dx + dy * dy;
+    };
+    std::stable_sort(ids.begin(), ids.end(), [&](size_t a, size_t b) { return d2(a) < d2(b); });
+    ids.resize(std::min(k, ids.size()));
+    return ids;
+}
+
+TEST(CenterIndexTest, EmptyIndexThrows) {
+    CenterIndex<double> index;
+    EXPECT_THROW(index.nearest(Point<double>(0, 0)), std::out_of_range);
+    EXPECT_TRUE(index.nearest(Point<double>(0, 0), 3).empty());
+}
+
+TEST(CenterIndexTest, MatchesBruteForce) {
+    auto figs = makeFigureGrid(400);
+    CenterIndex<double> index(figs);
+
+    std::vector<Point<double>> centers;
+    for (int i = 0; i < figs.getSize(); ++i)
+        centers.push_back(figs[i]->center());
+
+    for (double qx = -5; qx < 110; qx += 13.7) {
+        Point<double> q(qx, qx * 0.8 + 1.3);
+        auto expected = bruteNearest(centers, q, 7);
+        auto found = index.nearest(q, 7);
+        ASSERT_EQ(found.size(), expected.size());
+        for (size_t i = 0; i < found.size(); ++i) {
+            auto d2 = [&](size_t id) {
+                double dx = centers[id].x() - q.x(), dy = centers[id].y() - q.y();
+                return dx * dx + dy * dy;
+            };
+            EXPECT_DOUBLE_EQ(d2(found[i]), d2(expected[i]));
+        }
+    }
+}
+
+TEST(CenterIndexTest, IncrementalAddsAndBatchQueries) {
+    CenterIndex<double> index;
+    std::vector<Point<double>> centers;
+
+    for (int i = 0; i < 1000; ++i) {
+        Point<double> c((i * 7919) % 1000 / 10.0, (i * 104729) % 1000 / 10.0);
+        EXPECT_EQ(index.add(c), static_cast<size_t>(i));
+        centers.push_back(c);
+    }
+    EXPECT_EQ(index.size(), 1000u);
+
+    std::vector<Point<double>> queries;
+    for (int i = 0; i < 600; ++i)
+        queries.emplace_back(i % 97 + 0.31, i % 89 + 0.17);
+
+    auto batch = index.nearestBatch(queries, 4);
+    auto kBatch = index.kNearestBatch(queries, 3, 4);
+    ASSERT_EQ(batch.size(), queries.size());
+
+    for (size_t i = 0; i < queries.size(); ++i) {
+        auto expected = bruteNearest(centers, queries[i], 3);
+        EXPECT_EQ(batch[i], expected[0]);
+        EXPECT_EQ(kBatch[i], expected);
+    }
+}
+
+
+// Contains
+
+TEST(ContainsTest, Square) {
+    Square<double> sq(Point<double>(0, 0), Point<double>(2, 0));
+    EXPECT_TRUE(sq.contains(Point<double>(1, 1)));
+    EXPECT_TRUE(sq.contains(Point<double>(2, 2)));
+    EXPECT_FALSE(sq.contains(Point<double>(2.1, 1)));
+    EXPECT_FALSE(sq.contains(Point<double>(1, -0.1)));
+
+    Square<double> rotated(Point<double>(0, 0), Point<double>(1, 1));
+    EXPECT_TRUE(rotated.contains(Point<double>(0, 1)));
+    EXPECT_FALSE(rotated.contains(Point<double>(1, 0)));
+}
+
+TEST(ContainsTest, TriangleAndOctagon) {
+    Triangle<double> tri(Point<double>(0, 0), Point<double>(2, 0), 2.0);
+    EXPECT_TRUE(tri.contains(Point<double>(1, 1)));
+    EXPECT_FALSE(tri.contains(Point<double>(0.2, 1.5)));
+
+    Octagon<double> oct(Point<double>(0, 0), Point<double>(1, 0));
+    EXPECT_TRUE(oct.contains(Point<double>(0.9, 0)));
+    EXPECT_FALSE(oct.contains(Point<double>(0.88, 0.37)));
+
+    Square<int> sq(Point<int>(0, 0), Point<int>(3, 0));
+    EXPECT_TRUE(sq.contains(Point<int>(3, 3)));
+    EXPECT_FALSE(sq.contains(Point<int>(4, 1)));
+}
+
+TEST(ContainsTest, LargeIntCoordinatesDoNotOverflow) {
+    // Side and edge products here are well past INT_MAX.
+    Square<int> sq(Point<int>(0, 0), Point<int>(50000, 0));
+    EXPECT_TRUE(sq.contains(Point<int>(25000, 25000)));
+    EXPECT_TRUE(sq.contains(Point<int>(50000, 50000)));
+    EXPECT_FALSE(sq.contains(Point<int>(50001, 10)));
+    EXPECT_FALSE(sq.contains(Point<int>(25000, -1)));
+
+    Triangle<int> tri(Point<int>(0, 0), Point<int>(100000, 0), 100000);
+    EXPECT_TRUE(tri.contains(Point<int>(50000, 50000)));
+    EXPECT_FALSE(tri.contains(Point<int>(10000, 50000)));
+}
+
+TEST(HitTesterTest, MatchesPerFigureContains) {
+    auto figs = makeFigureGrid(300);
+    HitTester<double> tester(figs);
+
+    std::vector<Point<double>> points;
+    for (int i = 0; i < 2000; ++i)
+        points.emplace_back((i * 31) % 1013 / 10.0 + 0.013, (i * 17) % 971 / 10.0 + 0.027);
+
+    auto hits = tester.query(std::span<const Point<double>>(points));
+    ASSERT_EQ(hits.size(), points.size());
+
+    size_t total = 0;
+    for (size_t i = 0; i < points.size(); ++i) {
+        auto found = hits.figuresAt(i);
+        std::vector<size_t> actual(found.begin(), found.end());
+        std::sort(actual.begin(), actual.end());
+
+        std::vector<size_t> expected;
+        for (int f = 0; f < figs.getSize(); ++f)
+            if (figs[f]->contains(points[i]))
+                expected.push_back(f);
+
+        EXPECT_EQ(actual, expected);
+        total += expected.size();
+    }
+    EXPECT_GT(total, 0u);
+}
+
+
+// Collision
+
+TEST(CollisionTest, SeparatingAxisCases) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0)));
+    figs.add(std::make_shared<Square<double>>(Point<double>(1, 1), Point<double>(3, 1)));  // overlaps 0
+    figs.add(std::make_shared<Square<double>>(Point<double>(2, 0), Point<double>(4, 0)));  // touches 0
+    figs.add(std::make_shared<Square<double>>(Point<double>(5, 2.9), Point<double>(6, 3.9)));  // diamond
+    figs.add(std::make_shared<Triangle<double>>(Point<double>(4.1, 4.5), Point<double>(4.3, 4.5), 0.2));
+
+    Polygons polys(figs);
+    EXPECT_TRUE(overlaps(polys, 0, 1));
+    EXPECT_TRUE(overlaps(polys, 0, 2));
+    EXPECT_FALSE(overlaps(polys, 0, 3));
+    EXPECT_TRUE(polys.bounds(3).intersects(polys.bounds(4)));
+    EXPECT_FALSE(overlaps(polys, 3, 4));
+
+    auto pairs = findOverlaps(figs);
+    std::set<std::pair<uint32_t, uint32_t>> found;
+    for (size_t i = 0; i < pairs.size(); ++i)
+        found.insert(pairs[i]);
+
+    std::set<std::pair<uint32_t, uint32_t>> expected{{0, 1}, {0, 2}, {1, 2}};
+    EXPECT_EQ(found, expected);
+}
+
+TEST(CollisionTest, ParallelSweepMatchesBruteForce) {
+    auto figs = makeFigureGrid(3000);
+    Polygons polys(figs);
+
+    std::set<std::pair<uint32_t, uint32_t>> expected;
+    for (uint32_t i = 0; i < polys.size(); ++i)
+        for (uint32_t j = i + 1; j < polys.size(); ++j)
+            if (overlaps(polys, i, j))
+                expected.insert({i, j});
+
+    for (size_t threads : {1, 3}) {
+        auto pairs = findOverlaps(polys, threads);
+        std::set<std::pair<uint32_t, uint32_t>> found;
+        for (size_t i = 0; i < pairs.size(); ++i)
+            found.insert(pairs[i]);
+
+        EXPECT_EQ(pairs.size(), found.size());
+        EXPECT_EQ(found, expected);
+    }
+}
+
+
+// Coverage
+
+TEST(CoverageTest, OverlapCountedOnce) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0)));
+    figs.add(std::make_shared<Square<double>>(Point<double>(1, 1), Point<double>(3, 1)));
+    EXPECT_NEAR(coveredArea(figs), 7.0, 1e-9);
+
+    figs.add(std::make_shared<Square<double>>(Point<double>(0.5, 0.5), Point<double>(1, 0.5)));
+    EXPECT_NEAR(coveredArea(figs), 7.0, 1e-9);
+
+    figs.add(std::make_shared<Square<double>>(Point<double>(10, 0), Point<double>(11, 0)));
+    EXPECT_NEAR(coveredArea(figs), 8.0, 1e-9);
+}
+
+TEST(CoverageTest, RotatedFiguresAndEmpty) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    EXPECT_DOUBLE_EQ(coveredArea(figs), 0.0);
+
+    // Diamond with half-diagonal 1 centered on a corner of the unit square:
+    // the overlap is a quarter of the diamond.
+    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+    figs.add(std::make_shared<Square<double>>(Point<double>(1, 0), Point<double>(2, 1)));
+    EXPECT_NEAR(coveredArea(figs), 1.0 + 2.0 - 0.5, 1e-9);
+}
+
+TEST(CoverageTest, BoundedBySumAndApproximationError) {
+    auto figs = makeFigureGrid(600);
+    double exact = coveredArea(figs, 1);
+    EXPECT_NEAR(coveredArea(figs, 4), exact, 1e-6);
+
+    double sum = 0.0;
+    for (int i = 0; i < figs.getSize(); ++i)
+        sum += static_cast<double>(*figs[i]);
+    EXPECT_LE(exact, sum + 1e-6);
+
+    for (size_t slabs : {50, 400, 3000}) {
+        auto estimate = approximateCoveredArea(figs, slabs, 2);
+        EXPECT_LE(std::abs(estimate.area - exact), estimate.errorBound + 1e-6);
+    }
+    EXPECT_LT(approximateCoveredArea(figs, 3000).errorBound, approximateCoveredArea(figs, 50).errorBound);
+}
+
+
+// Raster
+
+TEST(RasterTest, OccupancyMatchesCellCenters) {
+    auto figs = makeFigureGrid(200);
+    const size_t width = 230, height = 210;
+    std::vector<uint8_t> cells(width * height, 0);
+    RasterGrid grid{cells.data(), width, height, width, -5.0, -5.0, 0.5};
+
+    rasterize(figs, grid, RasterMode::Occupancy, 3);
+
+    size_t mismatches = 0, filled = 0;
+    for (size_t row = 0; row < height; ++row) {
+        for (size_t col = 0; col < width; ++col) {
+            Point<double> c(-5.0 + (col + 0.5) * 0.5, -5.0 + (row + 0.5) * 0.5);
+            bool inside = false;
+            for (int f = 0; f < figs.getSize() && !inside; ++f)
+                inside = figs[f]->contains(c);
+            mismatches += inside != (cells[row * width + col] == 1);
+            filled += inside;
+        }
+    }
+    EXPECT_GT(filled, 0u);
+    EXPECT_EQ(mismatches, 0u);
+}
+
+TEST(RasterTest, CoverageIsAntiAliasedAndUnioned) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    squares.add(Square<double>(Point<double>(4, 0), Point<double>(8, 0)));
+
+    std::vector<uint8_t> cells(4 * 2, 0);
+    RasterGrid grid{cells.data(), 4, 2, 4, 0.0, 0.0, 2.0};
+    rasterize(squares, grid, RasterMode::Coverage, 1);
+
+    EXPECT_EQ(cells[0], 64);   // quarter of the cell, counted once
+    EXPECT_EQ(cells[1], 0);
+    EXPECT_EQ(cells[2], 255);
+    EXPECT_EQ(cells[3], 255);
+    EXPECT_EQ(cells[4 + 2], 255);
+
+    RasterGrid bad{nullptr, 4, 2, 4, 0.0, 0.0, 2.0};
+    EXPECT_THROW(rasterize(squares, bad, RasterMode::Coverage), std::invalid_argument);
+}
+
+TEST(RasterTest, ThreadCountDoesNotChangeResult) {
+    auto figs = makeFigureGrid(300);
+    const size_t width = 300, height = 260;
+    std::vector<uint8_t> single(width * height, 0), parallel(width * height, 0);
+    RasterGrid a{single.data(), width, height, width, 0.0, 0.0, 0.4};
+    RasterGrid b{parallel.data(), width, height, width, 0.0, 0.0, 0.4};
+
+    rasterize(figs, a, RasterMode::Coverage, 1);
+    rasterize(figs, b, RasterMode::Coverage, 4);
+    EXPECT_EQ(single, parallel);
+}
+
+TEST(RasterTest, EmptyGridsAndFarAwayFiguresAreHarmless) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(1e300, 1e300), Point<double>(1.5e300, 1e300)));
+    squares.add(Square<double>(Point<double>(-1e300, 0), Point<double>(1e300, 0)));
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+
+    std::vector<uint8_t> cells(4 * 4, 0);
+    RasterGrid empty{cells.data(), 0, 4, 4, 0.0, 0.0, 1.0};
+    rasterize(squares, empty, RasterMode::Occupancy, 4);
+    RasterGrid flat{cells.data(), 4, 0, 4, 0.0, 0.0, 1.0};
+    rasterize(squares, flat, RasterMode::Coverage, 4);
+    EXPECT_EQ(cells, std::vector<uint8_t>(16, 0));
+
+    RasterGrid grid{cells.data(), 4, 4, 4, 0.0, 0.0, 1.0};
+    rasterize(squares, grid, RasterMode::Coverage, 2);
+    EXPECT_EQ(cells[0], 255);
+    EXPECT_EQ(cells[4 * 4 - 1], 255);  // inside the huge square
+}
+
+
+// Transform
+
+TEST(TransformTest, AffineComposition) {
+    auto m = Affine2<double>::translation(1, 2) * Affine2<double>::scaling(3);
+    Point<double> p = m.apply(Point<double>(1, 1));
+    EXPECT_DOUBLE_EQ(p.x(), 4.0);
+    EXPECT_DOUBLE_EQ(p.y(), 5.0);
+    EXPECT_TRUE(m.isSimilarity());
+    EXPECT_FALSE(Affine2<double>(1, 0, 0, 2, 0, 0).isSimilarity());
+    EXPECT_FALSE(Affine2<double>(-1, 0, 0, 1, 0, 0).isSimilarity());
+}
+
+TEST(TransformTest, SingleFigure) {
+    Square<double> sq(Point<double>(0, 0), Point<double>(2, 0));
+    sq.translate(3, 4);
+    EXPECT_NEAR(sq.center().x(), 4.0, 1e-9);
+    EXPECT_NEAR(sq.center().y(), 5.0, 1e-9);
+
+    sq.scale(2, sq.center());
+    EXPECT_NEAR(static_cast<double>(sq), 16.0, 1e-9);
+    EXPECT_NEAR(sq.center().x(), 4.0, 1e-9);
+
+    sq.rotate(std::numbers::pi / 2, sq.center());
+    EXPECT_NEAR(static_cast<double>(sq), 16.0, 1e-9);
+    EXPECT_TRUE(sq.contains(Point<double>(4, 5)));
+
+    EXPECT_THROW(sq.transform(Affine2<double>(1, 1, 0, 1, 0, 0)), std::invalid_argument);
+
+    Triangle<double> tri(Point<double>(0, 0), Point<double>(2, 0), 2.0);
+    tri.rotate(1.0);
+    EXPECT_NEAR(static_cast<double>(tri), 2.0, 1e-9);
+}
+
+TEST(TransformTest, WholeArrayAndLazyComposition) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    figs.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+    figs.add(std::make_shared<Octagon<double>>(Point<double>(5, 5), Point<double>(6, 5)));
+
+    translateAll(figs, 1.0, 1.0);
+    EXPECT_NEAR(figs[1]->center().x(), 6.0, 1e-9);
+
+    {
+        LazyTransform<std::shared_ptr<Figure<double>>> lazy(figs);
+        lazy.translate(10, 0);
+        lazy.scale(2);
+        lazy.rotate(std::numbers::pi);
+        EXPECT_NEAR(figs[1]->center().x(), 6.0, 1e-9);  // not applied yet
+
+        auto c = lazy[1]->center();
+        EXPECT_NEAR(c.x(), -32.0, 1e-9);
+        EXPECT_NEAR(c.y(), -12.0, 1e-9);
+        EXPECT_TRUE(lazy.pendingTransform().isIdentity());
+        EXPECT_THROW(lazy.transform(Affine2<double>(2, 0, 0, 1, 0, 0)), std::invalid_argument);
+    }
+    EXPECT_NEAR(static_cast<double>(*figs[0]), 4.0, 1e-9);
+
+    Array<Square<int>> squares;
+    squares.add(Square<int>(Point<int>(0, 0), Point<int>(2, 0)));
+    scaleAll(squares, 3);
+    EXPECT_NEAR(static_cast<double>(squares[0]), 36.0, 1e-9);
+}
+
+TEST(TransformTest, IntegerRotationsByQuarterTurns) {
+    Square<int> sq(Point<int>(0, 0), Point<int>(2, 0));
+    sq.rotate(std::numbers::pi / 2);
+    EXPECT_EQ(sq.vertex(1), Point<int>(0, 2));
+    sq.rotate(-3 * std::numbers::pi / 2, Point<int>(1, 1));
+    EXPECT_EQ(sq.vertex(0), Point<int>(2, 0));
+    sq.rotate(std::numbers::pi);
+    EXPECT_EQ(sq.vertex(0), Point<int>(-2, 0));
+    EXPECT_EQ(static_cast<double>(sq), 4.0);
+
+    Square<int> before = sq;
+    EXPECT_THROW(sq.rotate(1.0), std::invalid_argument);
+    EXPECT_THROW(sq.rotate(std::numbers::pi / 4), std::invalid_argument);
+    EXPECT_TRUE(sq == before);
+
+    Array<Square<int>> squares;
+    squares.add(Square<int>(Point<int>(0, 0), Point<int>(1, 0)));
+    LazyTransform<Square<int>> lazy(squares);
+    EXPECT_THROW(lazy.rotate(0.3), std::invalid_argument);
+    lazy.rotate(std::numbers::pi / 2);
+    EXPECT_EQ(lazy[0].vertex(1), Point<int>(0, 1));
+}
+
+TEST(TransformTest, PolygonColumns) {
+    auto figs = makeFigureGrid(50);
+    Polygons polys(figs);
+    polys.transform(Affine2<double>(2, 0.5, 0, 1, 3, -1));
+
+    for (size_t p = 0; p < polys.size(); ++p) {
+        auto v = figs[p]->vertex(0);
+        EXPECT_DOUBLE_EQ(polys.xsOf(p)[0], 2 * v.x() + 0.5 * v.y() + 3);
+        EXPECT_DOUBLE_EQ(polys.ysOf(p)[0], v.y() - 1);
+    }
+    EXPECT_THROW(polys.transform(Affine2<double>(-1, 0, 0, 1, 0, 0)), std::invalid_argument);
+}
+
+
+// TextWriter
+
+template <typename E>
+static std::string streamFormat(const Array<E>& arr) {
+    std::ostringstream os;
+    for (int i = 0; i < arr.getSize(); ++i) {
+        const auto& fig = asFigure(arr[i]);
+        os << i << ": " << fig << " | Area: " << static_cast<double>(fig) << "\n";
+    }
+    for (int i = 0; i < arr.getSize(); ++i) {
+        auto c = asFigure(arr[i]).center();
+        os << i << ": Center = (" << c.x() << ", " << c.y() << ")\n";
+    }
+    return os.str();
+}
+
+template <typename E>
+static std::string writerFormat(const Array<E>& arr) {
+    std::string text;
+    {
+        TextWriter out(text);
+        arr.printAll(out);
+        arr.printCenters(out);
+    }
+    return text;
+}
+
+TEST(TextWriterTest, ByteIdenticalToStreams) {
+    auto figs = makeFigureGrid(200);
+    figs.add(std::make_shared<Octagon<double>>(Point<double>(-1e-7, 3e12), Point<double>(123.456789, -0.001)));
+    figs.add(std::make_shared<Triangle<double>>(Point<double>(0.1, 0.2), Point<double>(1.0 / 3, 2e-5), 1e6));
+    EXPECT_EQ(writerFormat(figs), streamFormat(figs));
+
+    Array<Square<int>> squares;
+    squares.add(Square<int>(Point<int>(-5, 7), Point<int>(1000000, -3)));
+    EXPECT_EQ(writerFormat(squares), streamFormat(squares));
+}
+
+TEST(TextWriterTest, StdoutAndFileDescriptorSinks) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
+
+    testing::internal::CaptureStdout();
+    squares.printAll();
+    squares.printTotalArea();
+    std::string out = testing::internal::GetCapturedStdout();
+    EXPECT_EQ(out, "0: Square: (0, 0) (2, 0) (2, 2) (0, 2)  | Area: 4\nTotal Area: 4\n");
+
+    std::FILE* file = std::tmpfile();
+    ASSERT_NE(file, nullptr);
+    {
+        TextWriter writer(fileno(file));
+        std::string big(TextWriter::bufferSize + 10, 'x');
+        writer << 1.5 << ' ' << -42 << ' ' << big;
+    }
+    std::fseek(file, 0, SEEK_SET);
+    char head[8] = {};
+    ASSERT_EQ(std::fread(head, 1, 7, file), 7u);
+    EXPECT_STREQ(head, "1.5 -42");
+    std::fseek(file, 0, SEEK_END);
+    EXPECT_EQ(std::ftell(file), long(8 + TextWriter::bufferSize + 10));
+    std::fclose(file);
+}
+
+
+// Loader
+
+TEST(LoaderTest, ParsesFiguresAndCollectsErrors) {
+    std::string text =
+        "# scene\n"
+        "S 0 0 2 0\n"
+        "T 0 0 2 0 2\r\n"
+        "\n"
+        "O 0 0 1 0\n"
+        "X 1 2 3 4\n"
+        "S 1 1 1 1\n"
+        "T 0 0 1 0 -1\n"
+        "S 0 0 1\n"
+        "O 0 0 1 0 extra\n"
+        "S 0 0 1e1 0";
+
+    testing::internal::CaptureStdout();
+    auto result = FigureLoader<double>::parse(text);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "");
+
+    ASSERT_EQ(result.figures.getSize(), 4);
+    EXPECT_NEAR(static_cast<double>(*result.figures[0]), 4.0, 1e-9);
+    EXPECT_NEAR(static_cast<double>(*result.figures[1]), 2.0, 1e-9);
+    EXPECT_EQ(result.figures[2]->name(), "Octagon");
+    EXPECT_NEAR(static_cast<double>(*result.figures[3]), 100.0, 1e-9);
+
+    ASSERT_EQ(result.errors.size(), 5u);
+    std::vector<size_t> lines;
+    for (const auto& e : result.errors)
+        lines.push_back(e.line);
+    EXPECT_EQ(lines, (std::vector<size_t>{6, 7, 8, 9, 10}));
+    EXPECT_EQ(result.errors[1].message, "Points are identical");
+    EXPECT_EQ(result.errors[2].message, "Height must be positive");
+}
+
+TEST(LoaderTest, RejectsNonFiniteNumbers) {
+    std::string text =
+        "S nan 0 1 0\n"
+        "S 0 0 inf 0\n"
+        "T 0 0 1 0 infinity\n"
+        "O 0 -INF 1 0\n"
+        "S 0 0 1 0\n";
+
+    auto result = FigureLoader<double>::parse(text);
+    ASSERT_EQ(result.figures.getSize(), 1);
+    ASSERT_EQ(result.errors.size(), 4u);
+    for (size_t i = 0; i < 4; ++i) {
+        EXPECT_EQ(result.errors[i].line, i + 1);
+        EXPECT_EQ(result.errors[i].message, "Numbers must be finite");
+    }
+    EXPECT_THROW(FigureLoader<double>::parseFigure("S 0 0 nan 1"), std::invalid_argument);
+}
+
+TEST(LoaderTest, RejectsNearlyCoincidentPoints) {
+    std::string text =
+        "S 0 0 1e-200 0\n"
+        "T 1e6 0 1e6 1e-12 1\n"
+        "T 0 0 1 0 1e-170\n"
+        "O 1 1 1 1.0000000000000002\n"
+        "S 0 0 1e200 0\n"
+        "S 0 0 1e-160 0\n";
+
+    testing::internal::CaptureStdout();
+    auto result = FigureLoader<double>::parse(text);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "");
+
+    ASSERT_EQ(result.figures.getSize(), 0);
+    ASSERT_EQ(result.errors.size(), 6u);
+    EXPECT_EQ(result.errors[0].message, "Points are too close together");
+    EXPECT_EQ(result.errors[1].message, "Points are too close together");
+    EXPECT_EQ(result.errors[2].message, "Height is too small");
+    EXPECT_EQ(result.errors[3].message, "Points are too close together");
+    EXPECT_EQ(result.errors[4].message, "Figure is too large");
+    EXPECT_EQ(result.errors[5].message, "Points are too close together");
+
+    auto small = FigureLoader<double>::parseFigure("S 1e-3 0 2e-3 0");
+    EXPECT_NEAR(static_cast<double>(*small), 1e-6, 1e-18);
+}
+
+TEST(LoaderTest, ParallelChunksMatchSingleThread) {
+    std::string text;
+    for (int i = 0; i < 20000; ++i) {
+        if (i % 997 == 0)
+            text += "bad line\n";
+        else if (i % 3 == 0)
+            text += "S " + std::to_string(i) + " 1 " + std::to_string(i + 1) + " 1\n";
+        else if (i % 3 == 1)
+            text += "T 0 " + std::to_string(i) + " 2 " + std::to_string(i) + " 1.5\n";
+        else
+            text += "O " + std::to_string(i) + " 0 " + std::to_string(i) + ".5 0\n";
+    }
+
+    auto single = FigureLoader<double>::parse(text, 1);
+    auto parallel = FigureLoader<double>::parse(text, 4);
+
+    ASSERT_EQ(single.figures.getSize(), parallel.figures.getSize());
+    for (int i = 0; i < single.figures.getSize(); ++i)
+        EXPECT_TRUE(*single.figures[i] == *parallel.figures[i]);
+
+    ASSERT_EQ(single.errors.size(), parallel.errors.size());
+    for (size_t i = 0; i < single.errors.size(); ++i)
+        EXPECT_EQ(single.errors[i].line, parallel.errors[i].line);
+    EXPECT_EQ(single.errors.front().line, 1u);
+}
+
+TEST(LoaderTest, LoadsMappedFileAndStream) {
+    std::string path = testing::TempDir() + "figures.txt";
+    {
+        std::ofstream file(path);
+        file << "S 0 0 3 0\nO 1 1 2 1\n";
+    }
+
+    auto fromFile = FigureLoader<double>::loadFile(path, 2);
+    EXPECT_EQ(fromFile.figures.getSize(), 2);
+    EXPECT_TRUE(fromFile.errors.empty());
+
+    std::istringstream is("T 0 0 4 0 2\n");
+    auto fromStream = FigureLoader<double>::load(is);
+    ASSERT_EQ(fromStream.figures.getSize(), 1);
+    EXPECT_NEAR(static_cast<double>(*fromStream.figures[0]), 4.0, 1e-9);
+
+    EXPECT_THROW(FigureLoader<double>::loadFile(path + ".missing"), std::runtime_error);
+    std::remove(path.c_str());
+}
+
+
+// Binary format
+
+TEST(BinaryFormatTest, RoundTripThroughMappedFile) {
+    auto figs = makeFigureGrid(100);
+    std::string path = testing::TempDir() + "figures.bin";
+    BinaryFigureWriter::write(figs, path);
+
+    BinaryFigureFile file(path);
+    EXPECT_TRUE(file.zeroCopy());
+    ASSERT_EQ(file.size(), 100u);
+    EXPECT_EQ(file.count(FigureKind::Square), 34u);
+    EXPECT_EQ(file.count(FigureKind::Triangle), 33u);
+    EXPECT_EQ(file.count(FigureKind::Octagon), 33u);
+    EXPECT_EQ(file.kindAt(2), FigureKind::Octagon);
+
+    auto xs = file.xs(FigureKind::Triangle);
+    ASSERT_EQ(xs.size(), 33u * 3);
+    EXPECT_DOUBLE_EQ(xs[3 + 2], figs[4]->vertex(2).x());
+    EXPECT_DOUBLE_EQ(file.ys(FigureKind::Octagon)[7], figs[2]->vertex(7).y());
+
+    auto loaded = file.figures<double>();
+    ASSERT_EQ(loaded.getSize(), figs.getSize());
+    for (int i = 0; i < figs.getSize(); ++i)
+        EXPECT_TRUE(*loaded[i] == *figs[i]);
+    std::remove(path.c_str());
+}
+
+TEST(BinaryFormatTest, UnalignedBufferFallsBackToCopy) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
+    squares.add(Square<double>(Point<double>(1, 1), Point<double>(1, 4)));
+    auto bytes = BinaryFigureWriter::encode(squares);
+
+    std::vector<unsigned char> shifted(bytes.size() + 1);
+    std::memcpy(shifted.data() + 1, bytes.data(), bytes.size());
+    BinaryFigureFile file(std::span<const unsigned char>(shifted).subspan(1));
+    EXPECT_FALSE(file.zeroCopy());
+
+    auto loaded = file.figures<double>();
+    ASSERT_EQ(loaded.getSize(), 2);
+    EXPECT_TRUE(*loaded[1] == squares[1]);
+
+    BinaryFigureFile copied(bytes, true);
+    EXPECT_FALSE(copied.zeroCopy());
+    EXPECT_DOUBLE_EQ(copied.xs(FigureKind::Square)[2], 2.0);
+}
+
+TEST(BinaryFormatTest, RejectsCorruptedInput) {
+    Array<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)));
+    auto bytes = BinaryFigureWriter::encode(squares);
+
+    auto flipped = bytes;
+    flipped.back() ^= 1;
+    EXPECT_THROW(BinaryFigureFile{flipped}, std::runtime_error);
+
+    auto badMagic = bytes;
+    badMagic[0] = 'X';
+    EXPECT_THROW(BinaryFigureFile{badMagic}, std::runtime_error);
+
+    std::vector<unsigned char> truncated(bytes.begin(), bytes.begin() + 50);
+    EXPECT_THROW(BinaryFigureFile{truncated}, std::runtime_error);
+
+    // The header is covered by the checksum too.
+    auto reserved = bytes;
+    reserved[88] ^= 1;
+    EXPECT_THROW(BinaryFigureFile{reserved}, std::runtime_error);
+
+    // Version 1 files, checksummed after the header only, still load.
+    auto old = bytes;
+    old[4] = 1;
+    BinaryFormat::storeLE(&old[72], BinaryFormat::checksum(old.data() + 96, old.size() - 96));
+    EXPECT_EQ(BinaryFigureFile{old}.figures<double>().getSize(), 1);
+}
+
+
+// Figure store
+
+static std::string freshStoreDir(const std::string& name) {
+    std::string dir = testing::TempDir() + name;
+    std::filesystem::remove_all(dir);
+    return dir;
+}
+
+TEST(FigureStoreTest, RecoversAddsAndRemovesFromLog) {
+    std::string dir = freshStoreDir("store-log");
+    auto figs = makeFigureGrid(20);
+    {
+        FigureStore<double> store(dir, {4, 0});
+        store.setVerbose(false);
+        for (int i = 0; i < figs.getSize(); ++i)
+            store.add(figs[i]);
+        store.remove(3);
+        store.remove(0);
+    }
+
+    FigureStore<double> reopened(dir);
+    ASSERT_EQ(reopened.figures().getSize(), 18);
+    EXPECT_EQ(reopened.generation(), 0u);
+    EXPECT_EQ(reopened.operationsSinceSnapshot(), 22u);
+    EXPECT_TRUE(*reopened.figures()[0] == *figs[1]);
+    EXPECT_TRUE(*reopened.figures()[2] == *figs[4]);
+    EXPECT_TRUE(*reopened.figures()[17] == *figs[19]);
+    EXPECT_TRUE(reopened.figures().isVerbose());
+    std::filesystem::remove_all(dir);
+}
+
+TEST(FigureStoreTest, ReplaysOnlyTailAfterSnapshot) {
+    std::string dir = freshStoreDir("store-snapshot");
+    auto figs = makeFigureGrid(25);
+    {
+        FigureStore<double> store(dir, {8, 10});
+        for (int i = 0; i < figs.getSize(); ++i)
+            store.add(figs[i]);
+        EXPECT_EQ(store.generation(), 2u);
+    }
+
+    FigureStore<double> reopened(dir);
+    EXPECT_EQ(reopened.generation(), 2u);
+    EXPECT_EQ(reopened.operationsSinceSnapshot(), 5u);
+    ASSERT_EQ(reopened.figures().getSize(), 25);
+    for (int i = 0; i < 25; ++i)
+        EXPECT_TRUE(*reopened.figures()[i] == *figs[i]);
+    EXPECT_FALSE(std::filesystem::exists(dir + "/snapshot-1.bin"));
+    EXPECT_FALSE(std::filesystem::exists(dir + "/log-1.wal"));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(FigureStoreTest, DropsTornTailRecord) {
+    std::string dir = freshStoreDir("store-torn");
+    auto figs = makeFigureGrid(3);
+    {
+        FigureStore<double> store(dir, {1, 0});
+        for (int i = 0; i < figs.getSize(); ++i)
+            store.add(figs[i]);
+    }
+    std::string log = dir + "/log-0.wal";
+    std::filesystem::resize_file(log, std::filesystem::file_size(log) - 5);
+
+    {
+        FigureStore<double> reopened(dir);
+        ASSERT_EQ(reopened.figures().getSize(), 2);
+        reopened.add(figs[2]);
+    }
+
+    FigureStore<double> again(dir);
+    ASSERT_EQ(again.figures().getSize(), 3);
+    EXPECT_TRUE(*again.figures()[2] == *figs[2]);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(FigureStoreTest, FailedLogSwitchClosesTheOldLogOnce) {
+    std::string dir = freshStoreDir("store-log-switch");
+    int other = -1;
+    {
+        FigureStore<double> store(dir, {1, 0});
+        store.setVerbose(false);
+        store.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+        // Removing the previous generation fails after the old log is closed.
+        std::filesystem::create_directories(dir + "/snapshot-0.bin/blocker");
+        EXPECT_THROW(store.snapshot(), std::filesystem::filesystem_error);
+
+        // Takes the number the old log had; the store must not close it.
+        other = ::open("/dev/null", O_RDONLY);
+        ASSERT_GE(other, 0);
+    }
+    EXPECT_NE(::fcntl(other, F_GETFD), -1);
+    ::close(other);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(FigureStoreTest, IgnoresStrayFilesInTheDirectory) {
+    std::string dir = freshStoreDir("store-stray");
+    auto figs = makeFigureGrid(12);
+    {
+        FigureStore<double> store(dir, {4, 5});
+        for (int i = 0; i < figs.getSize(); ++i)
+            store.add(figs[i]);
+    }
+    std::ofstream(dir + "/snapshot-old.bin") << "keep";
+    std::ofstream(dir + "/log-notes.wal") << "keep";
+    std::ofstream(dir + "/snapshot-.bin") << "keep";
+
+    FigureStore<double> reopened(dir);
+    EXPECT_EQ(reopened.generation(), 2u);
+    EXPECT_EQ(reopened.figures().getSize(), 12);
+    EXPECT_TRUE(std::filesystem::exists(dir + "/snapshot-old.bin"));
+    EXPECT_TRUE(std::filesystem::exists(dir + "/log-notes.wal"));
+    EXPECT_TRUE(std::filesystem::exists(dir + "/snapshot-.bin"));
+    std::filesystem::remove_all(dir);
+}
+
+
+// Compressed storage
+
+TEST(CompressedFiguresTest, DecodedVerticesStayWithinErrorBound) {
+    auto figs = makeFigureGrid(1000);
+    auto packed = CompressedFigures::encode(figs, 1e-3, 64);
+    EXPECT_EQ(packed.size(), 1000u);
+    EXPECT_EQ(packed.blockCount(), 16u);
+
+    auto decoded = packed.figures<double>();
+    ASSERT_EQ(decoded.getSize(), 1000);
+    for (int i = 0; i < 1000; ++i) {
+        ASSERT_EQ(decoded[i]->name(), figs[i]->name());
+        for (size_t v = 0; v < figs[i]->vertexCount(); ++v) {
+            auto p = figs[i]->vertex(v), q = decoded[i]->vertex(v);
+            EXPECT_LE(std::abs(p.x() - q.x()), packed.errorBound(p.x()));
+            EXPECT_LE(std::abs(p.y() - q.y()), packed.errorBound(p.y()));
+        }
+    }
+}
+
+TEST(CompressedFiguresTest, BlockColumnsMatchFigures) {
+    auto figs = makeFigureGrid(300);
+    auto packed = CompressedFigures::encode(figs, 1e-4, 100);
+
+    ColumnBlock block;
+    packed.decodeBlock(2, block);
+    ASSERT_EQ(block.size(), 100u);
+    for (size_t i = 0; i < block.size(); ++i) {
+        const auto& fig = *figs[200 + i];
+        ASSERT_EQ(block.offsets[i + 1] - block.offsets[i], fig.vertexCount());
+        EXPECT_EQ(block.kinds[i], BinaryFormat::kindOf(fig));
+        EXPECT_NEAR(block.xs[block.offsets[i]], fig.vertex(0).x(), packed.errorBound(200));
+        EXPECT_NEAR(block.ys[block.offsets[i] + 1], fig.vertex(1).y(), packed.errorBound(200));
+    }
+    EXPECT_THROW(packed.decodeBlock(3, block), std::out_of_range);
+
+    double expected = 0;
+    for (int i = 0; i < figs.getSize(); ++i)
+        expected += static_cast<double>(*figs[i]);
+    // Moving every vertex by at most e changes an area by at most perimeter * e.
+    EXPECT_NEAR(packed.totalArea(), expected, figs.getSize() * 8 * packed.errorBound(200));
+}
+
+TEST(CompressedFiguresTest, GridCoordinatesAreExactAndSmall) {
+    Array<Square<double>> squares;
+    for (int i = 0; i < 1000; ++i)
+        squares.add(Square<double>(Point<double>(i * 0.25, 10), Point<double>(i * 0.25 + 0.5, 10)));
+
+    auto packed = CompressedFigures::encode(squares, 0.25);
+    EXPECT_LE(packed.compressedSize() * 4, 1000u * 4 * 2 * sizeof(double));
+
+    auto decoded = packed.figures<double>();
+    for (int i = 0; i < 1000; ++i)
+        EXPECT_TRUE(*decoded[i] == squares[i]);
+}
+
+TEST(CompressedFiguresTest, SerializationRoundTripAndValidation) {
+    auto figs = makeFigureGrid(200);
+    auto packed = CompressedFigures::encode(figs, 1e-3, 32);
+    auto bytes = packed.serialize();
+
+    auto restored = CompressedFigures::deserialize(bytes);
+    EXPECT_EQ(restored.size(), packed.size());
+    EXPECT_DOUBLE_EQ(restored.precision(), 1e-3);
+    EXPECT_DOUBLE_EQ(restored.totalArea(), packed.totalArea());
+
+    auto flipped = bytes;
+    flipped[bytes.size() - 20] ^= 1;
+    EXPECT_THROW(CompressedFigures::deserialize(flipped), std::runtime_error);
+
+    std::vector<unsigned char> truncated(bytes.begin(), bytes.end() - 9);
+    EXPECT_THROW(CompressedFigures::deserialize(truncated), std::runtime_error);
+
+    EXPECT_THROW(CompressedFigures::encode(figs, 0.0), std::invalid_argument);
+    Array<Square<double>> huge;
+    huge.add(Square<double>(Point<double>(1e30, 0), Point<double>(2e30, 0)));
+    EXPECT_THROW(CompressedFigures::encode(huge, 1e-3), std::invalid_argument);
+}
+
+
+// ConcurrentArray
+
+TEST(ConcurrentArrayTest, SegmentMathCoversEveryIndexOnce) {
+    using Segments = GeometricSegments<6>;
+    for (size_t i = 0; i < 10000; ++i) {
+        size_t s = Segments::segmentOf(i);
+        EXPECT_EQ(Segments::start(s) + Segments::offsetOf(i), i);
+        EXPECT_LT(Segments::offsetOf(i), Segments::capacity(s));
+    }
+}
+
+TEST(ConcurrentArrayTest, SegmentMathStaysInBoundsAtTheTop) {
+    using Segments = GeometricSegments<6>;
+    size_t last = Segments::maxSize - 1;
+    EXPECT_EQ(Segments::segmentOf(last), Segments::maxSegments - 1);
+    EXPECT_EQ(Segments::offsetOf(last), Segments::capacity(Segments::maxSegments - 1) - 1);
+    EXPECT_EQ(Segments::segmentOf(Segments::maxSize), 0u);
+    EXPECT_EQ(Segments::segmentOf(~size_t(0)), 0u);
+    EXPECT_LT(Segments::offsetOf(~size_t(0)), Segments::capacity(0));
+}
+
+TEST(ConcurrentArrayTest, AddressesStayStableWhileGrowing) {
+    ConcurrentArray<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    const Square<double>* first = &squares[0];
+
+    for (int i = 1; i < 5000; ++i)
+        squares.add(Square<double>(Point<double>(i, 0), Point<double>(i + 1, 0)));
+
+    EXPECT_EQ(&squares[0], first);
+    EXPECT_EQ(squares.getSize(), 5000);
+    EXPECT_DOUBLE_EQ(squares[4999].center().x(), 4999.5);
+    EXPECT_THROW(squares[5000], std::out_of_range);
+}
+
+struct PositiveValue {
+    int value;
+
+    PositiveValue(int v) : value(v) {
+        if (v <= 0)
+            throw std::invalid_argument("Value must be positive");
+    }
+};
+
+TEST(ConcurrentArrayTest, FailedConstructionLeavesNoGap) {
+    ConcurrentArray<PositiveValue> values;
+    values.add(1);
+    EXPECT_THROW(values.add(-1), std::invalid_argument);
+    EXPECT_EQ(values.add(2), 1u);
+
+    std::vector<PositiveValue> batch = {3, 4};
+    values.append(batch);
+    ASSERT_EQ(values.getSize(), 4);
+    EXPECT_EQ(values[3].value, 4);
+}
+
+TEST(ConcurrentArrayTest, ConcurrentProducersPublishGapFreePrefix) {
+    const int producers = 8, perProducer = 20000;
+    ConcurrentArray<std::shared_ptr<Figure<double>>> figures;
+    std::atomic<bool> done{false};
+    std::atomic<size_t> badReads{0};
+
+    std::thread reader([&] {
+        while (!done.load()) {
+            size_t seen = 0;
+            for (const auto& fig : figures.view()) {
+                if (!fig)
+                    ++badReads;
+                ++seen;
+            }
+            if (seen > static_cast<size_t>(producers * perProducer))
+                ++badReads;
+        }
+    });
+
+    std::vector<std::thread> pool;
+    for (int t = 0; t < producers; ++t)
+        pool.emplace_back([&, t] {
+            auto out = figures.appender(t % 2 ? 64 : 1);
+            for (int i = 0; i < perProducer; ++i)
+                out.add(std::make_shared<Square<double>>(Point<double>(t, i), Point<double>(t + 0.5, i)));
+        });
+    for (auto& thread : pool)
+        thread.join();
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(badReads.load(), 0u);
+    ASSERT_EQ(figures.getSize(), producers * perProducer);
+
+    std::set<std::pair<int, int>> seen;
+    for (const auto& fig : figures.view()) {
+        auto p = fig->vertex(0);
+        seen.emplace(int(p.x()), int(p.y()));
+    }
+    EXPECT_EQ(seen.size(), size_t(producers * perProducer));
+}
+
+TEST(ConcurrentArrayTest, AggregatesMatchArray) {
+    auto grid = makeFigureGrid(200);
+    ConcurrentArray<std::shared_ptr<Figure<double>>> figures;
+    for (int i = 0; i < grid.getSize(); ++i)
+        figures.add(grid[i]);
+
+    std::string expected, actual;
+    {
+        TextWriter out(expected);
+        grid.printAll(out);
+        grid.printCenters(out);
+        grid.printTotalArea(out);
+    }
+    {
+        TextWriter out(actual);
+        figures.printAll(out);
+        figures.printCenters(out);
+        figures.printTotalArea(out);
+    }
+    EXPECT_EQ(actual, expected);
+
+    EXPECT_EQ(RTree<double>(figures).query(Box<double>(0, 0, 20, 20)),
+              RTree<double>(grid).query(Box<double>(0, 0, 20, 20)));
+    EXPECT_EQ(findOverlaps(figures, 2).size(), findOverlaps(grid, 2).size());
+
+    ConcurrentArray<std::shared_ptr<Figure<double>>> empty;
+    EXPECT_THROW(empty.printTotalArea(), std::out_of_range);
+}
+
+
+// VersionedArray
+
+static std::shared_ptr<Figure<double>> unitSquare(double x) {
+    return std::make_shared<Square<double>>(Point<double>(x, 0), Point<double>(x + 1, 0));
+}
+
+TEST(VersionedArrayTest, SnapshotsDoNotSeeLaterWrites) {
+    VersionedArray<std::shared_ptr<Figure<double>>> figures(4);
+    for (int i = 0; i < 10; ++i)
+        figures.add(unitSquare(i));
+
+    auto before = figures.snapshot();
+    figures.add(unitSquare(10));
+    figures.set(2, unitSquare(100));
+    testing::internal::CaptureStdout();
+    figures.remove(0);
+    EXPECT_EQ(testing::internal::GetCapturedStdout(), "Element at index 0 removed.\n");
+
+    ASSERT_EQ(before.getSize(), 10);
+    for (int i = 0; i < 10; ++i)
+        EXPECT_DOUBLE_EQ(before[i]->center().x(), i + 0.5);
+
+    auto after = figures.snapshot();
+    ASSERT_EQ(after.getSize(), 10);
+    EXPECT_DOUBLE_EQ(after[0]->center().x(), 1.5);
+    EXPECT_DOUBLE_EQ(after[1]->center().x(), 100.5);
+    EXPECT_DOUBLE_EQ(after[9]->center().x(), 10.5);
+    EXPECT_GT(after.number(), before.number());
+    EXPECT_THROW(figures.remove(10), std::out_of_range);
+}
+
+TEST(VersionedArrayTest, AddAllPublishesOneVersion) {
+    VersionedArray<std::shared_ptr<Figure<double>>> figures(4);
+    for (int i = 0; i < 6; ++i)
+        figures.add(unitSquare(i));
+    auto before = figures.snapshot();
+
+    std::vector<std::shared_ptr<Figure<double>>> batch;
+    for (int i = 6; i < 17; ++i)
+        batch.push_back(unitSquare(i));
+    figures.addAll(std::move(batch));
+
+    auto after = figures.snapshot();
+    ASSERT_EQ(after.getSize(), 17);
+    EXPECT_EQ(after.number(), before.number() + 1);
+    for (int i = 0; i < 17; ++i)
+        EXPECT_DOUBLE_EQ(after[i]->center().x(), i + 0.5);
+    EXPECT_EQ(&before[3], &after[3]);
+    EXPECT_EQ(before.getSize(), 6);
+
+    figures.addAll({});
+    EXPECT_EQ(figures.snapshot().number(), after.number());
+}
+
+TEST(VersionedArrayTest, WritesCopyOnlyTouchedChunks) {
+    VersionedArray<std::shared_ptr<Figure<double>>> figures(4);
+    for (int i = 0; i < 12; ++i)
+        figures.add(unitSquare(i));
+
+    auto before = figures.snapshot();
+    figures.set(9, unitSquare(50));
+    auto after = figures.snapshot();
+
+    EXPECT_EQ(&before[0], &after[0]);
+    EXPECT_EQ(&before[5], &after[5]);
+    EXPECT_NE(&before[9], &after[9]);
+
+    figures.setVerbose(false);
+    figures.remove(6);
+    auto removed = figures.snapshot();
+    EXPECT_EQ(&after[3], &removed[3]);
+    EXPECT_DOUBLE_EQ(removed[6]->center().x(), 7.5);
+}
+
+TEST(VersionedArrayTest, ReportsRunWhileWriterMutates) {
+    VersionedArray<std::shared_ptr<Figure<double>>> figures(16);
+    figures.setVerbose(false);
+    for (int i = 0; i < 100; ++i)
+        figures.add(unitSquare(i));
+
+    std::atomic<bool> done{false};
+    std::atomic<int> inconsistent{0};
+    std::thread reader([&] {
+        while (!done.load()) {
+            auto snap = figures.snapshot();
+            double area = 0;
+            for (const auto& fig : snap)
+                area += static_cast<double>(*fig);
+            if (std::abs(area - snap.getSize()) > 1e-9)
+                ++inconsistent;
+        }
+    });
+
+    for (int i = 0; i < 2000; ++i) {
+        figures.add(unitSquare(i));
+        if (i % 3 == 0)
+            figures.remove(i % figures.getSize());
+        if (i % 5 == 0)
+            figures.set(0, unitSquare(-i));
+    }
+    done = true;
+    reader.join();
+
+    EXPECT_EQ(inconsistent.load(), 0);
+    std::string report;
+    TextWriter out(report);
+    figures.snapshot().printTotalArea(out);
+    out.flush();
+    EXPECT_EQ(report, "Total Area: " + std::to_string(figures.getSize()) + "\n");
+}
+
+
+// Scheduler
+
+TEST(SchedulerTest, ParallelForVisitsEveryIndexOnce) {
+    TaskScheduler scheduler(4);
+    for (size_t grain : {0, 1, 7, 1000}) {
+        std::vector<std::atomic<int>> visits(10000);
+        scheduler.parallelFor(0, visits.size(), [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; ++i)
+                ++visits[i];
+        }, grain);
+        for (const auto& v : visits)
+            ASSERT_EQ(v.load(), 1);
+    }
+}
+
+static long forkJoinFib(TaskScheduler& scheduler, int n) {
+    if (n < 12)
+        return n < 2 ? n : forkJoinFib(scheduler, n - 1) + forkJoinFib(scheduler, n - 2);
+
+    long a = 0;
+    TaskGroup group(scheduler);
+    group.run([&] { a = forkJoinFib(scheduler, n - 1); });
+    long b = forkJoinFib(scheduler, n - 2);
+    group.wait();
+    return a + b;
+}
+
+TEST(SchedulerTest, NestedForkJoinAndExceptions) {
+    TaskScheduler scheduler(3);
+    EXPECT_EQ(forkJoinFib(scheduler, 22), 17711);
+
+    TaskGroup group(scheduler);
+    std::atomic<int> finished{0};
+    for (int i = 0; i < 20; ++i)
+        group.run([&, i] {
+            if (i == 7)
+                throw std::runtime_error("task failed");
+            ++finished;
+        });
+    EXPECT_THROW(group.wait(), std::runtime_error);
+    EXPECT_EQ(finished.load(), 19);
+}
+
+TEST(SchedulerTest, ReduceFoldsChunksInOrder) {
+    TaskScheduler scheduler(4);
+    auto concat = scheduler.parallelReduce(size_t(0), size_t(40), std::string(),
+        [](size_t begin, size_t end) {
+            std::string part;
+            for (size_t i = begin; i < end; ++i)
+                part += char('a' + i % 26);
+            return part;
+        },
+        [](std::string a, const std::string& b) { return a + b; }, 3);
+
+    std::string expected;
+    for (size_t i = 0; i < 40; ++i)
+        expected += char('a' + i % 26);
+    EXPECT_EQ(concat, expected);
+}
+
+TEST(SchedulerTest, ParallelFigureAlgorithmsMatchSerial) {
+    TaskScheduler scheduler(4);
+    auto figs = makeFigureGrid(2000);
+
+    double area = 0;
+    Box<double> box;
+    for (int i = 0; i < figs.getSize(); ++i) {
+        area += static_cast<double>(*figs[i]);
+        box.expand(figs[i]->bounds());
+    }
+    EXPECT_NEAR(parallelTotalArea(figs, scheduler), area, 1e-9 * area);
+    EXPECT_NEAR(parallelTotalArea(Polygons(figs), scheduler), area, 1e-9 * area);
+    EXPECT_EQ(parallelBounds(figs, scheduler), box);
+
+    auto centers = parallelCenters(figs, scheduler);
+    ASSERT_EQ(centers.size(), 2000u);
+    for (int i = 0; i < figs.getSize(); i += 97)
+        EXPECT_EQ(centers[i], figs[i]->center());
+
+    auto moved = makeFigureGrid(2000);
+    parallelTransformAll(moved, Affine2<double>::translation(3, -2), scheduler);
+    translateAll(figs, 3.0, -2.0);
+    for (int i = 0; i < figs.getSize(); i += 97)
+        EXPECT_TRUE(*moved[i] == *figs[i]);
+}
+
+
+// SegmentedArray
+
+TEST(SegmentedArrayTest, ReferencesStayValidAcrossGrowth) {
+    SegmentedArray<Square<double>> squares;
+    squares.add(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    Square<double>& first = squares[0];
+
+    for (int i = 1; i < 3000; ++i)
+        squares.add(Square<double>(Point<double>(i, 0), Point<double>(i + 1, 0)));
+
+    EXPECT_EQ(&squares[0], &first);
+    EXPECT_DOUBLE_EQ(first.center().x(), 0.5);
+    EXPECT_EQ(squares.getSize(), 3000);
+    EXPECT_DOUBLE_EQ(squares[2999].center().x(), 2999.5);
+    EXPECT_THROW(squares[3000], std::out_of_range);
+}
+
+TEST(SegmentedArrayTest, IterationWalksBlocksInOrder) {
+    SegmentedArray<std::unique_ptr<Figure<double>>> figures;
+    for (int i = 0; i < 1000; ++i)
+        figures.add(std::make_unique<Square<double>>(Point<double>(i, 0), Point<double>(i + 1, 0)));
+
+    int i = 0;
+    for (const auto& fig : figures)
+        EXPECT_DOUBLE_EQ(fig->center().x(), i++ + 0.5);
+    EXPECT_EQ(i, 1000);
+
+    std::vector<size_t> blockSizes;
+    size_t total = 0;
+    figures.forEachBlock([&](std::span<const std::unique_ptr<Figure<double>>> block) {
+        blockSizes.push_back(block.size());
+        total += block.size();
+    });
+    EXPECT_EQ(blockSizes, (std::vector<size_t>{64, 128, 256, 512, 40}));
+    EXPECT_EQ(total, 1000u);
+
+    figures.setVerbose(false);
+    figures.remove(0);
+    figures.remove(500);
+    EXPECT_EQ(figures.getSize(), 998);
+    EXPECT_DOUBLE_EQ(figures[0]->center().x(), 1.5);
+    EXPECT_DOUBLE_EQ(figures[500]->center().x(), 502.5);
+}
+
+TEST(SegmentedArrayTest, ReportsMatchArray) {
+    auto grid = makeFigureGrid(300);
+    SegmentedArray<std::shared_ptr<Figure<double>>> figures;
+    for (int i = 0; i < grid.getSize(); ++i)
+        figures.add(grid[i]);
+
+    std::string expected, actual;
+    {
+        TextWriter out(expected);
+        grid.printAll(out);
+        grid.printTotalArea(out);
+    }
+    {
+        TextWriter out(actual);
+        figures.printAll(out);
+        figures.printTotalArea(out);
+    }
+    EXPECT_EQ(actual, expected);
+    EXPECT_EQ(RTree<double>(figures).size(), 300u);
+
+    SegmentedArray<std::shared_ptr<Figure<double>>> moved = std::move(figures);
+    EXPECT_EQ(moved.getSize(), 300);
+    EXPECT_EQ(figures.getSize(), 0);
+    EXPECT_THROW(figures.printAll(), std::out_of_range);
+}
+
+
+// Array ranges
+
+static_assert(std::ranges::contiguous_range<Array<Square<double>>>);
+static_assert(std::ranges::contiguous_range<const Array<std::shared_ptr<Figure<double>>>>);
+static_assert(std::ranges::sized_range<Array<int>>);
+
+TEST(ArrayRangesTest, IteratorsCoverElementsContiguously) {
+    Array<Square<double>> squares;
+    for (int i = 0; i < 10; ++i)
+        squares.add(Square<double>(Point<double>(i, 0), Point<double>(i + 1, 0)));
+
+    EXPECT_EQ(squares.end() - squares.begin(), 10);
+    EXPECT_EQ(squares.data(), &squares[0]);
+    EXPECT_EQ(squares.span().size(), 10u);
+    EXPECT_EQ(&squares.span()[9], &squares[9]);
+
+    int i = 0;
+    for (const auto& sq : squares)
+        EXPECT_DOUBLE_EQ(sq.center().x(), i++ + 0.5);
+    EXPECT_EQ(i, 10);
+
+    Array<Square<double>> empty;
+    EXPECT_EQ(empty.begin(), empty.end());
+    EXPECT_TRUE(empty.span().empty());
+}
+
+TEST(ArrayRangesTest, WorksWithRangesAndParallelAlgorithms) {
+    auto figs = makeFigureGrid(500);
+
+    auto areaOf = [](const auto& fig) { return static_cast<double>(*fig); };
+    double serial = 0;
+    for (int i = 0; i < figs.getSize(); ++i)
+        serial += areaOf(figs[i]);
+
+    double parallel = std::transform_reduce(std::execution::par_unseq, figs.begin(), figs.end(), 0.0,
+                                            std::plus<>(), areaOf);
+    EXPECT_NEAR(parallel, serial, 1e-9 * serial);
+
+    std::ranges::sort(figs, {}, areaOf);
+    EXPECT_TRUE(std::ranges::is_sorted(figs, {}, areaOf));
+
+    auto squares = figs | std::views::filter([](const auto& fig) { return fig->name() == "Square"; });
+    EXPECT_EQ(std::ranges::distance(squares), std::ranges::count_if(figs, [](const auto& fig) {
+        return fig->vertexCount() == 4;
+    }));
+}
+
+
+// Query
+
+TEST(QueryTest, FusedPassMatchesManualLoop) {
+    auto figs = makeFigureGrid(300);
+
+    size_t expectedCount = 0;
+    Point<double> expectedSum;
+    for (int i = 0; i < figs.getSize(); ++i) {
+        auto* oct = dynamic_cast<const Octagon<double>*>(figs[i].get());
+        if (oct && static_cast<double>(*oct) > 2.0 && oct->center().x() < 50) {
+            ++expectedCount;
+            expectedSum += oct->center();
+        }
+    }
+
+    auto octagons = query(figs).ofType<Octagon>()
+        .where(FigureField::area > 2.0)
+        .where([](const Octagon<double>& oct) { return oct.center().x() < 50; });
+    EXPECT_EQ(octagons.count(), expectedCount);
+    EXPECT_GT(expectedCount, 0u);
+
+    Point<double> sum = octagons.select(FigureField::center).sum();
+    EXPECT_NEAR(sum.x(), expectedSum.x(), 1e-9);
+    EXPECT_NEAR(sum.y(), expectedSum.y(), 1e-9);
+
+    auto centers = octagons.select(FigureField::center).toVector();
+    EXPECT_EQ(centers.size(), expectedCount);
+
+    EXPECT_EQ(query(figs).count(), 300u);
+    EXPECT_EQ(query(figs).select(FigureField::vertexCount).sum(), 100u * 4 + 100u * 3 + 100u * 8);
+    EXPECT_NEAR(query(figs).select(FigureField::area).sum(), parallelTotalArea(figs), 1e-9);
+}
+
+TEST(QueryTest, TypedStoreSkipsOtherSegments) {
+    auto figs = makeFigureGrid(300);
+    TypedFigureStore<double> store;
+    for (int i = 0; i < figs.getSize(); ++i)
+        store.add(*figs[i]);
+
+    EXPECT_EQ(store.getSize(), 300);
+    EXPECT_EQ(store.octagons().getSize(), 100);
+    EXPECT_EQ(query(store).count(), 300u);
+    EXPECT_EQ(query(store).ofType<Square>().count(), 100u);
+
+    Array<Square<double>> squares;
+    EXPECT_EQ(query(squares).ofType<Octagon>().count(), 0u);
+
+    auto bounds = query(store).ofType<Triangle>()
+        .select(FigureField::bounds)
+        .reduce(Box<double>(), [](Box<double> a, const Box<double>& b) {
+            a.expand(b);
+            return a;
+        });
+    Box<double> expected;
+    for (int i = 0; i < figs.getSize(); ++i)
+        if (figs[i]->name() == "Triangle")
+            expected.expand(figs[i]->bounds());
+    EXPECT_EQ(bounds, expected);
+
+    std::vector<double> areas;
+    query(store).ofType<Octagon>().where(FigureField::area <= 5.0).forEach([&](const Octagon<double>& oct) {
+        areas.push_back(static_cast<double>(oct));
+    });
+    EXPECT_EQ(areas.size(), query(figs).ofType<Octagon>().where(FigureField::area <= 5.0).count());
+}
+
+TEST(QueryTest, ParallelChunksAgreeWithSerial) {
+    auto figs = makeFigureGrid(5000);
+    TaskScheduler scheduler(4);
+
+    auto big = query(figs).where(FigureField::area >= 2.0);
+    EXPECT_EQ(big.parallel(scheduler).count(), big.count());
+
+    Point<double> serial = big.select(FigureField::center).sum();
+    Point<double> parallel = big.parallel(scheduler).select(FigureField::center).sum();
+    EXPECT_NEAR(parallel.x(), serial.x(), 1e-6);
+    EXPECT_NEAR(parallel.y(), serial.y(), 1e-6);
+}
+
+
+// Sketch
+
+TEST(SketchTest, QuantilesStayWithinRankErrorInBoundedMemory) {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<double> dist(0.0, 1.0);
+    QuantileSketch sketch(200);
+    std::vector<double> values;
+    for (int i = 0; i < 200000; ++i) {
+        double v = dist(rng);
+        values.push_back(v);
+        sketch.add(v);
+    }
+    std::sort(values.begin(), values.end());
+
+    EXPECT_EQ(sketch.count(), 200000u);
+    EXPECT_LT(sketch.retained(), 1000u);
+    EXPECT_DOUBLE_EQ(sketch.min(), values.front());
+    EXPECT_DOUBLE_EQ(sketch.max(), values.back());
+    for (double q : {0.01, 0.25, 0.5, 0.9, 0.99}) {
+        double estimate = sketch.quantile(q);
+        double trueRank = double(std::upper_bound(values.begin(), values.end(), estimate) - values.begin()) / values.size();
+        EXPECT_NEAR(trueRank, q, 0.02) << "q=" << q;
+        EXPECT_NEAR(sketch.rank(estimate), q, 0.02) << "q=" << q;
+    }
+
+    EXPECT_THROW(sketch.quantile(1.5), std::invalid_argument);
+    EXPECT_THROW(QuantileSketch().quantile(0.5), std::out_of_range);
+    EXPECT_THROW(QuantileSketch(4), std::invalid_argument);
+}
+
+TEST(SketchTest, MergedSketchesMatchSingleStream) {
+    QuantileSketch whole, left, right;
+    for (int i = 0; i < 50000; ++i) {
+        whole.add(i);
+        (i % 2 ? left : right).add(i);
+    }
+    left.merge(right);
+
+    EXPECT_EQ(left.count(), whole.count());
+    EXPECT_LT(left.retained(), 1000u);
+    EXPECT_NEAR(left.quantile(0.5), 25000, 1000);
+    EXPECT_NEAR(left.quantile(0.99), 49500, 1000);
+    EXPECT_THROW(left.merge(QuantileSketch(100)), std::invalid_argument);
+}
+
+TEST(SketchTest, HistogramCountsCentersPerBin) {
+    Histogram2D<double> hist(Box<double>(0, 0, 10, 10), 5, 2);
+    hist.add(Point<double>(0, 0));
+    hist.add(Point<double>(1.9, 4.9));
+    hist.add(Point<double>(10, 10));
+    hist.add(Point<double>(5, 5));
+    hist.add(Point<double>(-1, 3));
+
+    EXPECT_EQ(hist.at(0, 0), 2u);
+    EXPECT_EQ(hist.at(4, 1), 1u);
+    EXPECT_EQ(hist.at(2, 1), 1u);
+    EXPECT_EQ(hist.inside(), 4u);
+    EXPECT_EQ(hist.outliers(), 1u);
+    EXPECT_EQ(hist.binBounds(2, 1), Box<double>(4, 5, 6, 10));
+    EXPECT_THROW(hist.at(5, 0), std::out_of_range);
+    EXPECT_THROW(hist.merge(Histogram2D<double>(Box<double>(0, 0, 10, 10), 4, 2)), std::invalid_argument);
+    EXPECT_THROW(Histogram2D<double>(Box<double>(0, 0, 0, 10), 1, 1), std::invalid_argument);
+}
+
+TEST(SketchTest, IntegerHistogramBinsCoverTheExtent) {
+    Histogram2D<int> hist(Box<int>(0, -10, 10, 10), 3, 4);
+    EXPECT_EQ(hist.binBounds(0, 0), Box<int>(0, -10, 4, -5));
+    EXPECT_EQ(hist.binBounds(1, 1), Box<int>(4, -5, 7, 0));
+    EXPECT_EQ(hist.binBounds(2, 3), Box<int>(7, 5, 10, 10));
+
+    // Each bin starts at the first value binned into it.
+    for (int x = 0; x <= 10; ++x) {
+        Histogram2D<int> one(Box<int>(0, -10, 10, 10), 3, 4);
+        one.add(Point<int>(x, 0));
+        for (size_t b = 0; b < 3; ++b)
+            if (one.at(b, 2)) {
+                EXPECT_GE(x, one.binBounds(b, 2).minX);
+                EXPECT_LE(x, one.binBounds(b, 2).maxX);
+            }
+    }
+}
+
+TEST(SketchTest, ParallelFigureSketchMatchesSerial) {
+    auto figs = makeFigureGrid(3000);
+    Box<double> extent(-10, -10, 120, 120);
+    TaskScheduler scheduler(4);
+
+    FigureSketch<double> serial(extent, 11, 11);
+    serial.addAll(figs);
+    auto parallel = sketchFigures(figs, extent, 11, 11, 200, scheduler);
+
+    EXPECT_EQ(parallel.areas().count(), 3000u);
+    EXPECT_DOUBLE_EQ(parallel.areas().min(), serial.areas().min());
+    EXPECT_DOUBLE_EQ(parallel.areas().max(), serial.areas().max());
+    EXPECT_DOUBLE_EQ(parallel.areas().quantile(0.5), serial.areas().quantile(0.5));
+    for (size_t y = 0; y < 11; ++y)
+        for (size_t x = 0; x < 11; ++x)
+            EXPECT_EQ(parallel.centers().at(x, y), serial.centers().at(x, y));
+    EXPECT_EQ(parallel.centers().inside(), 3000u);
+}
+
+
+// Window
+
+TEST(WindowTest, RingBufferWrapsAndGrows) {
+    RingBuffer<int> ring(3);
+    EXPECT_EQ(ring.capacity(), 4u);
+    for (int i = 0; i < 10; ++i) {
+        ring.push(i);
+        if (ring.size() == 3) {
+            EXPECT_EQ(ring.pop(), i - 2);
+        }
+    }
+    EXPECT_EQ(ring.capacity(), 4u);
+    for (int i = 10; i < 15; ++i)
+        ring.push(i);
+    EXPECT_EQ(ring.capacity(), 8u);
+    EXPECT_EQ(ring.size(), 7u);
+    EXPECT_EQ(ring.front(), 8);
+    EXPECT_EQ(ring[6], 14);
+    EXPECT_THROW(ring[7], std::out_of_range);
+    EXPECT_THROW(RingBuffer<int>().pop(), std::out_of_range);
+}
+
+TEST(WindowTest, CountWindowKeepsLastFigures) {
+    auto figs = makeFigureGrid(30);
+    auto window = SlidingWindow<double>::lastFigures(10);
+    for (int i = 0; i < figs.getSize(); ++i)
+        window.add(*figs[i]);
+
+    double expected = 0;
+    for (int i = 20; i < 30; ++i)
+        expected += static_cast<double>(*figs[i]);
+    EXPECT_EQ(window.size(), 10u);
+    EXPECT_EQ(window.stats().count, 10u);
+    EXPECT_NEAR(window.stats().totalArea, expected, 1e-9);
+    EXPECT_EQ(window.stats().countOf(FigureKind::Square) + window.stats().countOf(FigureKind::Triangle) +
+              window.stats().countOf(FigureKind::Octagon), 10u);
+    EXPECT_EQ(window.stats().countOf(FigureKind::Triangle), 3u);
+    EXPECT_EQ(window.capacity(), 16u);
+}
+
+TEST(WindowTest, TimeWindowEvictsExpiredFigures) {
+    using namespace std::chrono_literals;
+    Square<double> unit(Point<double>(0, 0), Point<double>(1, 0));
+    Octagon<double> oct(Point<double>(0, 0), Point<double>(1, 0));
+    auto start = WindowClock::time_point();
+    auto window = SlidingWindow<double>::lastDuration(10s);
+
+    for (int s = 0; s < 100; ++s)
+        window.add(s % 2 ? static_cast<const Figure<double>&>(oct) : unit, start + s * 1s);
+    EXPECT_EQ(window.stats().count, 10u);
+    EXPECT_EQ(window.stats().countOf(FigureKind::Octagon), 5u);
+    EXPECT_NEAR(window.stats().totalArea, 5 * static_cast<double>(unit) + 5 * static_cast<double>(oct), 1e-9);
+    size_t steadyCapacity = window.capacity();
+
+    for (int s = 100; s < 10000; ++s)
+        window.add(unit, start + s * 1s);
+    EXPECT_EQ(window.capacity(), steadyCapacity);
+
+    window.advance(start + 10005s);
+    EXPECT_EQ(window.stats().count, 4u);
+    window.advance(start + 20000s);
+    EXPECT_EQ(window.stats().count, 0u);
+    EXPECT_EQ(window.stats().totalArea, 0.0);
+    EXPECT_THROW(SlidingWindow<double>::lastDuration(0s), std::invalid_argument);
+}
+
+TEST(WindowTest, TumblingWindowsReportEachPeriod) {
+    using namespace std::chrono_literals;
+    auto figs = makeFigureGrid(25);
+    std::vector<WindowStats> closed;
+    auto byCount = TumblingWindow<double>::everyFigures(10, [&](const WindowStats& s) { closed.push_back(s); });
+    for (int i = 0; i < figs.getSize(); ++i)
+        byCount.add(*figs[i]);
+    EXPECT_EQ(closed.size(), 2u);
+    EXPECT_EQ(byCount.stats().count, 5u);
+    byCount.flush();
+    ASSERT_EQ(closed.size(), 3u);
+    EXPECT_EQ(closed[0].count + closed[1].count + closed[2].count, 25u);
+    EXPECT_NEAR(closed[0].totalArea + closed[1].totalArea + closed[2].totalArea, parallelTotalArea(figs), 1e-9);
+
+    std::vector<uint64_t> counts;
+    auto start = WindowClock::time_point();
+    auto byTime = TumblingWindow<double>::everyDuration(1min, [&](const WindowStats& s) { counts.push_back(s.count); });
+    for (int s = 0; s < 150; ++s)
+        byTime.add(*figs[s % 25], start + s * 1s);
+    byTime.advance(start + 1h);
+    EXPECT_EQ(counts, (std::vector<uint64_t>{60, 60, 30}));
+    EXPECT_EQ(byTime.windowsClosed(), 3u);
+}
+
+
+// Pipeline
+
+static Generator<int> countTo(int n) {
+    for (int i = 1; i <= n; ++i)
+        co_yield i;
+}
+
+static Generator<int> failAfter(int n) {
+    for (int i = 0; i < n; ++i)
+        co_yield i;
+    throw std::runtime_error("source failed");
+}
+
+TEST(PipelineTest, GeneratorYieldsLazily) {
+    int sum = 0;
+    for (int v : countTo(100))
+        sum += v;
+    EXPECT_EQ(sum, 5050);
+
+    auto gen = countTo(3);
+    auto it = gen.begin();
+    EXPECT_EQ(*it, 1);
+    ++it;
+    EXPECT_EQ(*it, 2);
+
+    int seen = 0;
+    EXPECT_THROW({
+        for (int v : failAfter(3))
+            seen += v;
+    }, std::runtime_error);
+    EXPECT_EQ(seen, 3);
+}
+
+TEST(PipelineTest, LoadersStreamFigures) {
+    std::string text = "S 0 0 1 0\nX 1 2\n\nT 0 0 2 0 1\nO 0 0 1 0\nS 1 1 1 1\n";
+    std::istringstream in(text);
+    std::vector<LoadError> errors;
+    std::vector<std::string> names;
+    for (auto& fig : FigureLoader<double>::stream(in, &errors))
+        names.push_back(std::string(fig->name()));
+    EXPECT_EQ(names, (std::vector<std::string>{"Square", "Triangle", "Octagon"}));
+    ASSERT_EQ(errors.size(), 2u);
+    EXPECT_EQ(errors[0].line, 2u);
+    EXPECT_EQ(errors[1].line, 6u);
+
+    auto figs = makeFigureGrid(30);
+    auto bytes = BinaryFigureWriter::encode(figs);
+    BinaryFigureFile file{std::span<const unsigned char>(bytes)};
+    int i = 0;
+    for (auto& fig : file.stream<double>()) {
+        EXPECT_EQ(fig->name(), figs[i]->name());
+        EXPECT_NEAR(fig->center().x(), figs[i]->center().x(), 1e-12);
+        ++i;
+    }
+    EXPECT_EQ(i, 30);
+}
+
+TEST(PipelineTest, StagesRunConcurrentlyWithBackpressure) {
+    std::string text;
+    for (int i = 0; i < 3000; ++i)
+        text += (i % 2 ? "S " : "O ") + std::to_string(i % 100) + " 0 " + std::to_string(i % 100 + 1) + " 0\n";
+    std::istringstream in(text);
+
+    using FigurePtr = std::shared_ptr<Figure<double>>;
+    TaskScheduler scheduler(2);
+    std::atomic<int> produced{0}, consumed{0}, maxAhead{0};
+    auto counted = [&](Generator<FigurePtr> source) -> Generator<FigurePtr> {
+        for (auto& fig : source) {
+            int ahead = ++produced - consumed.load();
+            int prev = maxAhead.load();
+            while (ahead > prev && !maxAhead.compare_exchange_weak(prev, ahead)) {}
+            co_yield std::move(fig);
+        }
+    };
+
+    Array<FigurePtr> octagons;
+    octagons.setVerbose(false);
+    Pipeline pipeline(scheduler);
+    auto& parsed = pipeline.channel<FigurePtr>(4);
+    auto& valid = pipeline.channel<FigurePtr>(4);
+    auto& moved = pipeline.channel<FigurePtr>(4);
+    pipeline.produce(counted(FigureLoader<double>::stream(in)), parsed);
+    pipeline.filter(parsed, valid, [&](const FigurePtr& fig) {
+        if (fig->name() == "Octagon")
+            return true;
+        ++consumed;
+        return false;
+    });
+    pipeline.transform(valid, moved, [](FigurePtr fig) {
+        fig->transform(Affine2<double>::translation(0, 10));
+        return fig;
+    }, 3);
+    pipeline.consume(moved, [&](FigurePtr fig) {
+        ++consumed;
+        octagons.add(std::move(fig));
+    });
+    pipeline.wait();
+
+    EXPECT_EQ(produced.load(), 3000);
+    EXPECT_EQ(octagons.getSize(), 1500);
+    EXPECT_EQ(query(octagons).where([](const Figure<double>& fig) { return fig.center().y() != 10; }).count(), 0u);
+    // Three channels of four plus the values held by the stages themselves.
+    EXPECT_LE(maxAhead.load(), 3 * 4 + 8);
+}
+
+TEST(PipelineTest, FailingStageStopsThePipeline) {
+    Pipeline pipeline;
+    auto& numbers = pipeline.channel<int>(2);
+    auto& doubled = pipeline.channel<int>(2);
+    int total = 0;
+    pipeline.produce(countTo(1000000), numbers);
+    pipeline.transform(numbers, doubled, [](int v) {
+        if (v == 50)
+            throw std::invalid_argument("bad value");
+        return v * 2;
+    });
+    pipeline.consume(doubled, [&](int v) { total += v; });
+    EXPECT_THROW(pipeline.wait(), std::invalid_argument);
+    EXPECT_LT(total, 2 * 50 * 50);
+}
+
+
+// Batch
+
+TEST(BatchTest, RunsCommandsWithoutPrompts) {
+    std::istringstream script(
+        "# demo\n"
+        "add S 0 0 2 0\n"
+        "add T 0 0 1 0 1\n"
+        "\n"
+        "add O 0 0 1 0\n"
+        "remove 1\n"
+        "print\n"
+        "area\n");
+    std::string output;
+    std::ostringstream errors;
+    size_t failed;
+    {
+        TextWriter out(output);
+        BatchRunner<double> runner(out, errors);
+        failed = runner.run(script);
+        EXPECT_EQ(runner.figures().getSize(), 2);
+    }
+    EXPECT_EQ(failed, 0u);
+    EXPECT_TRUE(errors.str().empty());
+
+    Array<std::shared_ptr<Figure<double>>> expected;
+    expected.add(std::make_shared<Square<double>>(Point<double>(0, 0), Point<double>(2, 0)));
+    expected.add(std::make_shared<Octagon<double>>(Point<double>(0, 0), Point<double>(1, 0)));
+    std::string report = "Added Square.\nAdded Triangle.\nAdded Octagon.\nElement at index 1 removed.\n";
+    {
+        TextWriter out(report);
+        expected.printAll(out);
+        expected.printTotalArea(out);
+    }
+    EXPECT_EQ(output, report);
+}
+
+TEST(BatchTest, QuietModeAndErrorsKeepGoing) {
+    std::istringstream script(
+        "add S 0 0 1 0\n"
+        "remove 5\n"
+        "add X 1 2\n"
+        "frobnicate\n"
+        "remove\n"
+        "centers\n");
+    std::string output;
+    std::ostringstream errors;
+    size_t failed;
+    {
+        TextWriter out(output);
+        BatchRunner<double> runner(out, errors);
+        runner.setQuiet(true);
+        failed = runner.run(script);
+    }
+    EXPECT_EQ(failed, 4u);
+    EXPECT_EQ(output, "0: Center = (0.5, 0.5)\n");
+    EXPECT_NE(errors.str().find("line 2: Index out of range"), std::string::npos);
+    EXPECT_NE(errors.str().find("line 3: Unknown figure type 'X'"), std::string::npos);
+    EXPECT_NE(errors.str().find("line 4: Unknown command 'frobnicate'"), std::string::npos);
+    EXPECT_NE(errors.str().find("line 5: Expected an index"), std::string::npos);
+}
+
+TEST(BatchTest, SaveAndLoadRoundTrip) {
+    auto dir = std::filesystem::temp_directory_path() / "batch_test";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    auto binary = (dir / "figs.bin").string();
+    auto text = (dir / "figs.txt").string();
+    std::ofstream(text) << "S 0 0 1 0\nO 5 5 6 5\n";
+
+    std::istringstream script("load " + text + "\nadd T 0 0 2 0 1\nsave " + binary + "\n");
+    std::string output;
+    std::ostringstream errors;
+    {
+        TextWriter out(output);
+        BatchRunner<double> runner(out, errors);
+        EXPECT_EQ(runner.run(script), 0u);
+    }
+    EXPECT_NE(output.find("Loaded 2 figures from"), std::string::npos);
+    EXPECT_NE(output.find("Saved 3 figures to"), std::string::npos);
+
+    {
+        FigureStore<double> store((dir / "store").string());
+        std::istringstream reload("load " + binary + "\nload " + (dir / "missing").string() + "\n");
+        std::string quiet;
+        TextWriter out(quiet);
+        BatchRunner<double> runner(out, errors, &store);
+        runner.setQuiet(true);
+        EXPECT_EQ(runner.run(reload), 1u);
+        EXPECT_EQ(store.figures().getSize(), 3);
+        EXPECT_EQ(store.figures()[2]->name(), "Triangle");
+    }
+    EXPECT_EQ(FigureStore<double>((dir / "store").string()).figures().getSize(), 3);
+    std::filesystem::remove_all(dir);
+}
+
+
+// Server
+
+struct ServerFixture {
+    std::string path = (std::filesystem::temp_directory_path() /
+                        ("figure_server_" + std::to_string(::getpid()) + ".sock")).string();
+    FigureServer<double> server{path};
+    std::thread loop{[this] { server.run(); }};
+
+    ~ServerFixture() {
+        server.stop();
+        loop.join();
+    }
+};
+
+TEST(ServerTest, AnswersBatchedRequests) {
+    ServerFixture fixture;
+    FigureClient client(fixture.path);
+
+    FigureRequest request;
+    request.add(Square<double>(Point<double>(0, 0), Point<double>(2, 0)))
+           .add(Triangle<double>(Point<double>(10, 10), Point<double>(12, 10), 1.0))
+           .add(Octagon<double>(Point<double>(20, 20), Point<double>(21, 20)))
+           .area()
+           .region(Box<double>(9, 9, 30, 30))
+           .remove(7)
+           .remove(0)
+           .area();
+    auto results = client.call(request);
+    ASSERT_EQ(results.size(), 8u);
+
+    EXPECT_EQ(results[2].count, 3u);
+    double total = 4.0 + 1.0 + static_cast<double>(Octagon<double>(Point<double>(0, 0), Point<double>(1, 0)));
+    EXPECT_NEAR(results[3].area, total, 1e-9);
+    EXPECT_EQ(results[4].indices, (std::vector<uint64_t>{1, 2}));
+    EXPECT_FALSE(results[5].ok);
+    EXPECT_EQ(results[5].error, "Index out of range");
+    EXPECT_TRUE(results[6].ok);
+    EXPECT_EQ(results[6].count, 2u);
+    EXPECT_NEAR(results[7].area, total - 4.0, 1e-9);
+}
+
+TEST(ServerTest, RejectsInvalidFigures) {
+    ServerFixture fixture;
+    FigureClient client(fixture.path);
+    double nan = std::numeric_limits<double>::quiet_NaN();
+
+    std::array<Point<double>, 4> rectangle = {Point<double>(0, 0), Point<double>(2, 0), Point<double>(2, 1), Point<double>(0, 1)};
+    std::array<Point<double>, 3> clockwise = {Point<double>(0, 0), Point<double>(2, 0), Point<double>(1, -1)};
+    std::array<Point<double>, 3> scalene = {Point<double>(0, 0), Point<double>(2, 0), Point<double>(0, 1)};
+    std::array<Point<double>, 3> withNan = {Point<double>(0, 0), Point<double>(nan, 0), Point<double>(1, 1)};
+    std::array<Point<double>, 4> point = {};
+
+    std::vector<std::pair<FigureRequest, std::string>> cases;
+    cases.emplace_back(FigureRequest().add(Square<double>::fromVertices(rectangle)).area(), "Vertices do not form a square");
+    cases.emplace_back(FigureRequest().add(Triangle<double>::fromVertices(clockwise)).area(), "Vertices must be counter-clockwise");
+    cases.emplace_back(FigureRequest().add(Triangle<double>::fromVertices(scalene)).area(), "Vertices do not form a triangle");
+    cases.emplace_back(FigureRequest().add(Triangle<double>::fromVertices(withNan)).area(), "Coordinates must be finite and in range");
+    cases.emplace_back(FigureRequest().add(Square<double>::fromVertices(point)).area(), "Points are too close together");
+    for (auto& [request, message] : cases) {
+        auto results = client.call(request);
+        ASSERT_EQ(results.size(), 2u);
+        EXPECT_FALSE(results[0].ok);
+        EXPECT_EQ(results[0].error, message);
+        EXPECT_FALSE(results[1].ok);
+    }
+
+    // Rotated and shifted figures built by the constructors are accepted.
+    Square<double> square(Point<double>(1e6, -3e5), Point<double>(1e6 + 0.3, -3e5 + 0.7));
+    Triangle<double> triangle(Point<double>(-5, 7), Point<double>(-4.2, 9.1), 0.01);
+    Octagon<double> octagon(Point<double>(123.4, 56.7), Point<double>(124.1, 55.2));
+    auto results = client.call(FigureRequest().add(square).add(triangle).add(octagon));
+    for (const auto& result : results)
+        EXPECT_TRUE(result.ok) << result.error;
+    EXPECT_EQ(fixture.server.figures().getSize(), 3);
+}
+
+TEST(ServerTest, PipelinedClientsShareOneCollection) {
+    ServerFixture fixture;
+    FigureClient writer(fixture.path), reader(fixture.path);
+
+    for (int i = 0; i < 50; ++i)
+        writer.send(FigureRequest().add(Square<double>(Point<double>(i, 0), Point<double>(i + 1, 0))));
+    for (int i = 0; i < 50; ++i)
+        EXPECT_EQ(writer.receive()[0].count, uint64_t(i + 1));
+
+    auto first = reader.call(FigureRequest().snapshot().area());
+    auto second = reader.call(FigureRequest().snapshot());
+    ASSERT_TRUE(first[0].ok);
+    EXPECT_EQ(first[0].snapshot, second[0].snapshot);
+    EXPECT_NEAR(first[1].area, 50.0, 1e-9);
+
+    BinaryFigureFile file{std::span<const unsigned char>(first[0].snapshot)};
+    auto figs = file.figures<double>();
+    EXPECT_EQ(figs.getSize(), 50);
+    EXPECT_DOUBLE_EQ(figs[49]->center().x(), 49.5);
+
+    writer.call(FigureRequest().remove(0));
+    auto third = reader.call(FigureRequest().snapshot());
+    EXPECT_EQ(BinaryFigureFile(std::span<const unsigned char>(third[0].snapshot)).size(), 49u);
+}
+
+TEST(ServerTest, RegionQueriesFollowGrowthAndRemoval) {
+    ServerFixture fixture;
+    FigureClient client(fixture.path);
+    Box<double> window(100, 100, 300, 250);
+
+    auto expected = [&] {
+        std::vector<uint64_t> hits;
+        const auto& figs = fixture.server.figures();
+        for (int i = 0; i < figs.getSize(); ++i)
+            if (figs[i]->bounds().intersects(window))
+                hits.push_back(i);
+        return hits;
+    };
+
+    for (int round = 0; round < 6; ++round) {
+        FigureRequest request;
+        for (int i = 0; i < 1500; ++i) {
+            double x = (i * 37 + round * 11) % 500, y = (i * 53 + round * 7) % 400;
+            request.add(Square<double>(Point<double>(x, y), Point<double>(x + 3, y)));
+        }
+        client.call(request);
+        auto hits = client.call(FigureRequest().region(window));
+        EXPECT_EQ(hits[0].indices, expected()) << "round " << round;
+    }
+
+    client.call(FigureRequest().remove(10).remove(4000));
+    auto hits = client.call(FigureRequest().region(window).area());
+    EXPECT_EQ(hits[0].indices, expected());
+    EXPECT_NEAR(hits[1].area, 9.0 * (9000 - 2), 1e-6);
+
+    // Removals in every indexed range and in the unindexed tail, then growth
+    // that merges the adjusted ranges again.
+    for (uint64_t index : {8997u, 0u, 8990u, 6000u, 7400u, 2999u}) {
+        client.call(FigureRequest().remove(index));
+        EXPECT_EQ(client.call(FigureRequest().region(window))[0].indices, expected()) << "index " << index;
+    }
+    FigureRequest more;
+    for (int i = 0; i < 2000; ++i)
+        more.add(Square<double>(Point<double>(i % 400, i % 300), Point<double>(i % 400 + 3, i % 300)));
+    client.call(more);
+    hits = client.call(FigureRequest().region(window).area());
+    EXPECT_EQ(hits[0].indices, expected());
+    EXPECT_NEAR(hits[1].area, 9.0 * (9000 - 8 + 2000), 1e-6);
+}
+
+TEST(ServerTest, SurvivesClientsThatStopReceiving) {
+    // No SIGPIPE handler is installed in the tests: answering a client that
+    // shut down its receive side must fail with EPIPE, not kill the process.
+    ServerFixture fixture;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_GE(fd, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, fixture.path.c_str(), fixture.path.size() + 1);
+    ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+    ASSERT_EQ(::shutdown(fd, SHUT_RD), 0);
+
+    // Frame: size 7, request id 1, one area command.
+    const unsigned char frame[] = {7, 0, 0, 0, 1, 0, 0, 0, 1, 0, 'S'};
+    ASSERT_EQ(::write(fd, frame, sizeof(frame)), ssize_t(sizeof(frame)));
+
+    FigureClient client(fixture.path);
+    auto results = client.call(FigureRequest().area());
+    ASSERT_EQ(results.size(), 1u);
+    EXPECT_TRUE(results[0].ok);
+    ::close(fd);
+}
+
+TEST(ServerTest, AnswersPipelinedFramesAfterHalfClose) {
+    ServerFixture fixture;
+    int fd = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    ASSERT_GE(fd, 0);
+    sockaddr_un addr{};
+    addr.sun_family = AF_UNIX;
+    std::memcpy(addr.sun_path, fixture.path.c_str(), fixture.path.size() + 1);
+    ASSERT_EQ(::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)), 0);
+
+    // Three area requests (ids 1..3) and then no more input.
+    std::vector<unsigned char> frames;
+    for (uint32_t id = 1; id <= 3; ++id) {
+        FigureProtocol::put32(frames, 7);
+        FigureProtocol::put32(frames, id);
+        FigureProtocol::put16(frames, 1);
+        frames.push_back('S');
+    }
+    ASSERT_EQ(::write(fd, frames.data(), frames.size()), ssize_t(frames.size()));
+    ASSERT_EQ(::shutdown(fd, SHUT_WR), 0);
+
+    std::vector<unsigned char> reply;
+    unsigned char chunk[4096];
+    ssize_t n;
+    while ((n = ::read(fd, chunk, sizeof(chunk))) > 0)
+        reply.insert(reply.end(), chunk, chunk + n);
+    ::close(fd);
+
+    std::vector<uint32_t> ids;
+    for (size_t pos = 0; pos + 8 <= reply.size(); pos += 4 + FigureProtocol::load32(&reply[pos]))
+        ids.push_back(FigureProtocol::load32(&reply[pos + 4]));
+    EXPECT_EQ(ids, (std::vector<uint32_t>{1, 2, 3}));
+}
+
+TEST(ServerTest, LoadGeneratorReportsPercentiles) {
+    ServerFixture fixture;
+    LoadOptions options;
+    options.connections = 2;
+    options.requests = 200;
+    options.batch = 8;
+    options.depth = 4;
+    LoadReport report = runLoad(fixture.path, options);
+
+    EXPECT_EQ(report.requests, 400u);
+    EXPECT_EQ(report.commands, 400u * 8);
+    EXPECT_LE(report.p50, report.p99);
+    EXPECT_LE(report.p99, report.max);
+    EXPECT_GT(report.p50, 0.0);
+
+    FigureClient client(fixture.path);
+    EXPECT_EQ(client.call(FigureRequest().remove(0))[0].count, 400u * 4 - 1);
+}
+
+
+// Shared memory
+
+std::string sharedName(const std::string& tag) {
+    return "/figure_test_" + tag + "_" + std::to_string(::getpid());
+}
+
+TEST(SharedMemoryTest, ConvertsShapesBothWays) {
+    Array<std::shared_ptr<Figure<double>>> figs;
+    figs.setVerbose(false);
+    for (int i = 0; i < 30; ++i) {
+        double x = i * 5.0;
+        if (i % 3 == 0)
+            figs.add(std::make_shared<Square<double>>(Point<double>(x, 0), Point<double>(x + 2, 0)));
+        else if (i % 3 == 1)
+            figs.add(std::make_shared<Triangle<double>>(Point<double>(x, 1), Point<double>(x + 1, 1), 2.0));
+        else
+            figs.add(std::make_shared<Octagon<double>>(Point<double>(x, 2), Point<double>(x + 1, 2)));
+    }
+
+    SharedFigureStore<double> store(sharedName("convert"), 64);
+    store.append(figs);
+    SharedFigureView<double> view(store.segmentName());
+
+    ASSERT_EQ(view.size(), 30u);
+    double total = 0.0;
+    for (int i = 0; i < figs.getSize(); ++i)
+        total += static_cast<double>(*figs[i]);
+    EXPECT_NEAR(view.totalArea(), total, 1e-9);
+
+    auto centers = view.centers();
+    auto back = view.figures();
+    ASSERT_EQ(back.getSize(), 30);
+    for (int i = 0; i < figs.getSize(); ++i) {
+        EXPECT_EQ(centers[i], figs[i]->center());
+        EXPECT_EQ(view.bounds(i), figs[i]->bounds());
+        EXPECT_EQ(view.kind(i), BinaryFormat::kindOf(*figs[i]));
+        EXPECT_TRUE(back[i]->equals(*figs[i])) << i;
+    }
+
+    std::vector<size_t> expected;
+    Box<double> region(20, 0, 42, 1.5);
+    for (int i = 0; i < figs.getSize(); ++i)
+        if (figs[i]->bounds().intersects(region))
+            expected.push_back(i);
+    EXPECT_EQ(view.region(region), expected);
+    EXPECT_FALSE(expected.empty());
+}
+
+TEST(SharedMemoryTest, RejectsWhatDoesNotFit) {
+    std::string name = sharedName("reject");
+    {
+        SharedFigureStore<double> store(name, 2);
+        EXPECT_THROW(SharedFigureStore<double>(name, 2), std::runtime_error);
+
+        Square<double> square(Point<double>(0, 0), Point<double>(1, 0));
+        Triangle<double> triangle(Point<double>(0, 0), Point<double>(1, 0), 1.0);
+        store.append(square);
+        Array<std::shared_ptr<Figure<double>>> two;
+        two.setVerbose(false);
+        two.add(std::make_shared<Square<double>>(square));
+        two.add(std::make_shared<Square<double>>(square));
+        EXPECT_THROW(store.append(two), std::length_error);
+        EXPECT_EQ(store.size(), 1u);
+
+        EXPECT_THROW(store.update(0, triangle), std::invalid_argument);
+        EXPECT_THROW(store.update(1, square), std::out_of_range);
+        EXPECT_THROW(store.area(1), std::out_of_range);
+        store.append(triangle);
+        EXPECT_EQ(store.kind(1), FigureKind::Triangle);
+        EXPECT_THROW(store.append(square), std::length_error);
+    }
+    EXPECT_THROW(SharedFigureView<double>{name}, std::runtime_error);
+    EXPECT_THROW(SharedFigureStore<double>("no-slash", 1), std::invalid_argument);
+}
+
+TEST(SharedMemoryTest, ViewRejectsColumnsOutsideTheSegment) {
+    SharedFigureStore<double> store(sharedName("columns"), 4);
+    store.append(Square<double>(Point<double>(0, 0), Point<double>(1, 0)));
+
+    int fd = ::shm_open(store.segmentName().c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    void* mapped = ::mmap(nullptr, sizeof(SharedFigureHeader), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    ASSERT_NE(mapped, MAP_FAILED);
+    auto* h = static_cast<SharedFigureHeader*>(mapped);
+
+    uint64_t xs = h->columns[SharedFigureHeader::Xs];
+    h->columns[SharedFigureHeader::Xs] = h->segmentSize;
+    EXPECT_THROW(SharedFigureView<double>{store.segmentName()}, std::runtime_error);
+    h->columns[SharedFigureHeader::Xs] = xs + 8;
+    EXPECT_THROW(SharedFigureView<double>{store.segmentName()}, std::runtime_error);
+    h->columns[SharedFigureHeader::Xs] = xs;
+
+    uint64_t vertexCapacity = h->vertexCapacity;
+    h->vertexCapacity = uint64_t(1) << 61;
+    EXPECT_THROW(SharedFigureView<double>{store.segmentName()}, std::runtime_error);
+    h->vertexCapacity = vertexCapacity;
+
+    SharedFigureView<double> view(store.segmentName());
+    EXPECT_DOUBLE_EQ(view.area(0), 1.0);
+    ::munmap(mapped, sizeof(SharedFigureHeader));
+}
+
+TEST(SharedMemoryTest, ReaderProcessSeesWholeUpdates) {
+    constexpr int updates = 20000, appended = 100;
+    SharedFigureStore<double> store(sharedName("process"), 1 + appended);
+    store.append(Square<double>(Point<double>(1, 0), Point<double>(2, 0)));
+    SharedFigureView<double> view(store.segmentName());
+
+    pid_t child = ::fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        // Each update moves the square to (s, 0) with side s; a torn read
+        // would mix the vertices or the cached area of two of them.
+        int failures = 0;
+        double last = 0.0;
+        uint64_t lastVersion = 0;
+        while (true) {
+            uint64_t version = view.version();
+            auto fig = view.figure(0);
+            double s = fig->vertex(0).x();
+            if (version < lastVersion || s < last)
+                ++failures;
+            if (!fig->equals(Square<double>(Point<double>(s, 0), Point<double>(2 * s, 0))))
+                ++failures;
+            double area = view.area(0);
+            if (area < s * s || area > double(updates) * updates)
+                ++failures;
+            last = s;
+            lastVersion = version;
+            if (s == updates)
+                break;
+        }
+        while (view.size() != 1 + appended)
+            std::this_thread::yield();
+        if (std::abs(view.totalArea() - (double(updates) * updates + appended * 0.5)) > 1e-6)
+            ++failures;
+        ::_exit(failures ? 1 : 0);
+    }
+
+    for (int s = 2; s <= updates; ++s)
+        store.update(0, Square<double>(Point<double>(s, 0), Point<double>(2 * s, 0)));
+    Array<std::shared_ptr<Figure<double>>> triangles;
+    triangles.setVerbose(false);
+    for (int i = 0; i < appended; ++i)
+        triangles.add(std::make_shared<Triangle<double>>(Point<double>(i, 5), Point<double>(i + 1, 5), 1.0));
+    store.append(triangles);
+
+    int status = 0;
+    ASSERT_EQ(::waitpid(child, &status, 0), child);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+}
+
+
+// Main
+
+int main(int argc, char **argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    return RUN_ALL_TESTS();
 }
\ No newline at end of file